@@ -1,5 +1,51 @@
 // script.js – kompletní opravená verze
 
+// --- Přihlášení (session cookie) ---
+// Každá odpověď 401 ukáže přihlašovací formulář; po přihlášení se stránka
+// načte znovu, aby se vše inicializovalo už s platnou session.
+const rawFetch = window.fetch.bind(window);
+window.fetch = async (...args) => {
+  const res = await rawFetch(...args);
+  if (res.status === 401) showLogin();
+  return res;
+};
+
+function showLogin() {
+  const overlay = document.getElementById('login-overlay');
+  if (!overlay || !overlay.classList.contains('hidden')) return;
+  overlay.classList.remove('hidden');
+  document.getElementById('login-password')?.focus();
+}
+
+function setupLogin(api) {
+  const form  = document.getElementById('login-form');
+  const errEl = document.getElementById('login-error');
+  form?.addEventListener('submit', async e => {
+    e.preventDefault();
+    errEl.textContent = '';
+    try {
+      const res = await rawFetch(api.login, {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/json' },
+        body: JSON.stringify({
+          user:     document.getElementById('login-user').value,
+          password: document.getElementById('login-password').value
+        })
+      });
+      if (res.ok) { location.reload(); return; }
+      errEl.textContent = res.status === 429
+        ? 'Příliš mnoho pokusů, zkuste to za chvíli'
+        : 'Nesprávné jméno nebo heslo';
+    } catch (err) {
+      errEl.textContent = 'Server neodpovídá';
+    }
+  });
+  document.getElementById('logout-button')?.addEventListener('click', async () => {
+    await rawFetch(api.logout, { method: 'POST' }).catch(() => {});
+    location.reload();
+  });
+}
+
 // --- Inicializace ---
 async function init() {
   try {
@@ -10,8 +56,10 @@ async function init() {
       fetch('users.json').then(r => r.json())
     ]);
 
+    setupLogin(config.api);
     setupMenu(config.menu);
-    setupModemStatus(config.api);
+    const events = setupEvents(config.api);
+    setupModemStatus(config.api, events);
     setupSections(config.api);
 
     loadTemplatesData(templates);
@@ -24,7 +72,8 @@ async function init() {
     setupLdapSync(config.api, contacts);
     //attachFormHandlers(config.api, contacts);
     setupSmsForm(config.api);
-    setupSmsStatus(config.api);
+    setupBulkSms(config.api, contacts, templates);
+    setupSmsStatus(config.api, events);
     setupSmsHistory(config.api);
     setupMqttForm(config.api);
     setupSettingsForm(config.api);  // ← now passes the real API-endpoints object
@@ -37,10 +86,40 @@ async function init() {
 }
 document.addEventListener('DOMContentLoaded', init);
 
-function setupSmsStatus(api) {
+// --- Události ze serveru (SSE) ---
+// Vrací EventSource, nebo null, pokud ho prohlížeč nemá – pak se polluje.
+function setupEvents(api) {
+  if (!api.events || typeof EventSource === 'undefined') return null;
+  const es = new EventSource(api.events);
+  es.addEventListener('call', () => {
+    if (!document.getElementById('call-history')?.classList.contains('hidden')) {
+      loadCallLog(api);
+    }
+  });
+  return es;
+}
+
+// Zavolá fn v intervalu jen tehdy, když stream událostí neběží
+function pollWhileNoEvents(events, fn, ms) {
+  setInterval(() => {
+    if (!events || events.readyState === EventSource.CLOSED) fn();
+  }, ms);
+}
+
+function setupSmsStatus(api, events) {
+  let pending = null;
+  const reload = () => {
+    // více změn stavu v rychlém sledu → jedno načtení
+    if (pending) return;
+    pending = setTimeout(() => { pending = null; loadSmsStatus(api); }, 300);
+  };
   loadSmsStatus(api);
-  // každých 3 vteřiny
-  setInterval(() => loadSmsStatus(api), 3000);
+  if (events) {
+    events.addEventListener('sms', reload);
+    events.addEventListener('resync', reload);
+  }
+  // záložní polling každé 3 vteřiny
+  pollWhileNoEvents(events, () => loadSmsStatus(api), 3000);
 }
 
 // --- Menu ---
@@ -111,23 +190,28 @@ async function loadCallLog(api) {
 }
 
 // --- Modem status ---
-function setupModemStatus(api) {
+function setupModemStatus(api, events) {
   const opEl   = document.getElementById('operator-name');
   const barEl  = document.getElementById('signal-bar');
   const txtEl  = document.getElementById('signal-strength');
   const mqttEl = document.getElementById('mqtt-status-indicator');
   const timeEl = document.getElementById('modem-time');
 
+  function show({ signal, operator, mqttConnected }) {
+    if (opEl)   opEl.textContent   = operator;
+    if (barEl)  barEl.value        = signal;
+    if (txtEl)  txtEl.textContent  = signal;
+    if (mqttEl) mqttEl.className   = mqttConnected
+                   ? 'status-dot connected'
+                   : 'status-dot disconnected';
+    if (timeEl) timeEl.textContent = new Date()
+                           .toLocaleTimeString('cs-CZ');
+  }
+
   async function update() {
     try {
-      const { signal, operator, mqttConnected } = 
-              await fetch(api.modemStatus).then(r => r.json());
-      if (opEl)   opEl.textContent   = operator;
-      if (barEl)  barEl.value        = signal;
-      if (txtEl)  txtEl.textContent  = signal;
-      if (mqttEl) mqttEl.className   = mqttConnected
-                     ? 'status-dot connected'
-                     : 'status-dot disconnected';
+      show(await fetch(api.modemStatus).then(r => r.json()));
+      return;
     } catch (e) {
       if (opEl)   opEl.textContent  = '—';
       if (barEl)  barEl.value       = 0;
@@ -138,7 +222,11 @@ function setupModemStatus(api) {
                            .toLocaleTimeString('cs-CZ');
   }
   update();
-  setInterval(update, 5000);
+  if (events) {
+    events.addEventListener('modem', e => show(JSON.parse(e.data)));
+    events.addEventListener('resync', update);
+  }
+  pollWhileNoEvents(events, update, 5000);
 }
 
 // --- SMS šablony ---
@@ -360,12 +448,33 @@ function populateRecipientsSelect(contacts) {
   });
 }
 
+// Stejný výpočet jako smsPlan() ve firmwaru: GSM-7 (rozšířené znaky za 2),
+// jinak UCS-2; dělená zpráva má 153 septetů / 67 znaků na segment.
+const GSM7_BASIC = '@£$¥èéùìòÇ\nØø\rÅåΔ_ΦΓΛΩΠΨΣΘΞ\x1bÆæßÉ !"#¤%&\'()*+,-./0123456789:;<=>?' +
+                   '¡ABCDEFGHIJKLMNOPQRSTUVWXYZÄÖÑÜ§¿abcdefghijklmnopqrstuvwxyzäöñüà';
+const GSM7_EXT   = '\f^{}\\[~]|€';
+
+function smsSegments(text) {
+  let septets = 0, ucs = 0, gsm = true;
+  for (const ch of text) {
+    ucs += ch.length;
+    if (!gsm) continue;
+    if (GSM7_BASIC.includes(ch))    septets += 1;
+    else if (GSM7_EXT.includes(ch)) septets += 2;
+    else gsm = false;
+  }
+  const [units, single, multi] = gsm ? [septets, 160, 153] : [ucs, 70, 67];
+  return { units, single, segments: units <= single ? 1 : Math.ceil(units / multi), gsm };
+}
+
 function setupCharCount() {
   const textarea = document.getElementById('message-text');
   const counter  = document.getElementById('char-count');
   if (!textarea || !counter) return;
   textarea.addEventListener('input', () => {
-    counter.textContent = `${textarea.value.length}/160`;
+    const p = smsSegments(textarea.value);
+    counter.textContent = `${p.units}/${p.single}` +
+      (p.segments > 1 ? ` (${p.segments} SMS)` : '') + (p.gsm ? '' : ' UCS-2');
   });
 }
 
@@ -384,10 +493,14 @@ async function loadSmsStatus(api) {
                    <span class="spinner"></span>Odesílá se
                  </span>`;
       } else {
-        const cls = `badge ${item.state}`;
-        const txt = item.state === 'idle' ? 'Čeká' :
-                    item.state === 'sent' ? 'Odesláno' :
-                    'Chyba';
+        const map = {
+          queued:   ['idle',    'Čeká'],
+          retrying: ['idle',    `Opakuje se (${item.attempts})`],
+          sent:     ['sent',    'Odesláno'],
+          failed:   ['error',   'Chyba']
+        };
+        const [state, txt] = map[item.state] || ['error', 'Chyba'];
+        const cls = `badge ${state}`;
         badge = `<span class="${cls}">${txt}</span>`;
       }
 
@@ -484,6 +597,71 @@ function attachFormHandlers(api, contactsData) {
   });
 }
 
+// --- Hromadná SMS (skupiny + šablona, rozvinutí na zařízení) ---
+function setupBulkSms(api, contacts, templates) {
+  const form     = document.getElementById('bulk-form');
+  const groupSel = document.getElementById('bulk-groups');
+  const tmplSel  = document.getElementById('bulk-template');
+  const progress = document.getElementById('bulk-progress');
+  if (!form) return;
+
+  [...new Set(contacts.map(c => c.group).filter(Boolean))].sort().forEach(g => {
+    groupSel.add(new Option(g, g));
+  });
+  templates.forEach(t => tmplSel.add(new Option(t.name, t.id)));
+
+  let timer = null;
+  function show(st) {
+    if (!st.id) { progress.textContent = ''; return; }
+    progress.textContent =
+      `Dávka #${st.id}: ${st.queued}/${st.total} ve frontě` +
+      (st.failed ? `, ${st.failed} chyb` : '') +
+      (st.duplicates ? `, ${st.duplicates} duplicit` : '') +
+      (st.active ? '…' : (st.error ? ` – ${st.error}` : ' – hotovo'));
+  }
+  async function poll() {
+    try {
+      const st = await fetch(api.sendBulk).then(r => r.json());
+      show(st);
+      if (!st.active) { clearInterval(timer); timer = null; }
+    } catch (e) { /* další pokus v intervalu */ }
+  }
+  function watch() {
+    if (!timer) timer = setInterval(poll, 1000);
+    poll();
+  }
+
+  form.addEventListener('submit', async e => {
+    e.preventDefault();
+    const groups = [...groupSel.selectedOptions].map(o => o.value);
+    if (groups.length === 0) { progress.textContent = 'Vyberte alespoň jednu skupinu.'; return; }
+    const vars = {};
+    document.getElementById('bulk-vars').value.split(';').forEach(pair => {
+      const i = pair.indexOf('=');
+      if (i > 0) vars[pair.slice(0, i).trim()] = pair.slice(i + 1).trim();
+    });
+    const res = await fetch(api.sendBulk, {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify({ groups, template: Number(tmplSel.value), vars })
+    });
+    const body = await res.json().catch(() => ({}));
+    if (!res.ok) {
+      progress.textContent = `Chyba: ${body.error || res.status}` +
+                             (body.variable ? ` ({{${body.variable}}})` : '');
+      return;
+    }
+    watch();
+  });
+
+  document.getElementById('bulk-cancel')?.addEventListener('click', async () => {
+    await fetch(api.sendBulkCancel, { method: 'POST' });
+    poll();
+  });
+
+  watch();   // rozběhnutá dávka z jiné záložky
+}
+
 function setupSmsForm(api) {
   const form = document.getElementById('sms-form');
   const alertBox = document.getElementById('sms-alert');
@@ -626,6 +804,7 @@ function setupMqttForm(api) {
       statusTopic:  document.getElementById('mqtt-status-topic').value,
       smsTopic:     document.getElementById('mqtt-sms-topic').value,
       callerTopic:  document.getElementById('mqtt-caller-topic').value,
+      inboxTopic:   document.getElementById('mqtt-inbox-topic').value,
       pubTopic:     document.getElementById('mqtt-pubTopic').value
     };
 
@@ -695,6 +874,7 @@ async function loadMqttConfig(api) {
     document.getElementById('mqtt-status-topic').value = cfg.statusTopic || '';
     document.getElementById('mqtt-sms-topic').value    = cfg.smsTopic || '';
     document.getElementById('mqtt-caller-topic').value = cfg.callerTopic || '';
+    document.getElementById('mqtt-inbox-topic').value  = cfg.inboxTopic || '';
   } catch (e) {
     console.warn('Nelze načíst MQTT konfiguraci', e);
   }
@@ -712,9 +892,12 @@ async function loadSettings(api) {
     document.getElementById('modem-auto-time').checked   = !!cfg.atctzu;
     document.getElementById('modem-manual-time').checked = !!cfg.atctr;
     document.getElementById('modem-callerid').checked    = !!cfg.atclip;
+    document.getElementById('modem-poll-interval').value = cfg.modemPollInterval ?? 30000;
     document.getElementById('timeout-prompt').value   = cfg.smsPromptTimeout || 10000;
     document.getElementById('timeout-sms').value      = cfg.smsTimeout || 15000;
     document.getElementById('cmd-interval').value     = cfg.cmdInterval || 200;
+    document.getElementById('sms-max-attempts').value = cfg.smsMaxAttempts || 4;
+    document.getElementById('sms-retry-base').value   = cfg.smsRetryBaseMs || 10000;
     document.getElementById('ring-count').value       = cfg.maxRingCount || 1;
   } catch (e) {
     console.warn('Nelze načíst nastavení', e);
@@ -735,9 +918,12 @@ function setupSettingsForm(api) {
       atctzu:         document.getElementById('modem-auto-time').checked,
       atctr:          document.getElementById('modem-manual-time').checked,
       atclip:         document.getElementById('modem-callerid').checked,
+      modemPollInterval: parseInt(document.getElementById('modem-poll-interval').value, 10),
       smsPromptTimeout: parseInt(document.getElementById('timeout-prompt').value, 10),
       smsTimeout:     parseInt(document.getElementById('timeout-sms').value, 10),
       cmdInterval:    parseInt(document.getElementById('cmd-interval').value, 10),
+      smsMaxAttempts: parseInt(document.getElementById('sms-max-attempts').value, 10),
+      smsRetryBaseMs: parseInt(document.getElementById('sms-retry-base').value, 10),
       maxRingCount:   parseInt(document.getElementById('ring-count').value, 10)
     };
     const res = await fetch(api.settings, {
@@ -0,0 +1,182 @@
+// at_engine.cpp – neblokující fronta AT příkazů
+#include "at_engine.h"
+#include "metrics.h"
+
+#define LOG_TAG "AT"
+#ifndef AT_LOG_LEVEL
+  #define AT_LOG_LEVEL LOG_LEVEL
+#endif
+#define LOG_LEVEL_MODULE AT_LOG_LEVEL
+#include "log.h"
+
+// ====== Fronta příkazů ======
+static AtCommand queue[AT_QUEUE_LEN];
+static uint8_t   qHead = 0, qTail = 0;
+
+// ====== Aktivní příkaz ======
+// Kopie mimo frontu: callback smí volat atSubmit() bez rizika přepsání.
+enum ActivePhase : uint8_t { PH_IDLE, PH_WAIT_PROMPT, PH_WAIT_FINAL };
+
+static Stream*       port        = nullptr;
+static AtCommand     active;
+static ActivePhase   phase       = PH_IDLE;
+static unsigned long phaseStart  = 0;
+static unsigned long lastDone    = 0;
+static char          resp[AT_RESP_MAX];
+static size_t        respLen     = 0;
+
+// Počítá bajty PDU zapsané callbackem promptu (uart_tx_bytes)
+class CountingPrint : public Print {
+public:
+  explicit CountingPrint(Print& out) : out_(out) {}
+  size_t write(uint8_t b) override { n_++; return out_.write(b); }
+  size_t write(const uint8_t* p, size_t n) override { n_ += n; return out_.write(p, n); }
+  size_t count() const { return n_; }
+private:
+  Print& out_;
+  size_t n_ = 0;
+};
+
+static bool queueEmpty() { return qHead == qTail; }
+static bool queueFull()  { return ((qTail + 1) % AT_QUEUE_LEN) == qHead; }
+
+static void respAppend(const char* line) {
+  size_t n = strlen(line);
+  if (respLen + n + 2 > sizeof(resp)) return;   // přetečení: zbytek zahodíme
+  if (respLen) resp[respLen++] = '\n';
+  memcpy(resp + respLen, line, n);
+  respLen += n;
+  resp[respLen] = '\0';
+}
+
+static void finish(AtStatus st, int code) {
+  phase    = PH_IDLE;
+  lastDone = millis();
+  if (st != AT_OK) {
+    LOG_W("%s -> %s (%d)", active.cmd,
+          st == AT_TIMEOUT ? "timeout" : "error", code);
+  }
+  if (active.onDone) {
+    AtResult r = { st, code, resp };
+    active.onDone(r, active.ctx);
+  }
+}
+
+// "+CMS ERROR: 42" → 42 (CMEE=1), text bez kódu (CMEE=2) → -1
+static int parseErrorCode(const char* line) {
+  const char* p = strchr(line, ':');
+  if (!p) return -1;
+  ++p;
+  while (*p == ' ') ++p;
+  if (!isdigit((unsigned char)*p)) return -1;
+  return atoi(p);
+}
+
+static void startNext() {
+  active = queue[qHead];
+  qHead  = (qHead + 1) % AT_QUEUE_LEN;
+  respLen = 0;
+  resp[0] = '\0';
+  port->print(active.cmd);
+  port->print("\r");
+  metricsAdd(MC_AT_COMMANDS);
+  metricsAdd(MC_UART_TX_BYTES, strlen(active.cmd) + 1);
+  phase      = active.onPrompt ? PH_WAIT_PROMPT : PH_WAIT_FINAL;
+  phaseStart = millis();
+}
+
+// ====== Veřejné API ======
+void atEngineBegin(Stream& p) {
+  port = &p;
+}
+
+bool atSubmit(const AtCommand& c) {
+  if (queueFull() || strnlen(c.cmd, AT_CMD_MAX) >= AT_CMD_MAX) return false;
+  queue[qTail] = c;
+  qTail = (qTail + 1) % AT_QUEUE_LEN;
+  return true;
+}
+
+bool atSubmit(const char* cmd, AtDoneFn done, void* ctx,
+              unsigned long timeout, const char* prefix) {
+  AtCommand c;
+  size_t n = strlen(cmd);
+  if (n >= sizeof(c.cmd)) return false;
+  memcpy(c.cmd, cmd, n + 1);
+  c.onDone  = done;
+  c.ctx     = ctx;
+  c.timeout = timeout;
+  c.prefix  = prefix;
+  return atSubmit(c);
+}
+
+void atEngineLoop() {
+  if (!port) return;
+  unsigned long now = millis();
+
+  if (phase == PH_WAIT_PROMPT && now - phaseStart >= active.promptTimeout) {
+    port->write(27);            // ESC: zrušit rozepsaný vstup modemu
+    finish(AT_TIMEOUT, -1);
+  } else if (phase == PH_WAIT_FINAL && now - phaseStart >= active.timeout) {
+    finish(AT_TIMEOUT, -1);
+  }
+
+  if (phase == PH_IDLE && !queueEmpty() && now - lastDone >= AT_GUARD_MS) {
+    startNext();
+  }
+}
+
+bool atEngineWantsPrompt() {
+  return phase == PH_WAIT_PROMPT;
+}
+
+bool atEngineOnPrompt() {
+  if (phase != PH_WAIT_PROMPT) return false;
+  CountingPrint out(*port);
+  active.onPrompt(out, active.ctx);
+  port->write(26);              // CTRL+Z
+  metricsAdd(MC_UART_TX_BYTES, out.count() + 1);
+  phase      = PH_WAIT_FINAL;
+  phaseStart = millis();
+  return true;
+}
+
+static bool startsWith(const char* s, const char* prefix) {
+  return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+bool atEngineOnLine(const char* line) {
+  if (phase == PH_IDLE) return false;
+
+  // echo (pokud je ATE1) patří příkazu
+  if (!strcmp(line, active.cmd)) return true;
+
+  if (!strcmp(line, active.expect) ||
+      (strcmp(active.expect, "OK") != 0 && strstr(line, active.expect))) {
+    if (strcmp(active.expect, "OK") != 0) respAppend(line);
+    finish(AT_OK, -1);
+    return true;
+  }
+  if (!strcmp(line, "ERROR")) {
+    finish(AT_ERROR, -1);
+    return true;
+  }
+  if (startsWith(line, "+CME ERROR:") || startsWith(line, "+CMS ERROR:")) {
+    respAppend(line);
+    finish(AT_ERROR, parseErrorCode(line));
+    return true;
+  }
+  if (active.prefix && startsWith(line, active.prefix)) {
+    respAppend(line);
+    return true;
+  }
+  return false;                 // URC – zpracuje volající
+}
+
+bool atEngineBusy() {
+  return phase != PH_IDLE || !queueEmpty();
+}
+
+size_t atEnginePending() {
+  return (qTail + AT_QUEUE_LEN - qHead) % AT_QUEUE_LEN;
+}
@@ -0,0 +1,71 @@
+// at_engine.h – neblokující fronta AT příkazů pro GSM modem
+//
+// Příkazy se řadí do fronty a odesílají po jednom. Odpovědi modemu
+// dodává handleModemURC() (řádek po řádku + prompt '>'), časové limity
+// hlídá atEngineLoop(). Nikde se nečeká aktivně na UART.
+
+#pragma once
+#include <Arduino.h>
+
+// ======= Limity (lze přepsat přes -D) =======
+#ifndef AT_QUEUE_LEN
+  #define AT_QUEUE_LEN  16    // počet slotů fronty (využitelných je o 1 méně)
+#endif
+#ifndef AT_CMD_MAX
+  #define AT_CMD_MAX    64    // max. délka příkazu včetně '\0'
+#endif
+#ifndef AT_RESP_MAX
+  #define AT_RESP_MAX   192   // zachycené mezilehlé řádky odpovědi
+#endif
+#ifndef AT_GUARD_MS
+  #define AT_GUARD_MS   20    // minimální rozestup mezi koncem a dalším příkazem [ms]
+#endif
+
+// Prefix "zachyť vše" – všechny ne-finální řádky patří příkazu (ATI, debug)
+#define AT_CAPTURE_ALL ""
+
+// ======= Výsledek příkazu =======
+enum AtStatus : uint8_t {
+  AT_OK,        // přišel očekávaný finální řádek
+  AT_ERROR,     // ERROR / +CME ERROR / +CMS ERROR
+  AT_TIMEOUT    // vypršel časový limit (prompt nebo celý příkaz)
+};
+
+struct AtResult {
+  AtStatus    status;
+  int         errorCode;   // číslo z +CME/+CMS ERROR, jinak -1
+  const char* response;    // zachycené řádky oddělené '\n' (platí jen v callbacku)
+};
+
+// Dokončení příkazu (volá se z kontextu handleModemURC()/atEngineLoop())
+typedef void (*AtDoneFn)(const AtResult& res, void* ctx);
+// Po promptu '>' zapíše tělo (text/PDU); CTRL+Z doplní engine sám
+typedef void (*AtPromptFn)(Print& out, void* ctx);
+
+// ======= Popis příkazu =======
+struct AtCommand {
+  char          cmd[AT_CMD_MAX];
+  const char*   expect   = "OK";     // finální řádek úspěchu (statický řetězec)
+  const char*   prefix   = nullptr;  // prefix zachytávaných řádků (např. "+CSQ:")
+  unsigned long timeout  = 1000;     // limit celého příkazu [ms]
+  unsigned long promptTimeout = 0;   // limit na '>' (jen s onPrompt) [ms]
+  AtPromptFn    onPrompt = nullptr;
+  AtDoneFn      onDone   = nullptr;
+  void*         ctx      = nullptr;
+};
+
+// ======= API =======
+void   atEngineBegin(Stream& port);
+void   atEngineLoop();                 // start dalšího příkazu + časové limity
+
+bool   atSubmit(const AtCommand& c);   // false = plná fronta nebo dlouhý příkaz
+bool   atSubmit(const char* cmd, AtDoneFn done = nullptr, void* ctx = nullptr,
+                unsigned long timeout = 1000, const char* prefix = nullptr);
+
+// Vstup z URC smyčky; true = řádek/prompt patřil aktivnímu příkazu
+bool   atEngineOnLine(const char* line);
+bool   atEngineOnPrompt();
+bool   atEngineWantsPrompt();
+
+bool   atEngineBusy();                 // běží příkaz nebo něco čeká ve frontě
+size_t atEnginePending();
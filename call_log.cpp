@@ -0,0 +1,122 @@
+// call_log.cpp – log volání: fronta z modemové úlohy, append v síťové
+#include "call_log.h"
+#include "contact_store.h"
+#include "jsonl_file.h"
+#include "rt_queue.h"
+#include "sms_scheduler.h"   // smsParseSendTime
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <time.h>
+
+#define LOG_TAG "CALLS"
+#include "log.h"
+
+static const char* CALL_LOG_PATH     = "/call_log.jsonl";
+static const char* CALL_LOG_TMP      = "/call_log.tmp";
+static const char* CALL_LOG_OLD_PATH = "/call_log.json";   // dřívější JSON pole
+
+struct CallEvent {
+  time_t when;
+  char   number[CONTACT_NUMBER_MAX + 8];
+};
+static SpscRing<CallEvent, CALL_LOG_QUEUE> events;
+static uint16_t lines = 0;            // jen síťová úloha
+
+typedef StaticJsonDocument<128> CallEntry;
+
+static void formatTime(time_t t, char* buf, size_t cap) {
+  struct tm tminfo;
+  localtime_r(&t, &tminfo);
+  strftime(buf, cap, "%Y-%m-%dT%H:%M:%S", &tminfo);   // ISO-8601
+}
+
+// Starý formát: JSON pole, prvky po jednom ze streamu
+static void importOldLog() {
+  File in = LittleFS.open(CALL_LOG_OLD_PATH, "r");
+  if (!in) return;
+  CallEntry entry;
+  for (bool first = true; in.find(first ? "[" : ","); first = false) {
+    if (deserializeJson(entry, in) != DeserializationError::Ok) break;
+    if (jsonlAppend(CALL_LOG_PATH, entry)) lines++;
+  }
+  in.close();
+  LittleFS.remove(CALL_LOG_OLD_PATH);
+  LOG_I("import %s: %u záznamů", CALL_LOG_OLD_PATH, (unsigned)lines);
+}
+
+void callLogBegin() {
+  lines = jsonlCountLines(CALL_LOG_PATH);
+  importOldLog();
+}
+
+bool callLogPush(const char* number) {
+  CallEvent ev;
+  ev.when = time(nullptr);
+  strlcpy(ev.number, number, sizeof(ev.number));
+  if (events.push(ev)) return true;
+  LOG_W("fronta logu volání plná, %s nezapsáno", number);
+  return false;
+}
+
+void callLogLoop() {
+  CallEvent ev;
+  while (events.pop(ev)) {
+    char when[25];
+    formatTime(ev.when, when, sizeof(when));
+    CallEntry entry;
+    entry["datetime"] = (const char*)when;
+    entry["number"]   = (const char*)ev.number;
+    if (!jsonlAppend(CALL_LOG_PATH, entry)) {
+      LOG_E("zápis %s selhal", CALL_LOG_PATH);
+      continue;
+    }
+    if (++lines > CALL_LOG_MAX) {
+      jsonlKeepLast(CALL_LOG_PATH, CALL_LOG_TMP, lines, CALL_LOG_KEEP);
+      lines = CALL_LOG_KEEP;
+    }
+  }
+}
+
+// ====== Výpis ======
+// Řádky se čtou po jednom do malého dokumentu (mezery a LF mezi
+// objekty přeskočí parser). Stránka se počítá od konce, proto první
+// průchod jen spočítá vyhovující záznamy.
+static bool callLogNext(File& f, CallEntry& entry) {
+  return deserializeJson(entry, f) == DeserializationError::Ok;
+}
+
+static bool callLogMatches(const CallEntry& entry, const LogQuery& q) {
+  if (q.number && *q.number && strcmp(entry["number"] | "", q.number) != 0) return false;
+  return !q.since || smsParseSendTime(entry["datetime"] | "") >= q.since;
+}
+
+bool callLogPrintJson(Print& out, const LogQuery& q) {
+  CallEntry entry;
+  uint16_t matching = 0;
+  File f = LittleFS.open(CALL_LOG_PATH, "r");
+  if (f) {
+    while (callLogNext(f, entry)) {
+      if (callLogMatches(entry, q)) matching++;
+    }
+  }
+
+  // okno [from, to) v chronologickém pořadí
+  uint16_t to   = matching > q.offset ? matching - q.offset : 0;
+  uint16_t from = to > q.limit ? to - q.limit : 0;
+  uint16_t idx  = 0;
+  bool     sep  = false;
+  out.print('[');
+  if (f && to) {
+    f.seek(0);
+    while (idx < to && callLogNext(f, entry)) {
+      if (!callLogMatches(entry, q)) continue;
+      if (idx++ < from) continue;
+      if (sep) out.print(',');
+      serializeJson(entry, out);
+      sep = true;
+    }
+  }
+  out.print(']');
+  if (f) f.close();
+  return from > 0;
+}
@@ -0,0 +1,31 @@
+// call_log.h – log příchozích volání (/call_log.jsonl)
+//
+// Modemová úloha jen vloží číslo a čas do SPSC fronty (callLogPush,
+// bez zápisu do flash a bez velkého dokumentu na zásobníku), soubor
+// zapisuje síťová úloha v callLogLoop() jako append jednoho řádku.
+// Po CALL_LOG_MAX záznamech se log zkrátí na CALL_LOG_KEEP nejnovějších.
+
+#pragma once
+#include <Arduino.h>
+#include "sms_history.h"     // LogQuery
+
+#ifndef CALL_LOG_MAX
+  #define CALL_LOG_MAX   200
+#endif
+#ifndef CALL_LOG_KEEP
+  #define CALL_LOG_KEEP  100
+#endif
+#ifndef CALL_LOG_QUEUE
+  #define CALL_LOG_QUEUE 8      // mocnina 2
+#endif
+
+// Při startu (před tasksStart): počet řádků, import starého /call_log.json
+void callLogBegin();
+// Modemová úloha; false = plná fronta (záznam se zahodí)
+bool callLogPush(const char* number);
+// Síťová úloha: zapíše čekající záznamy
+void callLogLoop();
+
+// Log jako JSON pole (chronologicky, stránka počítaná od nejnovějších);
+// vrací true, pokud jsou starší vyhovující záznamy mimo stránku
+bool callLogPrintJson(Print& out, const LogQuery& q);
@@ -0,0 +1,233 @@
+// contact_store.cpp – sestavení /contacts.bin a vyhledání podle čísla
+#include "contact_store.h"
+#include "rt_queue.h"
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+
+#define LOG_TAG "CONTACTS"
+#include "log.h"
+
+#define STORE_MAGIC    0x31544E43UL   // "CNT1"
+#define STORE_VERSION  1
+#define STORE_TMP_PATH "/contacts.bin.tmp"
+#define KEY_INTL       (1ULL << 63)
+
+// Na konci souboru – počet záznamů je známý až po projití JSON
+struct StoreTrailer {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+  uint32_t jsonSize;      // velikost zdrojového /contacts.json
+};
+
+// Index: count == 0 během přestavby (vyhledání pak nic nenajde)
+static uint64_t   keys[CONTACT_STORE_MAX];
+static uint16_t   recs[CONTACT_STORE_MAX];
+static uint16_t   count = 0;
+static RtSpinLock lock;
+
+static void setCount(uint16_t n) {
+  RtLockGuard g(lock);
+  count = n;
+}
+
+// ====== Čísla ======
+bool contactNormalize(const char* in, char* out, size_t cap) {
+  char d[20];
+  size_t n = 0;
+  bool intl = false;
+  for (const char* p = in; *p; ++p) {
+    char c = *p;
+    if (c == ' ' || c == '-' || c == '(' || c == ')' || c == '.') continue;
+    if (c == '+' && n == 0 && !intl) { intl = true; continue; }
+    if (c < '0' || c > '9' || n + 1 >= sizeof(d)) return false;
+    d[n++] = c;
+  }
+  d[n] = '\0';
+  const char* digits = d;
+  if (!intl && d[0] == '0' && d[1] == '0') { digits += 2; intl = true; }
+  size_t len = strlen(digits);
+  if (len == 0) return false;
+
+  int w;
+  if (!intl && len == CONTACT_NATIONAL_LEN) {
+    w = snprintf(out, cap, "+" CONTACT_DEFAULT_CC "%s", digits);
+  } else {
+    w = snprintf(out, cap, intl ? "+%s" : "%s", digits);
+  }
+  // E.164 má nejvýš 15 číslic
+  return w > 0 && (size_t)w < cap && strlen(out) - (out[0] == '+') <= 15;
+}
+
+// Číslice jako celé číslo, k tomu jejich počet (úvodní nuly) a příznak '+'
+static uint64_t makeKey(const char* e164) {
+  uint64_t key = 0;
+  bool intl = *e164 == '+';
+  const char* p = e164 + intl;
+  size_t len = strlen(p);
+  for (; *p; ++p) key = key * 10 + (*p - '0');
+  return key | ((uint64_t)len << 56) | (intl ? KEY_INTL : 0);
+}
+
+// ====== Řazení indexu (heapsort, klíče a čísla záznamů spolu) ======
+static void swapEntries(size_t a, size_t b) {
+  uint64_t k = keys[a]; keys[a] = keys[b]; keys[b] = k;
+  uint16_t r = recs[a]; recs[a] = recs[b]; recs[b] = r;
+}
+
+static void siftDown(size_t i, size_t n) {
+  for (;;) {
+    size_t c = 2 * i + 1;
+    if (c >= n) return;
+    if (c + 1 < n && keys[c + 1] > keys[c]) c++;
+    if (keys[i] >= keys[c]) return;
+    swapEntries(i, c);
+    i = c;
+  }
+}
+
+static void sortIndex(size_t n) {
+  for (size_t i = n / 2; i-- > 0; ) siftDown(i, n);
+  for (size_t end = n; end-- > 1; ) {
+    swapEntries(0, end);
+    siftDown(0, end);
+  }
+}
+
+// ====== Soubor ======
+static bool readTrailer(File& f, StoreTrailer& t) {
+  size_t size = f.size();
+  if (size < sizeof(t) || !f.seek(size - sizeof(t))) return false;
+  if (f.read((uint8_t*)&t, sizeof(t)) != sizeof(t)) return false;
+  return t.magic == STORE_MAGIC && t.version == STORE_VERSION && t.count <= CONTACT_STORE_MAX &&
+         size == t.count * (sizeof(ContactInfo) + sizeof(uint64_t) + sizeof(uint16_t)) + sizeof(t);
+}
+
+static bool loadIndex(uint32_t* jsonSize) {
+  setCount(0);
+  File f = LittleFS.open(CONTACTS_BIN_PATH, "r");
+  if (!f) return false;
+  StoreTrailer t;
+  bool ok = readTrailer(f, t) && f.seek(t.count * sizeof(ContactInfo)) &&
+            f.read((uint8_t*)keys, t.count * sizeof(uint64_t)) == t.count * sizeof(uint64_t) &&
+            f.read((uint8_t*)recs, t.count * sizeof(uint16_t)) == t.count * sizeof(uint16_t);
+  f.close();
+  if (!ok) return false;
+  if (jsonSize) *jsonSize = t.jsonSize;
+  setCount(t.count);
+  return true;
+}
+
+// Další znak mimo bílé znaky (nepřečte ho – '{' patří deserializeJson)
+static int peekToken(Stream& s) {
+  int c;
+  while ((c = s.peek()) == ' ' || c == '\t' || c == '\r' || c == '\n') s.read();
+  return c;
+}
+
+static void copyField(char* dst, size_t cap, const char* src) {
+  strlcpy(dst, src ? src : "", cap);
+}
+
+int contactStoreRebuild(const char* jsonPath) {
+  File in = LittleFS.open(jsonPath, "r");
+  if (!in) return -1;
+  File out = LittleFS.open(STORE_TMP_PATH, "w");
+  if (!out) { in.close(); return -1; }
+  setCount(0);
+
+  StaticJsonDocument<64> filter;
+  filter["name"] = true; filter["phone"] = true; filter["group"] = true;
+  StaticJsonDocument<256> doc;
+  uint16_t n = 0;
+  uint16_t skipped = 0;
+  bool ok = peekToken(in) == '[' && in.read() == '[';
+  if (ok && peekToken(in) == ']') in.read();
+  else {
+    while (ok) {
+      if (deserializeJson(doc, in, DeserializationOption::Filter(filter)) ||
+          !doc.is<JsonObject>()) { ok = false; break; }
+      ContactInfo c = {};
+      if (n < CONTACT_STORE_MAX && contactNormalize(doc["phone"] | "", c.number, sizeof(c.number))) {
+        copyField(c.name,  sizeof(c.name),  doc["name"]);
+        copyField(c.group, sizeof(c.group), doc["group"]);
+        keys[n] = makeKey(c.number);
+        recs[n] = n;
+        ok = out.write((const uint8_t*)&c, sizeof(c)) == sizeof(c);
+        n++;
+      } else {
+        skipped++;
+      }
+      peekToken(in);
+      int next = in.read();
+      if (next == ']') break;
+      if (next != ',') ok = false;
+    }
+  }
+  uint32_t jsonSize = in.size();
+  in.close();
+
+  if (ok) {
+    sortIndex(n);
+    StoreTrailer t = { STORE_MAGIC, STORE_VERSION, n, jsonSize };
+    ok = out.write((const uint8_t*)keys, n * sizeof(uint64_t)) == n * sizeof(uint64_t) &&
+         out.write((const uint8_t*)recs, n * sizeof(uint16_t)) == n * sizeof(uint16_t) &&
+         out.write((const uint8_t*)&t, sizeof(t)) == sizeof(t);
+  }
+  out.close();
+  if (!ok) {
+    LittleFS.remove(STORE_TMP_PATH);
+    loadIndex(nullptr);                      // keys[] jsou rozepsané
+    return -1;
+  }
+  LittleFS.remove(CONTACTS_BIN_PATH);
+  LittleFS.rename(STORE_TMP_PATH, CONTACTS_BIN_PATH);
+  setCount(n);
+  LOG_I("index: %u kontaktů, %u bez platného čísla / nad limit",
+        (unsigned)n, (unsigned)skipped);
+  return n;
+}
+
+void contactStoreBegin() {
+  uint32_t jsonSize = 0;
+  bool loaded = loadIndex(&jsonSize);
+  File f = LittleFS.open(CONTACTS_JSON_PATH, "r");
+  if (!f) return;
+  uint32_t size = f.size();
+  f.close();
+  // /contacts.json nahraný jinou cestou (FS upload) → index znovu
+  if (!loaded || jsonSize != size) contactStoreRebuild(CONTACTS_JSON_PATH);
+}
+
+size_t contactStoreCount() {
+  RtLockGuard g(lock);
+  return count;
+}
+
+bool contactLookup(const char* number, ContactInfo& out) {
+  char e164[CONTACT_NUMBER_MAX];
+  if (!contactNormalize(number, e164, sizeof(e164))) return false;
+  uint64_t key = makeKey(e164);
+
+  int32_t rec = -1;
+  {
+    RtLockGuard g(lock);
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+      size_t mid = (lo + hi) / 2;
+      if (keys[mid] < key) lo = mid + 1;
+      else hi = mid;
+    }
+    if (lo < count && keys[lo] == key) rec = recs[lo];
+  }
+  if (rec < 0) return false;
+
+  // Záznamy mají pevnou délku a jsou na začátku souboru. Index se mohl
+  // mezitím přestavět – číslo v záznamu proto musí souhlasit.
+  File f = LittleFS.open(CONTACTS_BIN_PATH, "r");
+  if (!f) return false;
+  bool ok = f.seek(rec * sizeof(ContactInfo)) &&
+            f.read((uint8_t*)&out, sizeof(out)) == sizeof(out);
+  f.close();
+  return ok && strcmp(out.number, e164) == 0;
+}
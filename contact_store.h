@@ -0,0 +1,58 @@
+// contact_store.h – binární adresář s indexem podle telefonního čísla
+//
+// /contacts.json zůstává zdrojem pro UI a hromadné SMS; při uložení
+// (a při startu, pokud neodpovídá velikost) se z něj po jednom kontaktu
+// sestaví /contacts.bin:
+//
+//   hlavička | klíče (uint64, seřazené) | č. záznamů (uint16) | záznamy
+//
+// Klíč = číslo v E.164 (bez '+') jako celé číslo + počet číslic. Klíče a
+// čísla záznamů se při startu načtou do RAM (10 B na kontakt), takže
+// vyhledání je půlení intervalu bez I/O; pro jméno a skupinu se pak
+// přečte jediný záznam pevné délky. Velikost adresáře neomezuje
+// JsonDocument, jen CONTACT_STORE_MAX.
+//
+// contactLookup() volá modemová úloha (CLIP), přestavbu síťová úloha.
+
+#pragma once
+#include <Arduino.h>
+
+#ifndef CONTACT_STORE_MAX
+  #define CONTACT_STORE_MAX     2048    // kontaktů v indexu (10 B RAM na kontakt)
+#endif
+#ifndef CONTACT_DEFAULT_CC
+  #define CONTACT_DEFAULT_CC    "420"   // předvolba pro národní čísla
+#endif
+#ifndef CONTACT_NATIONAL_LEN
+  #define CONTACT_NATIONAL_LEN  9       // délka národního čísla bez předvolby
+#endif
+#ifndef CONTACTS_JSON_MAX
+  #define CONTACTS_JSON_MAX     (256UL * 1024)   // největší nahrávaný /contacts.json
+#endif
+#define CONTACT_NUMBER_MAX      17      // "+" + 15 číslic E.164 + '\0'
+#define CONTACT_NAME_MAX        32
+#define CONTACT_GROUP_MAX       24
+#define CONTACTS_JSON_PATH      "/contacts.json"
+#define CONTACTS_BIN_PATH       "/contacts.bin"
+
+struct ContactInfo {
+  char number[CONTACT_NUMBER_MAX];      // E.164 s '+'
+  char name[CONTACT_NAME_MAX];
+  char group[CONTACT_GROUP_MAX];
+};
+
+// Číslo do tvaru E.164 ("+420777123456"); mezery, pomlčky, závorky
+// a tečky se vynechají, "00" → "+", národní číslo dostane
+// CONTACT_DEFAULT_CC. false = nejsou to číslice / moc dlouhé.
+bool   contactNormalize(const char* in, char* out, size_t cap);
+
+// Načte index z /contacts.bin (po LittleFS.begin); při chybějícím nebo
+// zastaralém souboru ho sestaví z /contacts.json.
+void   contactStoreBegin();
+// Sestaví /contacts.bin z JSON pole kontaktů a přepne na něj index.
+// Vrací počet kontaktů v indexu, -1 = neplatný JSON (index beze změny).
+int    contactStoreRebuild(const char* jsonPath);
+size_t contactStoreCount();
+
+// Kontakt podle čísla v libovolném zápisu; z kterékoli úlohy
+bool   contactLookup(const char* number, ContactInfo& out);
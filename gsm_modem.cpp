@@ -1,89 +1,75 @@
 // gsm_modem.cpp (optimalizovaná verze)
 #include "gsm_modem.h"
 #include "mqtt_module.h"
-#include <HardwareSerial.h>
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <sys/time.h>
+#include "at_engine.h"
+#include "settings.h"
+#include "rt_queue.h"
+#include "sms_retry.h"
+#include "sms_inbox.h"
+#include "sms_pdu.h"
+#include "sms_scheduler.h"
+#include "sms_history.h"
+#include "http_events.h"
+#include "metrics.h"
+#include "modem_urc.h"
+#include "modem_uart.h"
+#include "call_log.h"
+#include <atomic>
+
+#define LOG_TAG "GSM"
+#ifndef GSM_LOG_LEVEL
+  #define GSM_LOG_LEVEL LOG_LEVEL
+#endif
+#define LOG_LEVEL_MODULE GSM_LOG_LEVEL
+#include "log.h"
 
 // ====== Konfigurace a konstanty ======
-extern HardwareSerial SerialGSM(2);
-static String urcBuffer;
+ModemUart SerialGSM(UART_NUM_2);
 static unsigned long ringStartTimestamp = 0;
 static uint16_t ringCount = 0;
 static String lastCaller = "";
-static const char* CALL_LOG_PATH = "/call_log.json";
 static const char* SMS_HISTORY_CONF = "/sms_history.conf";
 static uint16_t smsHistoryMaxCount = 50;  // výchozí hodnota
 // --- Uživatelsky nastavitelný počet RING před zavěšením (default 1) ---
 static uint8_t maxRingCount = 1;
 static const char* RINGS_PATH = "/rings.conf";
 
-constexpr uint8_t MAX_TASKS = 8;
-constexpr unsigned long CMD_INTERVAL = 200;      // Pauza mezi AT příkazy [ms]
 constexpr unsigned long SMS_TIMEOUT  = 15000;    // Timeout na +CMGS [ms]
 constexpr unsigned long SMS_PROMPT_TIMEOUT    = 10000;     // Timeout na prompt '>' [ms]
 
 static unsigned long lastSmsQueueStatusLog = 0;
 const unsigned long smsQueueStatusLogInterval = 15000; // ms
 
-// ====== Datové struktury fronty ======
-struct SmsTaskQueue {
-  SmsTask buffer[MAX_TASKS];
-  uint8_t head = 0, tail = 0;
-
-  bool isEmpty() const { return head == tail; }
-  bool isFull()  const { return ((tail + 1) % MAX_TASKS) == head; }
-
-  bool enqueue(const SmsTask& task) {
-    if (isFull()) return false;
-    buffer[tail] = task;
-    tail = (tail + 1) % MAX_TASKS;
-    return true;
-  }
-
-  SmsTask dequeue() {
-    SmsTask t = buffer[head];
-    head = (head + 1) % MAX_TASKS;
-    return t;
-  }
-
-  int size() const {
-    if (tail >= head)
-      return tail - head;
-    else
-      return MAX_TASKS - head + tail;
-  }
-};
-
-static SmsTaskQueue smsQueue;
+// ====== Předávání mezi úlohami ======
+// Úlohy SMS předává sms_queue (slab + SPSC fronty), stav stroje jde ven
+// jen snímkem.
+static SeqSnapshot<SmsStatusSnapshot> smsStatusSnap;
+static std::atomic<bool>              reconfigRequested{false};
 
 // ====== Stavový automat pro SMS ======
 static SmsState      smsState       = SMS_IDLE;
-static SmsTask       currentTask;
-static unsigned long stateTimestamp = 0;
-static String        responseBuf;
-
-// ====== Pomocné makra pro debug výpis ======
-#ifndef GSM_DEBUG
-  #define GSM_DEBUG 1
-#endif
-
-#if GSM_DEBUG
-  #define GSM_DBG_FMT(fmt, ...) do { \
-    Serial.print(F("[GSM] ")); \
-    Serial.printf((fmt), ##__VA_ARGS__); \
-    Serial.println(); \
-  } while(0)
-
-  #define GSM_DBG(x) do { \
-    Serial.print(F("[GSM] ")); \
-    Serial.println(x); \
-  } while(0)
-#else
-  #define GSM_DBG_FMT(fmt, ...) do {} while(0)
-  #define GSM_DBG(x) do {} while(0)
-#endif
+static uint16_t      currentSlot    = SMS_SLOT_NONE;
+static bool          smsStatusDirty = true;
+
+// PDU mód se nastavuje jednou za relaci. Po chybě nebo timeoutu se
+// zneplatní (modem mohl restartovat) a příští úloha pošle AT+CMGF znovu.
+static bool          smsModeReady   = false;
+
+// Aktuální úloha rozložená na segmenty (sms_pdu.h); PDU segmentu se
+// zakóduje při zakládání AT+CMGS (délka TPDU je jeho parametr).
+static SmsPlan       smsPlanCur;
+static uint8_t       smsSegment     = 0;
+static uint8_t       smsConcatRef   = 0;
+static char          smsPduHex[SMS_PDU_HEX_MAX];
+
+// ====== Propustnost ======
+static SmsThroughput smsStats;
+static unsigned long jobStart    = 0;
+static unsigned long batchStart  = 0;
+static bool          batchActive = false;
 
 // ====== Pomocné funkce ======
 uint16_t getSmsHistoryMaxCount() {
@@ -105,88 +91,37 @@ void loadSmsHistoryMaxCount() {
   }
 }
 
-static void flushSerialGSM() {
-  while (SerialGSM.available()) SerialGSM.read();
-}
-
-// Pošle řádek s CR+LF a zároveň to zobrazí v logu
-static void sendAndPrint(const char* cmd, unsigned long timeout = 1000) {
-  flushSerialGSM(); 
-  GSM_DBG(String(F("> ")) + cmd);
-  SerialGSM.println(cmd);
-  
-  unsigned long start = millis();
-  while (millis() - start < timeout) {
-    if (SerialGSM.available()) {
-      String line = SerialGSM.readStringUntil('\n');
-      line.trim();
-      GSM_DBG(String(F("  < ")) + line);
-      if (line == "OK" || line == "ERROR") {
-        break;
-      }
-    }
-  }
+// ====== Požadavky z ostatních úloh ======
+void modemRequestReconfigure() {
+  reconfigRequested = true;
 }
 
-// Čeká na řádek obsahující buď "OK", "ERROR" nebo "+CMGS:"
-// Vrací true, pokud přišlo "+CMGS:", false pokud "ERROR" nebo timeout
-static bool waitForOkOrErrorOrCmgs(unsigned long timeout) {
-  unsigned long t0 = millis();
-  String line;
-  while (millis() - t0 < timeout) {
-    if (SerialGSM.available()) {
-      line = SerialGSM.readStringUntil('\n');
-      line.trim();
-      if (line.length() == 0) continue;
-      GSM_DBG(String(F("  < ")) + line);
-      if (line.indexOf("+CMGS:") != -1) {
-        return true;
-      }
-      if (line == "OK") {
-        // modul v některých případech vyšle OK až po +CMGS, ale pokud
-        // ještě nevidíme +CMGS, pokračujeme číst dokud nevyprší.
-        continue;
-      }
-      if (line == "ERROR") {
-        return false;
-      }
-    }
-  }
-  return false;
+static void applyPendingReconfigure() {
+  if (!reconfigRequested.exchange(false)) return;
+  atSubmit(settings.atctzu ? "AT+CTZU=1" : "AT+CTZU=0");
+  atSubmit(settings.atctr  ? "AT+CTZR=1" : "AT+CTZR=0");
+  atSubmit(settings.atclip ? "AT+CLIP=1" : "AT+CLIP=0");
 }
 
-// Čeká na znak '>' v odpovědích modemu, vrací true pokud přišel prompt včas
-static bool waitForPrompt(unsigned long timeout) {
-  unsigned long t0 = millis();
-  while (millis() - t0 < timeout) {
-    if (SerialGSM.available()) {
-      char c = SerialGSM.read();
-      responseBuf += c;
-      // GSM_DBG(String(F("  buf: ")) + responseBuf);
-      if (responseBuf.indexOf('>') != -1) {
-        return true;
-      }
-    }
+// ====== Napojení na AT engine ======
+// Vyprázdní celý RX buffer UART; řádky a prompt rozdělí modem_urc.
+void handleModemURC() {
+  uint8_t  chunk[64];
+  uint32_t rx = 0;
+  int avail;
+  while ((avail = SerialGSM.available()) > 0) {
+    size_t n = SerialGSM.readBytes(chunk, min((size_t)avail, sizeof(chunk)));
+    if (!n) break;
+    urcFeed(chunk, n);
+    rx += n;
   }
-  return false;
+  if (rx) metricsAdd(MC_UART_RX_BYTES, rx);
+  applyPendingReconfigure();
+  atEngineLoop();
 }
 
-void handleModemURC() {
-  while (SerialGSM.available()) {
-    char c = SerialGSM.read();
-    urcBuffer += c;
-    // každý CR/LF končí jedna URC řádka
-    if (c == '\n') {
-      String line = urcBuffer;
-      line.trim();          // odstraní \r i mezery
-      urcBuffer = "";
-      if (line.length() == 0) return;
-
-      GSM_DBG(String(F("[URC] ")) + line);
-      processCallerIDLine(line);
-      processSmsResponseLine(line);
-    }
-  }
+void modemWaitRx(uint32_t maxMs) {
+  SerialGSM.waitEvent(maxMs);
 }
 /*
 void startNtpSync() {
@@ -223,17 +158,19 @@ void processNtpSync() {
     // Jinak čekej dále – funkce je neblokující
 }
 */
+// Výpis odpovědi jednoho diagnostického příkazu
+static void printSettingDone(const AtResult& res, void* ctx) {
+  LOG_I("%s: %s", (const char*)ctx, res.status == AT_OK ? res.response : "ERROR/timeout");
+}
+
 void printModemSettings() {
-  Serial.println(F("=== Modem settings ==="));
-  const char* cmds[] = {
+  LOG_I("=== Modem settings (async) ===");
+  static const char* cmds[] = {
     "ATI", "AT+CSQ", "AT+CREG?", "AT+CGATT?", "AT+COPS?", "AT+CPIN?", "AT+CCID"
   };
   for (const char* cmd : cmds) {
-    sendAndPrint(cmd);
-    delay(1500);      // pauza 1,5 s mezi příkazy
-    flushSerialGSM(); // očistíme buffer
+    atSubmit(cmd, printSettingDone, (void*)cmd, 1500, AT_CAPTURE_ALL);
   }
-  Serial.println(F("=== End of settings ==="));
 }
 
 // ====== Časová logika (NTP) ======
@@ -247,80 +184,100 @@ String getCurrentTimeString() {
   return String(buf);
 }
 
-// ---- Nové helpery pro modem-status ----
-String queryModem(const char* cmd, unsigned long timeout=1000) {
-  // odešle příkaz, počká na OK a vrátí vše mezi (včetně +XXX: …)
-  responseBuf = "";
-  SerialGSM.println(cmd);
-  unsigned long t0 = millis();
-  while (millis() - t0 < timeout) {
-    if (SerialGSM.available()) {
-      String line = SerialGSM.readStringUntil('\n');
-      line.trim();
-      if (line.length()==0) continue;
-      responseBuf += line + "\n";
-      if (line == "OK" || line == "ERROR") break;
-    }
+// ---- Telemetrie modemu (cache pro /api/modem-status) ----
+// Dotazy CSQ/COPS/CREG/CGATT se zakládají na pozadí v daném intervalu,
+// HTTP handler čte jen hotový snímek z paměti.
+static ModemStatus   modemStatus;           // pracovní kopie modemové úlohy
+static SeqSnapshot<ModemStatus> modemStatusSnap;
+static unsigned long lastStatusPoll = 0;
+static uint8_t       statusPending  = 0;   // počet rozpracovaných dotazů
+
+// Snímek pro HTTP; událost pro /api/events jen při změně hodnoty
+static void publishStatus() {
+  static ModemStatus notified;
+  modemStatusSnap.publish(modemStatus);
+  if (modemStatus.signal    != notified.signal    ||
+      modemStatus.regStatus != notified.regStatus ||
+      modemStatus.attached  != notified.attached  ||
+      strcmp(modemStatus.operatorName, notified.operatorName) != 0) {
+    notified = modemStatus;
+    httpEventModemStatus();
   }
-  return responseBuf;
 }
 
-uint8_t readSignalQuality() {
-  String out = queryModem("AT+CSQ");
-  int idx = out.indexOf("+CSQ:");
-  if (idx >= 0) {
-    int comma = out.indexOf(',', idx);
-    return out.substring(idx + 5, comma).toInt();
+static void onCsqDone(const AtResult& res, void*) {
+  statusPending--;
+  const char* p = strstr(res.response, "+CSQ:");
+  if (res.status != AT_OK || !p) return;
+  modemStatus.signal   = atoi(p + 5);
+  modemStatus.signalAt = millis();
+  publishStatus();
+}
+
+static void onCopsDone(const AtResult& res, void*) {
+  statusPending--;
+  if (res.status != AT_OK) return;
+  const char* q1 = strchr(res.response, '"');
+  const char* q2 = q1 ? strchr(q1 + 1, '"') : nullptr;
+  if (q2) {
+    size_t n = min((size_t)(q2 - q1 - 1), sizeof(modemStatus.operatorName) - 1);
+    memcpy(modemStatus.operatorName, q1 + 1, n);
+    modemStatus.operatorName[n] = '\0';
+  } else {
+    strcpy(modemStatus.operatorName, "--");   // bez registrace v síti
   }
-  return 0;
+  modemStatus.operatorAt = millis();
+  publishStatus();
 }
 
-String readOperatorName() {
-  String out = queryModem("AT+COPS?");
-  int idx = out.indexOf("+COPS:");
-  if (idx >= 0) {
-    int q1 = out.indexOf('"', idx);
-    int q2 = out.indexOf('"', q1 + 1);
-    return out.substring(q1 + 1, q2);
-  }
-  return String("--");
+static void onCregDone(const AtResult& res, void*) {
+  statusPending--;
+  // +CREG: <n>,<stat>
+  const char* p = strstr(res.response, "+CREG:");
+  const char* comma = p ? strchr(p, ',') : nullptr;
+  if (res.status != AT_OK || !comma) return;
+  modemStatus.regStatus = atoi(comma + 1);
+  modemStatus.regAt     = millis();
+  publishStatus();
 }
 
-// ====== Logování volání ======
-void logCallToFile(const String& caller) {
-  StaticJsonDocument<8192> doc;
-  JsonArray arr;
-  File f = LittleFS.open(CALL_LOG_PATH, "r");
-  if (f) {
-    DeserializationError err = deserializeJson(doc, f);
-    f.close();
-    if (err) {
-      doc.clear();
-      arr = doc.to<JsonArray>();
-    } else {
-      if (!doc.is<JsonArray>()) {
-        doc.clear();
-        arr = doc.to<JsonArray>();
-      } else {
-        arr = doc.as<JsonArray>();
-      }
-    }
-  } else {
-    arr = doc.to<JsonArray>();
-  }
+static void onCgattDone(const AtResult& res, void*) {
+  statusPending--;
+  const char* p = strstr(res.response, "+CGATT:");
+  if (res.status != AT_OK || !p) return;
+  modemStatus.attached = atoi(p + 7) == 1;
+  modemStatus.attachAt = millis();
+  publishStatus();
+}
 
-  // Přidej nový záznam
-  JsonObject entry = arr.createNestedObject();
-  entry["datetime"] = getCurrentTimeString();
-  entry["number"] = caller;
+static void submitStatusQuery(const char* cmd, AtDoneFn done, const char* prefix) {
+  if (atSubmit(cmd, done, nullptr, 1000, prefix)) statusPending++;
+}
 
-  // Udržuj jen posledních 10 záznamů
-  while (arr.size() > 10) arr.remove(0);
+void modemStatusLoop() {
+  unsigned long now = millis();
+  uint32_t interval = settings.modemPollInterval;
+  if (interval == 0 || statusPending) return;
+  if (lastStatusPoll && now - lastStatusPoll < interval) return;
+  // SMS má přednost – dotazy nezakládáme, dokud engine něco zpracovává
+  if (atEngineBusy()) return;
+  lastStatusPoll = now;
+  submitStatusQuery("AT+CSQ",    onCsqDone,   "+CSQ:");
+  submitStatusQuery("AT+COPS?",  onCopsDone,  "+COPS:");
+  submitStatusQuery("AT+CREG?",  onCregDone,  "+CREG:");
+  submitStatusQuery("AT+CGATT?", onCgattDone, "+CGATT:");
+}
 
-  // Ulož zpět
-  f = LittleFS.open(CALL_LOG_PATH, "w");
-  serializeJson(doc, f);
-  f.close();
+ModemStatus getModemStatus() {
+  return modemStatusSnap.read();
+}
+
+uint8_t readSignalQuality() {
+  return modemStatusSnap.read().signal;
+}
+
+String readOperatorName() {
+  return String(modemStatusSnap.read().operatorName);
 }
 
 // ====== RING nastavení ======
@@ -344,22 +301,133 @@ uint8_t getRingSetting() {
   return maxRingCount;
 }
 
+// ====== URC handlery (volá modem_urc) ======
+// Stav hovoru: CLIP otevře hovor, první RING po něm zavěsí
+static bool          clipSeen   = false;   // CLIP pro tento hovor už proběhl
+static bool          callLogged = false;   // hovor už je ve frontě logu volání
+static unsigned long lastHangup = 0;       // čas posledního ATH (debounce)
+static bool          hangupQueued = false; // ATH čeká v AT enginu
+
+static void onHangupDone(const AtResult& res, void*) {
+  hangupQueued = false;
+  if (res.status != AT_OK) LOG_W("ATH selhalo (%d)", res.errorCode);
+}
+
+// ATH přes AT engine: nesmí se vklínit do rozeslaného AT+CMGS/PDU
+// a jeho OK nesmí ukončit jiný příkaz
+static void hangUp() {
+  if (hangupQueued) return;
+  hangupQueued = atSubmit("ATH", onHangupDone, nullptr, 5000);
+  if (!hangupQueued) LOG_W("ATH nezařazen, fronta AT plná");
+}
+
+// +CLIP: "<číslo>",<typ>,...
+static void onClip(const char* line, size_t) {
+  if (millis() - lastHangup < 5000) {      // CLIP krátce po zavěšení ignorujeme
+    LOG_D("CLIP ignorován - krátce po zavěšení");
+    hangUp();
+    return;
+  }
+  const char* f = strchr(line, '"');
+  const char* l = f ? strchr(f + 1, '"') : nullptr;
+  if (!l) {
+    LOG_W("⚠️ CLIP parse error: %s", line);
+    return;
+  }
+  char rawNum[CONTACT_NUMBER_MAX + 8];
+  size_t n = min((size_t)(l - f - 1), sizeof(rawNum) - 1);
+  memcpy(rawNum, f + 1, n);
+  rawNum[n] = '\0';
+  const char* mqttNum = rawNum[0] == '+' ? rawNum + 1 : rawNum;
+  LOG_I("📡 CallerID: %s", rawNum);
+
+  // Označíme, že už jsme CLIP viděli a začíná nové volání
+  clipSeen  = true;
+  ringCount = 0;
+
+  // Jméno a skupina z indexu adresáře (bez čtení /contacts.json)
+  ContactInfo contact;
+  bool known = contactLookup(rawNum, contact);
+  if (known) LOG_I("📇 Kontakt: %s / %s", contact.name, contact.group);
+
+  // Publikace na MQTT (odeslání čísla) a do /api/events
+  mqttPublishCaller(mqttNum, known ? &contact : nullptr);
+  httpEventCall(rawNum);
+
+  // LOG pouze jednou pro tento hovor; soubor zapíše síťová úloha
+  if (!callLogged) callLogged = callLogPush(rawNum);
+}
+
+// RING (jen po CLIP) → zavěsit
+static void onRing(const char*, size_t) {
+  if (!clipSeen) return;
+  ringCount++;
+  LOG_D("🔔 RING #%u", (unsigned)ringCount);
+
+  hangUp();
+  LOG_D("📴 ATH, hovor ukončen");
+
+  // Publikace prázdného čísla (vynulování MQTT topicu)
+  mqttPublishCaller("");
+  httpEventCall("");
+
+  lastHangup = millis();
+  clipSeen   = false;
+  ringCount  = 0;
+  callLogged = false;
+}
+
+// +CREG: <stat> – nevyžádaná změna registrace (AT+CREG=1 v modemInit),
+// u AT+CREG=2 s ,"<lac>","<ci>". Odpověď na AT+CREG? ("+CREG: <n>,<stat>")
+// sem dojde jen po timeoutu dotazu – <stat> je pak až za čárkou.
+static void onCreg(const char* line, size_t) {
+  const char* comma = strchr(line + 6, ',');
+  bool reply = comma && comma[1] != '"';
+  modemStatus.regStatus = atoi(reply ? comma + 1 : line + 6);
+  modemStatus.regAt     = millis();
+  publishStatus();
+}
+
+// +CTZV: <tz>[,<čas>] – síť poslala časové pásmo (AT+CTZR=1)
+static void onCtzv(const char* line, size_t) {
+  LOG_I("Časové pásmo ze sítě: %s", line + 6);
+}
+
+// +CMGS mimo AT+CMGS = potvrzení po vypršení limitu; SMS nejspíš odešla,
+// i když úloha už je v opakování nebo dead-letter
+static void onLateCmgs(const char* line, size_t) {
+  LOG_W("Opožděné %s (po timeoutu AT+CMGS)", line);
+}
+
+// Seřazeno podle klíče (strcmp), viz modem_urc.h
+static const UrcRoute URCS[] = {
+  { "+CLIP",  0,         onClip },
+  { "+CMGR",  URC_FIRST, smsInboxOnHeader },
+  { "+CMGS",  0,         onLateCmgs },
+  { "+CMT",   URC_FIRST, smsInboxOnHeader },
+  { "+CMTI",  URC_FIRST, smsInboxOnCmti },
+  { "+CREG",  0,         onCreg },
+  { "+CTZV",  0,         onCtzv },
+  { "RING",   0,         onRing },
+};
+
 // ====== Inicializace modemu ======
 void modemInit() {
-  SerialGSM.begin(9600, SERIAL_8N1, GSM_RX_PIN, GSM_TX_PIN);
-    delay(1000);
-  sendAndPrint("AT");
-    delay(200); 
-  sendAndPrint("ATE1");
-    delay(200); 
-  sendAndPrint("AT+CMEE=2");
-    delay(200); 
-  sendAndPrint("AT+CLIP=1");
-    delay(200);
-  sendAndPrint("AT+CTZU=1");  // automatická aktualizace
-    delay(200);
-  sendAndPrint("AT+CTZR=1");  // či ruční dotaz
-    delay(200);
+  SerialGSM.begin(MODEM_UART_BAUD, GSM_RX_PIN, GSM_TX_PIN);
+  delay(1000);                // jen při startu: modem se probouzí
+  atEngineBegin(SerialGSM);
+  urcBegin(URCS, sizeof(URCS) / sizeof(URCS[0]));
+  // Vše se odešle postupně z atEngineLoop(), nic se zde nečeká.
+  // ATE0: bez echa, odpovědi páruje engine podle finálního řádku.
+  atSubmit("AT");
+  atSubmit("ATE0");
+  atSubmit("AT+CMEE=1");  // číselné +CMS/+CME ERROR pro smsErrorIsPermanent()
+  atSubmit("AT+CLIP=1");
+  atSubmit("AT+CREG=1");  // změny registrace jako URC (onCreg)
+  atSubmit("AT+CTZU=1");  // automatická aktualizace
+  atSubmit("AT+CTZR=1");  // či ruční dotaz
+  smsDeadLetterInit();
+  smsInboxInit();
 }
 
 // ====== DTR řízení ======
@@ -374,264 +442,281 @@ void wakeModem() {
   digitalWrite(DTR_PIN, HIGH);
 }
 
-// ====== Caller ID/RING zpracování ======
-// Pouze parsuje jeden URC-řádek
-// ====== Caller ID / RING zpracování ======
-void processCallerIDLine(const String &line) {
-  static bool clipSeen = false;        // indikace, že už proběhl CLIP pro tento hovor
-  static bool callLogged = false;      // jestli už jsme hovor logovali
-  static unsigned long lastHangup = 0; // čas posledního zavěšení (ATH)
-  static String lastCallerNum = "";    // poslední volající (pro opakování)
-
-  unsigned long now = millis();
-
-  // 1) CLIP URC (příchozí číslo volajícího)
-  if (line.startsWith("+CLIP:")) {
-    // Debounce: pokud bylo před chvílí zavěšeno, ignoruj nové CLIP události
-    if (now - lastHangup < 5000) {   // 5000 ms = 5 sekund, lze změnit dle potřeby
-      GSM_DBG(F("CLIP ignorován - krátce po zavěšení"));
-      SerialGSM.println("ATH");
-      return;
-    }
-
-    int f = line.indexOf('"');
-    int l = line.indexOf('"', f + 1);
-    if (f >= 0 && l > f) {
-      String rawNum = line.substring(f + 1, l);
-      String mqttNum = rawNum;
-      if (mqttNum.startsWith("+")) mqttNum.remove(0, 1);
-
-      GSM_DBG(String(F("📡 CallerID raw: ")) + rawNum);
-      GSM_DBG(String(F("📡 CallerID mqtt: ")) + mqttNum);
-
-      lastCallerNum = mqttNum;
+// ====== Fronta SMS (enqueue API) ======
+uint32_t enqueueSms(const String& recipients, const String& message, SmsSource src) {
+  return smsJobSubmit(recipients.c_str(), message.c_str(), src);
+}
 
-      // Označíme, že už jsme CLIP viděli a začíná nové volání
-      clipSeen = true;
-      ringCount = 0;
+static void publishSmsStatus() {
+  SmsStatusSnapshot snap;
+  snap.state     = smsState;
+  snap.currentId = (currentSlot != SMS_SLOT_NONE) ? smsJobId(currentSlot) : 0;
+  snap.stats     = smsStats;
+  smsStatusSnap.publish(snap);
+}
 
-      // Publikace na MQTT (odeslání čísla)
-      mqttPublishCaller(mqttNum);
+// ====== Stavový stroj pro neblokující odesílání SMS ======
+// Přechody mezi stavy provádějí callbacky AT enginu, processSmsQueue()
+// jen zakládá příkazy a uklízí po dokončení.
+static void onSmsPduMode(const AtResult& res, void*) {
+  smsModeReady = (res.status == AT_OK);
+  smsState = smsModeReady ? SMS_SEND_HEADER : SMS_ERROR;
+}
+
+static void onSmsPrompt(Print& out, void*) {
+  LOG_D("Prompt '>' přijat, posílám PDU segmentu");
+  smsState = SMS_SEND_BODY;
+  out.print(smsPduHex);
+  smsState = SMS_WAIT_OK;
+}
+
+// +CMGS: <mr> → reference zprávy v modemu (pro doručenky)
+static int smsMsgRef = -1;
+static int smsLastError = -1;
+
+static void onSmsSent(const AtResult& res, void*) {
+  const char* p = strstr(res.response, "+CMGS:");
+  smsMsgRef    = p ? atoi(p + 6) : -1;
+  smsLastError = res.errorCode;
+  if (res.status == AT_OK) {
+    LOG_D("✅ Segment %u/%u odeslán (+CMGS: %d)",
+          (unsigned)smsSegment + 1, (unsigned)smsPlanCur.segments, smsMsgRef);
+    // další segment jde hned, celá úloha je hotová až po posledním
+    smsStats.segments++;
+    smsState = (++smsSegment < smsPlanCur.segments) ? SMS_SEND_HEADER : SMS_DONE;
+  } else {
+    LOG_W("❌ SMS neodeslána (%s, kód %d)",
+          res.status == AT_TIMEOUT ? "timeout" : "ERROR", res.errorCode);
+    smsModeReady = false;
+    smsState = SMS_ERROR;
+  }
+}
 
-      // LOG pouze jednou pro tento hovor
-      if (!callLogged) {
-        logCallToFile(rawNum);
-        callLogged = true;
-      }
-    } else {
-      GSM_DBG(F("⚠️ CLIP parse error"));
-    }
+// Zakóduje segment smsSegment a založí AT+CMGS=<délka TPDU>
+static bool submitSmsHeader() {
+  size_t tpduLen = smsEncodeSubmit(smsJobRecipient(currentSlot), smsJobText(currentSlot),
+                                   smsPlanCur, smsSegment, smsConcatRef,
+                                   smsPduHex, sizeof(smsPduHex));
+  if (!tpduLen) return false;
+  AtCommand c;
+  snprintf(c.cmd, sizeof(c.cmd), "AT+CMGS=%u", (unsigned)tpduLen);
+  c.prefix        = "+CMGS:";
+  c.promptTimeout = SMS_PROMPT_TIMEOUT;
+  c.timeout       = SMS_TIMEOUT;
+  c.onPrompt      = onSmsPrompt;
+  c.onDone        = onSmsSent;
+  return atSubmit(c);
+}
+
+// Přechod stavu aktuální úlohy pro /api/events
+static void notifyJob(SmsJobState st) {
+  httpEventSmsJob(smsJobId(currentSlot), st, smsJobAttempts(currentSlot), smsLastError);
+}
+
+// Úloha je vybraná v currentSlot: AT+CMGF jen pokud mód ještě není platný
+static void startSmsJob() {
+  jobStart = millis();
+  smsMsgRef = smsLastError = -1;
+  smsJobMarkSending(currentSlot);
+  notifyJob(SMS_JOB_SENDING);
+  // opakovaný pokus posílá všechny segmenty znovu s novou referencí
+  smsSegment = 0;
+  smsConcatRef++;
+  if (!batchActive) {
+    batchActive        = true;
+    batchStart         = jobStart;
+    smsStats.batchSent = 0;
+    smsStats.batchMs   = 0;
   }
-  // 2) RING (pouze pokud jsme už viděli CLIP)
-  else if (clipSeen && line == "RING") {
-    ringCount = (ringCount == 0) ? 1 : (ringCount + 1);
-    GSM_DBG(String(F("🔔 RING #")) + ringCount);
-
-    // Po dosažení max. počtu vyzvánění ukončíme hovor
-    if (ringCount >= 1) {
-      // Nejprve přijmi hovor (ATA)
-      /*
-      SerialGSM.println("ATA");
-      GSM_DBG(F("📞 ATA (příjem hovoru)"));
-      delay(1500); // počkej na navázání spojení (1,5 s je většinou dostatečné)
-      */
-      // Poté zavěsi (ATH)
-      SerialGSM.println("ATH");
-      GSM_DBG(String(F("📴 ATH po ATA, hovor ukončen")));
-
-      // Publikace prázdného čísla (vynulování MQTT topicu)
-      mqttPublishCaller("");
-
-      // Nastav čas zavěšení pro debounce
-      lastHangup = now;
-
-      // Resetujeme stav pro další hovory
-      clipSeen = false;
-      ringCount = 0;
-      callLogged = false;
-    }
+  if (!smsPlan(smsJobText(currentSlot), smsPlanCur)) {
+    LOG_W("❌ Text nelze zakódovat (neplatné UTF-8 nebo příliš dlouhý)");
+    smsLastError = 304;             // Invalid PDU mode parameter → trvalá chyba
+    smsState = SMS_ERROR;
+    return;
+  }
+  LOG_D("SMS: %s, %u jednotek, %u segment(ů)",
+        smsPlanCur.encoding == SMS_ENC_GSM7 ? "GSM-7" : "UCS-2",
+        (unsigned)smsPlanCur.units, (unsigned)smsPlanCur.segments);
+  if (smsModeReady) {
+    smsState = SMS_WAIT_PROMPT;
+    if (!submitSmsHeader()) smsState = SMS_ERROR;
+  } else {
+    smsState = SMS_SET_PDU_MODE;
+    if (!atSubmit("AT+CMGF=0", onSmsPduMode)) smsState = SMS_ERROR;
   }
 }
 
+// Neúspěch: přechodná chyba → odložit (backoff), jinak dead-letter
+static bool retryOrDeadLetter() {
+  uint8_t attempts = smsJobAttempts(currentSlot);
+  if (!smsErrorIsPermanent(smsLastError) && attempts < settings.smsMaxAttempts) {
+    uint32_t delayMs = smsRetryDelay(attempts);
+    LOG_W("SMS #%u: chyba %d, pokus %u/%u, další za %u ms",
+          (unsigned)smsJobId(currentSlot), smsLastError, (unsigned)attempts,
+          (unsigned)settings.smsMaxAttempts, (unsigned)delayMs);
+    smsJobMarkRetry(currentSlot, smsLastError, delayMs);
+    notifyJob(SMS_JOB_RETRYING);
+    return true;
+  }
+  SmsJobInfo info;
+  if (smsJobGet(smsJobId(currentSlot), info)) {
+    info.lastError = smsLastError;
+    smsDeadLetterAdd(info, smsJobText(currentSlot));
+  }
+  LOG_E("SMS #%u: chyba %d po %u pokusech → dead-letter",
+        (unsigned)smsJobId(currentSlot), smsLastError, (unsigned)attempts);
+  smsJobMarkFailed(currentSlot, smsLastError);
+  notifyJob(SMS_JOB_FAILED);
+  return false;
+}
 
-
-// Přebírá stejnou řádku a posílá ji do SMS stavového stroje
-void processSmsResponseLine(const String &line) {
-  // např. hledání "+CMGS:" nebo "ERROR"
-  if (smsState == SMS_WAIT_OK) {
-    responseBuf += line;
-    if (responseBuf.indexOf("+CMGS:") != -1) {
-      smsState = SMS_DONE;
-    } else if (line == "ERROR") {
-      smsState = SMS_ERROR;
-    }
+static void finishSmsJob(bool ok) {
+  unsigned long now = millis();
+  bool retried = false;
+  if (ok) {
+    smsHistoryAppend(smsJobRecipient(currentSlot), smsJobText(currentSlot));
+    smsJobMarkSent(currentSlot, smsMsgRef);
+    notifyJob(SMS_JOB_SENT);
+  } else {
+    retried = retryOrDeadLetter();
+  }
+  currentSlot = SMS_SLOT_NONE;
+  smsStats.lastJobMs = now - jobStart;
+  smsStats.avgJobMs  = smsStats.avgJobMs
+                     ? smsStats.avgJobMs - smsStats.avgJobMs / 8 + smsStats.lastJobMs / 8
+                     : smsStats.lastJobMs;
+  if (ok) {
+    smsStats.sent++;
+    smsStats.batchSent++;
+  } else if (retried) {
+    smsStats.retried++;
+  } else {
+    smsStats.failed++;
   }
+  smsStats.batchMs   = now - batchStart;
+  smsStats.perMinute = smsStats.batchMs ? (uint32_t)(smsStats.batchSent * 60000ULL / smsStats.batchMs) : 0;
+  smsStatusDirty = true;
 }
 
-// ====== Fronta SMS (enqueue API) ======
-bool enqueueSms(const String& recipients, const String& message) {
-  return smsQueue.enqueue({ recipients, message });
+static void endBatch() {
+  LOG_I("Dávka hotová: %u SMS za %u ms (%u SMS/min, průměr %u ms/SMS)",
+        (unsigned)smsStats.batchSent, (unsigned)smsStats.batchMs,
+        (unsigned)smsStats.perMinute, (unsigned)smsStats.avgJobMs);
+  // hodnoty dávky zůstávají ve snímku do začátku další dávky
+  batchActive = false;
 }
 
-// ====== Stavový stroj pro neblokující odesílání SMS ======
 void processSmsQueue() {
+  smsDeadLetterLoop();
+  SmsState prevState = smsState;
   unsigned long now = millis();
   if (now - lastSmsQueueStatusLog >= smsQueueStatusLogInterval) {
-    GSM_DBG_FMT("SMS stav: %d, fronta má %d úkolů", smsState, smsQueue.size());
+    LOG_D("SMS stav: %d, fronta má %u úkolů", smsState, (unsigned)smsJobActiveCount());
     lastSmsQueueStatusLog = now;
   }
 
+  // Dokončenou úlohu uzavřeme a v témže průchodu začneme další,
+  // takže další AT+CMGS jde hned po +CMGS předchozí zprávy.
+  if (smsState == SMS_DONE || smsState == SMS_ERROR) {
+    finishSmsJob(smsState == SMS_DONE);
+    smsState = SMS_IDLE;
+  }
+
   switch (smsState) {
     case SMS_IDLE:
-      if (!smsQueue.isEmpty()) {
-        currentTask = smsQueue.dequeue();
-        GSM_DBG(String(F("Odesílám SMS na: ")) + currentTask.recipients);
-        responseBuf.clear();
-        flushSerialGSM();
-        smsState = SMS_SET_TEXT_MODE;
+      currentSlot = smsJobNext();
+      if (currentSlot != SMS_SLOT_NONE) {
+        LOG_I("Odesílám SMS #%u na: %s", (unsigned)smsJobId(currentSlot),
+              smsJobRecipient(currentSlot));
+        startSmsJob();
+      } else if (batchActive) {
+        endBatch();
       }
       break;
 
-    case SMS_SET_TEXT_MODE:
-      sendAndPrint("AT+CMGF=1");
-      stateTimestamp = millis();
-      smsState = SMS_SEND_HEADER;
-      responseBuf.clear();
-      break;
-
     case SMS_SEND_HEADER:
-      // Po krátké pauze začneme posílat hlavičku AT+CMGS
-      if (millis() - stateTimestamp >= CMD_INTERVAL) {
-        responseBuf.clear();
-        SerialGSM.print("AT+CMGS=\"");
-        SerialGSM.print(currentTask.recipients);
-        SerialGSM.println("\"");
-        stateTimestamp = millis();
-        smsState = SMS_WAIT_PROMPT;
-      }
+      // PDU mód potvrzen / další segment → AT+CMGS, PDU pošle onSmsPrompt()
+      smsState = SMS_WAIT_PROMPT;
+      if (!submitSmsHeader()) smsState = SMS_ERROR;
       break;
 
+    case SMS_SET_PDU_MODE:
     case SMS_WAIT_PROMPT:
-      // Čekáme na prompt '>' od modemu
-      if (waitForPrompt(SMS_PROMPT_TIMEOUT)) {
-        GSM_DBG("Prompt '>' přijat, posílám tělo zprávy");
-        responseBuf.clear();
-        stateTimestamp = millis();
-        smsState = SMS_SEND_BODY;
-      } else if (millis() - stateTimestamp >= SMS_PROMPT_TIMEOUT) {
-        GSM_DBG("❌ Timeout čekání na prompt '>'");
-        smsState = SMS_ERROR;
-      }
-      break;
-
     case SMS_SEND_BODY:
-      // Po krátké pauze po promptu posíláme text + CTRL+Z
-      if (millis() - stateTimestamp >= CMD_INTERVAL) {
-        SerialGSM.print(currentTask.message);
-        SerialGSM.write(26); // CTRL+Z
-        stateTimestamp = millis();
-        responseBuf.clear();
-        smsState = SMS_WAIT_OK;
-      }
-      break;
-
     case SMS_WAIT_OK:
-      // Čekáme, až modul potvrdí +CMGS: nebo vrátí ERROR
-      if (millis() - stateTimestamp >= SMS_TIMEOUT) {
-        GSM_DBG("❌ SMS odeslání timeout");
-        smsState = SMS_ERROR;
-      } else {
-        // Zkontrolujeme, zda responseBuf už obsahuje "+CMGS:" nebo "ERROR"
-        if (responseBuf.indexOf("+CMGS:") != -1) {
-          GSM_DBG("✅ SMS odeslána (detekováno +CMGS:)");
-          smsState = SMS_DONE;
-        } else if (responseBuf.indexOf("ERROR") != -1) {
-          GSM_DBG("❌ Modem vrátil ERROR při odesílání SMS");
-          smsState = SMS_ERROR;
-        }
-      }
+      // čekáme na callback z AT enginu (časové limity hlídá engine)
       break;
 
     case SMS_DONE:
-      // Úspěšné odeslání: vracíme se do IDLE
-      smsState = SMS_IDLE;
-      break;
-
     case SMS_ERROR:
-      // Chyba: prostě vrátíme do IDLE (můžeme sem přidat retry, logging apod.)
-      smsState = SMS_IDLE;
-      break;
+      break;   // vyřízeno výše
+  }
+
+  if (smsStatusDirty || smsState != prevState) {
+    publishSmsStatus();
+    smsStatusDirty = false;
   }
 }
 
 // ====== Blokující API ======
+// Jen pro testování: založí úlohu a pumpuje modem, dokud není vyřízená.
 bool modemSendSMS(const String& recipients, const String& message) {
-  flushSerialGSM();
+  uint32_t id = enqueueSms(recipients, message, SMS_SRC_LOCAL);
+  if (!id) return false;
 
-  // 1) Nastavíme textový mód
-  sendAndPrint("AT+CMGF=1");
-  // Počkáme na OK (timeout 1 s)
-  if (!waitForOkOrErrorOrCmgs(1000)) {
-    GSM_DBG("❌ Chyba: AT+CMGF odezva ERROR nebo timeout");
-    return false;
-  }
-
-  // 2) Pošleme hlavičku AT+CMGS
-  responseBuf.clear();
-  SerialGSM.print("AT+CMGS=\"");
-  SerialGSM.print(recipients);
-  SerialGSM.println("\"");
-
-  // 3) Čekáme na prompt '>'
-  if (!waitForPrompt(SMS_PROMPT_TIMEOUT)) {
-    GSM_DBG("❌ Chyba: Timeout čekání na prompt '>'");
-    return false;
-  }
-
-  // 4) Posíláme text a ukončíme CTRL+Z
-  SerialGSM.print(message);
-  SerialGSM.write(26); // CTRL+Z
-
-  // 5) Čekáme na +CMGS: nebo ERROR
-  if (!waitForOkOrErrorOrCmgs(SMS_TIMEOUT)) {
-    GSM_DBG("❌ Chyba: Modem vrátil ERROR nebo timeout při odeslání těla SMS");
-    return false;
+  SmsJobInfo info;
+  unsigned long t0 = millis();
+  while (smsJobGet(id, info) && info.state != SMS_JOB_SENT && info.state != SMS_JOB_FAILED &&
+         info.state != SMS_JOB_RETRYING &&
+         millis() - t0 < SMS_PROMPT_TIMEOUT + SMS_TIMEOUT + 1000) {
+    handleModemURC();
+    processSmsQueue();
+    yield();
   }
 
-  GSM_DBG("✅ modemSendSMS: SMS úspěšně odeslána");
-  return true;
+  bool ok = smsJobGet(id, info) && info.state == SMS_JOB_SENT;
+  if (ok) LOG_D("✅ modemSendSMS: SMS úspěšně odeslána");
+  return ok;
 }
 
-bool sendSmsNow(const String& number, const String& message) {
-  SmsTask task = { number, message };
-  if (!smsQueue.enqueue(task)) {
-    GSM_DBG("SMS fronta je plná, nelze odeslat zprávu");
+bool sendSmsNow(const String& number, const String& message, SmsSource src) {
+  if (enqueueSms(number, message, src) == 0) {
+    LOG_W("SMS fronta je plná, nelze odeslat zprávu");
     return false;
   } else {
-    GSM_DBG("SMS přidána do fronty k odeslání");
+    LOG_D("SMS přidána do fronty k odeslání");
     return true;
   }
 }
 
-// ====== Plánování SMS (pro případné rozšíření) ======
-bool modemScheduleSMS(const String& recipients, const String& message, const String& schedule) {
-  (void)schedule;
-  return enqueueSms(recipients, message);
+// ====== Plánování SMS ======
+// Prázdný schedule = hned do fronty, jinak přes plánovač (volat jen ze
+// síťové nebo MQTT úlohy, viz sms_scheduler.h).
+bool modemScheduleSMS(const String& recipients, const String& message, const String& schedule,
+                      SmsSource src) {
+  if (schedule.length() == 0) return enqueueSms(recipients, message, src) != 0;
+  StaticJsonDocument<64> nums;
+  nums.add(recipients);
+  return smsSchedulerAdd(nums.as<JsonArrayConst>(), message.c_str(),
+                         smsParseSendTime(schedule.c_str()), 0) != 0;
 }
 
 // ====== AT příkazy s očekávanou odpovědí ======
-bool sendAtCommand(const String& cmd, const String& expected, unsigned long timeout) {
-  flushSerialGSM();
-  SerialGSM.println(cmd);
-  unsigned long t0 = millis();
-  String resp;
-  while (millis() - t0 < timeout) {
-    if (SerialGSM.available()) {
-      resp += char(SerialGSM.read());
-      if (resp.indexOf(expected) != -1) return true;
-    }
-  }
-  return false;
+// Neblokující: příkaz se zařadí do AT enginu, výsledek jde do logu.
+// Řetězec `expected` musí mít statickou životnost (typicky literál).
+static void onAtCommandDone(const AtResult& res, void* ctx) {
+  LOG_D("AT → %s (%s)", res.status == AT_OK ? "OK" : "FAIL", (const char*)ctx);
+}
+
+bool sendAtCommand(const String& cmd, const char* expected, unsigned long timeout) {
+  AtCommand c;
+  if (cmd.length() >= sizeof(c.cmd)) return false;
+  memcpy(c.cmd, cmd.c_str(), cmd.length() + 1);
+  c.expect  = expected;
+  c.timeout = timeout;
+  c.onDone  = onAtCommandDone;
+  c.ctx     = (void*)expected;
+  return atSubmit(c);
 }
 
 // ====== Logování příchozího sériového provozu (debug) ======
@@ -639,23 +724,12 @@ void logModemData() {
   while (SerialGSM.available()) Serial.write(SerialGSM.read());
 }
 
-// Vrátí počet úloh ve frontě
+// Počet úloh ve frontě včetně právě odesílané
 size_t getSmsQueueSize() {
-  return smsQueue.size();
+  return smsJobActiveCount();
 }
 
-// Vrátí N-tou úlohu (0 = další ke zpracování)
-SmsTask getSmsQueueTask(size_t idx) {
-  SmsTask empty = { "", "" };
-  size_t sz = smsQueue.size();
-  if (idx >= sz) return empty;
-  // circular buffer: head + idx mod MAX_TASKS
-  size_t pos = (smsQueue.head + idx) % MAX_TASKS;
-  return smsQueue.buffer[pos];
+// Konzistentní snímek fronty – bezpečné volat z libovolné úlohy
+SmsStatusSnapshot getSmsStatus() {
+  return smsStatusSnap.read();
 }
-
-// Stav N-té úlohy (pro idx>0 vždy SMS_IDLE, první bere aktuální stav stroje)
-SmsState getSmsTaskState(size_t idx) {
-  if (idx == 0) return smsState;
-  return SMS_IDLE;
-}
\ No newline at end of file
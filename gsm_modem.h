@@ -13,7 +13,7 @@
 // ======= Stavový automat pro odesílání SMS =======
 enum SmsState {
   SMS_IDLE,
-  SMS_SET_TEXT_MODE,
+  SMS_SET_PDU_MODE,
   SMS_SEND_HEADER,
   SMS_WAIT_PROMPT,
   SMS_SEND_BODY,
@@ -22,44 +22,66 @@ enum SmsState {
   SMS_ERROR
 };
 
-// ====== Datové struktury fronty ======
-struct SmsTask {
-  String recipients;
-  String message;
+// ====== Fronta úloh (sms_queue.h) ======
+#include "sms_queue.h"
+#include "sms_history.h"     // LogQuery
+
+// Propustnost odesílání; dávka = SMS odeslané za sebou bez prázdné fronty
+struct SmsThroughput {
+  uint32_t sent       = 0;     // celkem od startu
+  uint32_t failed     = 0;     // definitivně (dead-letter)
+  uint32_t retried    = 0;     // přechodné chyby odložené k opakování
+  uint32_t segments   = 0;     // odeslané PDU segmenty (dělené SMS > 1 na zprávu)
+  uint32_t lastJobMs  = 0;     // trvání poslední SMS (dequeue → +CMGS)
+  uint32_t avgJobMs   = 0;     // klouzavý průměr (1/8)
+  uint32_t batchSent  = 0;     // aktuální / poslední dávka
+  uint32_t batchMs    = 0;
+  uint32_t perMinute  = 0;     // SMS/min v dávce
+};
+
+// Snímek stavového stroje publikovaný modemovou úlohou pro /api/sms-status
+// (jednotlivé úlohy viz smsJobList()/smsJobGet())
+struct SmsStatusSnapshot {
+  SmsState      state;         // stav aktuálně odesílané SMS
+  uint32_t      currentId;     // ID odesílané úlohy, 0 = žádná
+  SmsThroughput stats;
 };
 
 size_t getSmsQueueSize();
-SmsTask getSmsQueueTask(size_t idx);
-SmsState getSmsTaskState(size_t idx);
+SmsStatusSnapshot getSmsStatus();
 
 // ======= API pro práci s GSM modemem =======
 void modemInit();
 
 // Neblokující fronta + stavový stroj
-bool enqueueSms(const String& recipients, const String& message);
+// Vrací ID úlohy (0 = fronta nebo pool textů plný)
+uint32_t enqueueSms(const String& recipients, const String& message, SmsSource src = SMS_SRC_LOCAL);
 void processSmsQueue();
-void processSmsResponseLine(const String &line);
-void processCallerIDLine(const String &line);
 void handleModemURC();
+// Uspí volající úlohu do příchodu řádku/promptu z UART, nejvýš maxMs
+void modemWaitRx(uint32_t maxMs);
 
-// Blokující jednorázové API (pro testování)
+// Blokující jednorázové API (pro testování, jen z modemové úlohy)
 bool modemSendSMS(const String& recipients, const String& message);
-bool sendSmsNow(const String& number, const String& message);
+bool sendSmsNow(const String& number, const String& message, SmsSource src = SMS_SRC_HTTP);
 
-// Vytiskne základní nastavení modemu na Serial
+// Vytiskne základní nastavení modemu na Serial (asynchronně přes AT engine)
 void printModemSettings();
 
-// AT příkaz s očekávanou odpovědí (pro debug, pokročilé použití)
-bool sendAtCommand(const String& cmd, const String& expected, unsigned long timeout = 1000);
+// AT příkaz s očekávanou odpovědí – jen zařadí do AT enginu (neblokuje)
+bool sendAtCommand(const String& cmd, const char* expected = "OK", unsigned long timeout = 1000);
+
+// Plánování SMS: schedule = sendTime (viz smsParseSendTime), "" = hned
+bool modemScheduleSMS(const String& recipients, const String& message, const String& schedule,
+                      SmsSource src = SMS_SRC_LOCAL);
 
-// Plánování SMS (možnost rozšíření do budoucna)
-bool modemScheduleSMS(const String& recipients, const String& message, const String& schedule);
+// Znovu pošle AT+CTZU/CTZR/CLIP dle settings (bezpečné volat z jiné úlohy)
+void modemRequestReconfigure();
 
 // Výpis všech dat ze sériové linky (pro debug)
 void logModemData();
 
-// ======= Správa volání, CLIP logování, RING nastavení =======
-void logCallToFile(const String& caller);
+// ======= RING nastavení (log volání viz call_log.h) =======
 void loadRingSetting();
 void saveRingSetting(uint8_t val);
 uint8_t getRingSetting();
@@ -80,5 +102,22 @@ void setSmsHistoryMaxCount(uint16_t v);
 void loadSmsHistoryMaxCount();
 
 // ======= **Nové deklarace pro stav modemu** =======
+// Snímek telemetrie obnovovaný na pozadí (settings.modemPollInterval).
+// Časové značky jsou millis() posledního úspěšného dotazu, 0 = zatím nikdy.
+struct ModemStatus {
+  uint8_t       signal          = 99;    // CSQ 0–31, 99 = neznámé
+  char          operatorName[24] = "--";
+  uint8_t       regStatus       = 0;     // CREG <stat>: 1 domácí síť, 5 roaming
+  bool          attached        = false; // CGATT
+  unsigned long signalAt   = 0;
+  unsigned long operatorAt = 0;
+  unsigned long regAt      = 0;
+  unsigned long attachAt   = 0;
+};
+
+void modemStatusLoop();                  // volat v modemové úloze, zakládá dotazy
+ModemStatus getModemStatus();            // konzistentní kopie (z libovolné úlohy)
+
+// Poslední známé hodnoty ze snímku (bez komunikace s modemem)
 uint8_t readSignalQuality();
 String readOperatorName();
@@ -0,0 +1,191 @@
+// http_auth.cpp – hash hesla admina a tabulka session tokenů
+#include "http_auth.h"
+#include <LittleFS.h>
+#include <esp_system.h>
+#include <mbedtls/md.h>
+
+#define LOG_TAG "AUTH"
+#include "log.h"
+
+#define SALT_LEN  16
+#define HASH_LEN  32
+
+struct HttpSession {
+  char     token[HTTP_SESSION_TOKEN_LEN + 1];
+  uint32_t lastUse;
+  bool     used;
+};
+
+static HttpSession sessions[HTTP_SESSION_MAX];
+static uint8_t  passSalt[SALT_LEN];
+static uint8_t  passHash[HASH_LEN];
+static uint32_t failUntil = 0;     // do kdy se přihlášení odmítá
+static uint8_t  failCount = 0;
+
+// Porovnání bez předčasného ukončení (čas nezávisí na shodě)
+static bool sameBytes(const void* a, const void* b, size_t n) {
+  const uint8_t* x = (const uint8_t*)a;
+  const uint8_t* y = (const uint8_t*)b;
+  uint8_t diff = 0;
+  for (size_t i = 0; i < n; i++) diff |= x[i] ^ y[i];
+  return diff == 0;
+}
+
+static void toHex(const uint8_t* in, size_t n, char* out) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  for (size_t i = 0; i < n; i++) {
+    out[2 * i]     = HEX_DIGITS[in[i] >> 4];
+    out[2 * i + 1] = HEX_DIGITS[in[i] & 0x0F];
+  }
+  out[2 * n] = '\0';
+}
+
+static bool fromHex(const char* in, uint8_t* out, size_t n) {
+  for (size_t i = 0; i < 2 * n; i++) {
+    char c = in[i];
+    int v = (c >= '0' && c <= '9') ? c - '0'
+          : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+    if (v < 0) return false;
+    out[i / 2] = (i & 1) ? (out[i / 2] | v) : (v << 4);
+  }
+  return true;
+}
+
+// HMAC-SHA256(sůl, heslo), pak HTTP_AUTH_ROUNDS× HMAC(sůl, předchozí)
+static void hashPassword(const uint8_t* salt, const char* pass, uint8_t* out) {
+  const mbedtls_md_info_t* md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  uint8_t tmp[HASH_LEN];
+  mbedtls_md_hmac(md, salt, SALT_LEN, (const uint8_t*)pass, strlen(pass), out);
+  for (int i = 1; i < HTTP_AUTH_ROUNDS; i++) {
+    mbedtls_md_hmac(md, salt, SALT_LEN, out, HASH_LEN, tmp);
+    memcpy(out, tmp, HASH_LEN);
+  }
+}
+
+static void setPassword(const char* pass) {
+  esp_fill_random(passSalt, SALT_LEN);
+  hashPassword(passSalt, pass, passHash);
+}
+
+static bool savePassword() {
+  char line[2 * SALT_LEN + 1 + 2 * HASH_LEN + 1];
+  toHex(passSalt, SALT_LEN, line);
+  line[2 * SALT_LEN] = ':';
+  toHex(passHash, HASH_LEN, line + 2 * SALT_LEN + 1);
+  File f = LittleFS.open(HTTP_AUTH_PASS_PATH, "w");
+  if (!f) return false;
+  bool ok = f.print(line) == strlen(line);
+  f.close();
+  return ok;
+}
+
+static bool loadPassword() {
+  File f = LittleFS.open(HTTP_AUTH_PASS_PATH, "r");
+  if (!f) return false;
+  char line[2 * SALT_LEN + 1 + 2 * HASH_LEN + 1];
+  size_t n = f.readBytes(line, sizeof(line) - 1);
+  f.close();
+  line[n] = '\0';
+  return n >= sizeof(line) - 1 && line[2 * SALT_LEN] == ':' &&
+         fromHex(line, passSalt, SALT_LEN) &&
+         fromHex(line + 2 * SALT_LEN + 1, passHash, HASH_LEN);
+}
+
+void httpAuthBegin() {
+  memset(sessions, 0, sizeof(sessions));
+  if (LittleFS.exists(HTTP_AUTH_PASS_PATH) && loadPassword()) return;
+
+  String legacy = "admin";
+  if (LittleFS.exists(HTTP_AUTH_LEGACY_PATH)) {
+    File f = LittleFS.open(HTTP_AUTH_LEGACY_PATH, "r");
+    legacy = f.readStringUntil('\n');
+    f.close();
+    legacy.trim();
+    if (legacy.length() == 0) legacy = "admin";
+  }
+  setPassword(legacy.c_str());
+  // výchozí "admin" se neukládá, převedené heslo ano (a čistý text zmizí)
+  if (LittleFS.exists(HTTP_AUTH_LEGACY_PATH) && savePassword()) {
+    LittleFS.remove(HTTP_AUTH_LEGACY_PATH);
+    LOG_I("Heslo admina převedeno na hash");
+  }
+}
+
+// ====== Session ======
+// Token z "Authorization: Bearer <t>" nebo z cookie "sid=<t>"; jiná
+// délka než HTTP_SESSION_TOKEN_LEN znamená rovnou neplatný token
+static const char* requestToken(const HttpRequest& r) {
+  if (!strncmp(r.authorization, "Bearer ", 7)) {
+    const char* t = r.authorization + 7;
+    return strlen(t) == HTTP_SESSION_TOKEN_LEN ? t : nullptr;
+  }
+  for (const char* c = r.cookie; *c; ) {
+    while (*c == ' ' || *c == ';') c++;
+    const char* end = strchr(c, ';');
+    size_t len = end ? (size_t)(end - c) : strlen(c);
+    if (len == 4 + HTTP_SESSION_TOKEN_LEN && !strncmp(c, "sid=", 4)) return c + 4;
+    c += len;
+  }
+  return nullptr;
+}
+
+// Projde všechny sloty (i po nalezení), ať doba nenapoví, který sedí
+static HttpSession* findSession(const HttpRequest& r) {
+  const char* token = requestToken(r);
+  if (!token) return nullptr;
+  uint32_t now = millis();
+  HttpSession* found = nullptr;
+  for (HttpSession& s : sessions) {
+    if (s.used && now - s.lastUse > HTTP_SESSION_IDLE_MS) s.used = false;
+    if (sameBytes(s.token, token, HTTP_SESSION_TOKEN_LEN) && s.used) found = &s;
+  }
+  return found;
+}
+
+bool httpAuthCheck(const HttpRequest& r) {
+  HttpSession* s = findSession(r);
+  if (!s) return false;
+  s->lastUse = millis();
+  return true;
+}
+
+HttpLoginResult httpAuthLogin(const char* user, const char* pass, char* token) {
+  uint32_t now = millis();
+  if (failCount && (int32_t)(failUntil - now) > 0) return HTTP_LOGIN_LOCKED;
+
+  uint8_t hash[HASH_LEN];
+  hashPassword(passSalt, pass, hash);
+  bool userOk = strcmp(user, HTTP_AUTH_USER) == 0;
+  if (!(sameBytes(hash, passHash, HASH_LEN) & userOk)) {
+    // 1 s, 2 s, 4 s … až HTTP_AUTH_FAIL_MAX_MS
+    if (failCount < 15) failCount++;
+    failUntil = millis() + min<uint32_t>(1000UL << (failCount - 1), HTTP_AUTH_FAIL_MAX_MS);
+    return HTTP_LOGIN_DENIED;
+  }
+  failCount = 0;
+
+  // volný nebo nejdéle nepoužitý slot
+  HttpSession* slot = &sessions[0];
+  for (HttpSession& s : sessions) {
+    if (!s.used) { slot = &s; break; }
+    if (now - s.lastUse > now - slot->lastUse) slot = &s;
+  }
+  uint8_t raw[HTTP_SESSION_TOKEN_LEN / 2];
+  esp_fill_random(raw, sizeof(raw));
+  toHex(raw, sizeof(raw), slot->token);
+  slot->lastUse = now;
+  slot->used    = true;
+  memcpy(token, slot->token, HTTP_SESSION_TOKEN_LEN + 1);
+  return HTTP_LOGIN_OK;
+}
+
+void httpAuthLogout(const HttpRequest& r) {
+  HttpSession* s = findSession(r);
+  if (s) memset(s, 0, sizeof(*s));
+}
+
+bool httpAuthSetPassword(const char* pass) {
+  setPassword(pass);
+  memset(sessions, 0, sizeof(sessions));
+  return savePassword();
+}
@@ -0,0 +1,49 @@
+// http_auth.h – přihlášení do webového rozhraní přes session tokeny
+//
+// POST /api/login ověří heslo (solený, iterovaný HMAC-SHA256 uložený
+// v /admin_pass.hash) a vydá náhodný token: prohlížeči v cookie
+// "sid" (posílá ji i EventSource), skriptům v těle odpovědi pro
+// hlavičku "Authorization: Bearer <token>". Každý další požadavek jen
+// porovná token s malou pevnou tabulkou session – bez Base64 a bez
+// práce s heslem. Heslo se hashuje jen při přihlášení a změně.
+
+#pragma once
+#include <Arduino.h>
+#include "http_request.h"
+
+#ifndef HTTP_SESSION_MAX
+  #define HTTP_SESSION_MAX      4                   // souběžně přihlášení klienti
+#endif
+#ifndef HTTP_SESSION_IDLE_MS
+  #define HTTP_SESSION_IDLE_MS  (30UL * 60 * 1000)  // expirace od posledního požadavku
+#endif
+#ifndef HTTP_AUTH_ROUNDS
+  #define HTTP_AUTH_ROUNDS      2000                // iterace HMAC při hashování hesla
+#endif
+#define HTTP_AUTH_PASS_PATH     "/admin_pass.hash"  // "<sůl hex>:<hash hex>"
+#define HTTP_AUTH_LEGACY_PATH   "/admin_pass.txt"   // původní heslo v čistém textu
+#define HTTP_AUTH_USER          "admin"
+#define HTTP_AUTH_FAIL_MAX_MS   30000               // strop prodlevy po chybných pokusech
+#define HTTP_SESSION_TOKEN_LEN  32                  // hex znaků (128 bitů)
+
+enum HttpLoginResult : uint8_t {
+  HTTP_LOGIN_OK,
+  HTTP_LOGIN_DENIED,     // špatné jméno / heslo
+  HTTP_LOGIN_LOCKED      // příliš mnoho pokusů, zkusit později
+};
+
+// Načte hash hesla; starý /admin_pass.txt převede a smaže
+void httpAuthBegin();
+
+// Platný token v Authorization: Bearer nebo cookie sid; posune expiraci
+bool httpAuthCheck(const HttpRequest& r);
+
+// Ověří jméno a heslo a založí session (nejstarší případně vytlačí);
+// token se zapíše do token[HTTP_SESSION_TOKEN_LEN + 1]
+HttpLoginResult httpAuthLogin(const char* user, const char* pass, char* token);
+
+// Zruší session požadavku (odhlášení)
+void httpAuthLogout(const HttpRequest& r);
+
+// Uloží nové heslo a zruší všechny session; volající se přihlásí znovu
+bool httpAuthSetPassword(const char* pass);
@@ -0,0 +1,145 @@
+// http_events.cpp – fronta událostí modem → síť a jejich rozesílání přes SSE
+#include "http_events.h"
+#include "http_server.h"
+#include "gsm_modem.h"
+#include "mqtt_module.h"
+#include "json_writer.h"
+#include "rt_queue.h"
+#include <atomic>
+
+enum HttpEventType : uint8_t {
+  HTTP_EVENT_SMS,
+  HTTP_EVENT_CALL
+};
+
+struct HttpEvent {
+  HttpEventType type;
+  uint8_t       state;
+  uint8_t       attempts;
+  int16_t       error;
+  uint32_t      id;
+  char          number[24];
+};
+
+static SpscRing<HttpEvent, HTTP_EVENT_QUEUE> events;
+// Telemetrie se neřadí do fronty: stačí příznak, poslední stav je ve snímku
+static std::atomic<bool> modemDirty{false};
+static std::atomic<bool> overflow{false};
+
+static bool     resync      = false;   // jen síťová úloha
+static bool     lastMqtt    = false;
+static uint32_t lastPing    = 0;
+
+// Print do pevného bufferu (data jedné SSE události)
+class EventPrint : public Print {
+public:
+  EventPrint(char* buf, size_t cap) : buf_(buf), cap_(cap) { buf_[0] = '\0'; }
+  size_t write(uint8_t b) override {
+    if (len_ + 1 >= cap_) { full_ = true; return 0; }
+    buf_[len_++] = b;
+    buf_[len_]   = '\0';
+    return 1;
+  }
+  bool full() const { return full_; }
+private:
+  char*  buf_;
+  size_t cap_;
+  size_t len_  = 0;
+  bool   full_ = false;
+};
+
+// ====== Producent (modemová úloha) ======
+static void push(const HttpEvent& ev) {
+  if (!events.push(ev)) overflow.store(true, std::memory_order_relaxed);
+}
+
+void httpEventSmsJob(uint32_t id, SmsJobState state, uint8_t attempts, int error) {
+  HttpEvent ev = {};
+  ev.type     = HTTP_EVENT_SMS;
+  ev.id       = id;
+  ev.state    = state;
+  ev.attempts = attempts;
+  ev.error    = error;
+  push(ev);
+}
+
+void httpEventCall(const char* number) {
+  HttpEvent ev = {};
+  ev.type = HTTP_EVENT_CALL;
+  // jen znaky telefonního čísla – data jdou do JSON bez escapování
+  size_t n = 0;
+  for (const char* p = number; *p && n < sizeof(ev.number) - 1; ++p) {
+    if (isdigit((unsigned char)*p) || *p == '+' || *p == '*' || *p == '#') ev.number[n++] = *p;
+  }
+  push(ev);
+}
+
+void httpEventModemStatus() {
+  modemDirty.store(true, std::memory_order_release);
+}
+
+// ====== Síťová úloha ======
+void httpEventsSubscribe(HttpRequest& req) {
+  if (!httpBeginEventStream(req)) return;
+  // nový odběratel dostane aktuální stav hned
+  resync = true;
+  modemDirty.store(true, std::memory_order_relaxed);
+}
+
+static void sendModemStatus() {
+  ModemStatus ms = getModemStatus();
+  // název operátora je text z +COPS – escapuje JsonWriter
+  char data[256];
+  EventPrint out(data, sizeof(data));
+  JsonWriter j(out);
+  j.beginObject()
+   .field("signal", ms.signal)
+   .field("operator", (const char*)ms.operatorName)
+   .field("registration", ms.regStatus)
+   .field("attached", ms.attached)
+   .field("mqttConnected", lastMqtt)
+   .endObject();
+  if (!out.full()) httpBroadcastEvent("modem", data);
+}
+
+void httpEventsLoop() {
+  bool listening = httpEventStreams() > 0;
+  char data[96];
+
+  HttpEvent ev;
+  while (events.pop(ev)) {
+    if (!listening) continue;
+    if (ev.type == HTTP_EVENT_SMS) {
+      snprintf(data, sizeof(data), "{\"id\":%lu,\"state\":\"%s\",\"attempts\":%u,\"error\":%d}",
+               (unsigned long)ev.id, smsJobStateToString((SmsJobState)ev.state),
+               (unsigned)ev.attempts, (int)ev.error);
+      httpBroadcastEvent("sms", data);
+    } else {
+      snprintf(data, sizeof(data), "{\"number\":\"%s\"}", ev.number);
+      httpBroadcastEvent("call", data);
+    }
+  }
+
+  // mqttClient patří pod ethLock, který síťová úloha drží
+  bool mqtt = mqttClient.connected();
+  if (mqtt != lastMqtt) {
+    lastMqtt = mqtt;
+    modemDirty.store(true, std::memory_order_relaxed);
+  }
+
+  if (overflow.exchange(false, std::memory_order_relaxed)) resync = true;
+  bool modem = modemDirty.exchange(false, std::memory_order_acquire);
+  if (!listening) {
+    resync = false;
+    return;
+  }
+  if (modem) sendModemStatus();
+  if (resync) {
+    httpBroadcastEvent("resync", "{}");
+    resync = false;
+  }
+  if (millis() - lastPing > HTTP_EVENT_PING_MS) {
+    httpBroadcastEvent(nullptr, "ping");
+    lastPing = millis();
+  }
+}
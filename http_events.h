@@ -0,0 +1,31 @@
+// http_events.h – push kanál /api/events (Server-Sent Events)
+//
+// Modemová úloha hlásí změny (přechody stavu SMS úloh, příchozí volání,
+// změnu telemetrie) do SPSC fronty; síťová úloha je v httpEventsLoop()
+// rozešle všem otevřeným EventSource spojením. Dashboard tak nemusí
+// pollovat /api/sms-status a /api/modem-status a změna je vidět hned.
+//
+// Události (data = JSON na jednom řádku):
+//   sms     {"id","state","attempts","error"}
+//   call    {"number"}                 "" = hovor ukončen
+//   modem   stejný objekt jako /api/modem-status
+//   resync  {}                         fronta přetekla / nový odběratel
+
+#pragma once
+#include <Arduino.h>
+#include "sms_queue.h"
+#include "http_request.h"
+
+#ifndef HTTP_EVENT_QUEUE
+  #define HTTP_EVENT_QUEUE      32       // mocnina 2
+#endif
+#define HTTP_EVENT_PING_MS      15000    // komentář proti proxy / NAT timeoutu
+
+// ======= Producent: jen modemová úloha =======
+void httpEventSmsJob(uint32_t id, SmsJobState state, uint8_t attempts, int error);
+void httpEventCall(const char* number);
+void httpEventModemStatus();   // telemetrie se změnila; obsah se čte ze snímku
+
+// ======= Síťová úloha =======
+void httpEventsSubscribe(HttpRequest& req);   // handler GET /api/events
+void httpEventsLoop();
@@ -0,0 +1,198 @@
+// http_request.cpp – parser HTTP/1.1 (request line, hlavičky, tělo, chunked)
+#include "http_request.h"
+
+static bool nameIs(const char* name, size_t n, const char* expect) {
+  return strlen(expect) == n && strncasecmp(name, expect, n) == 0;
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// ====== Hlavičky ======
+void HttpParser::reset(char* head, size_t headCap) {
+  *this = HttpParser();
+  head_    = head;
+  headCap_ = headCap;
+}
+
+char* HttpParser::headSpace(size_t& room) {
+  room = headCap_ - 1 - headLen_;
+  return head_ + headLen_;
+}
+
+const char* HttpParser::excess(size_t& n) const {
+  n = bodyStart_ ? headLen_ - bodyStart_ : 0;
+  return head_ + bodyStart_;
+}
+
+HttpParseResult HttpParser::parseLine(char* line, char* end, HttpRequest& r) {
+  if (end > line && end[-1] == '\r') --end;
+  *end = '\0';
+
+  if (firstLine_) {
+    firstLine_ = false;
+    char* sp1 = (char*)memchr(line, ' ', end - line);
+    char* sp2 = sp1 ? (char*)memchr(sp1 + 1, ' ', end - sp1 - 1) : nullptr;
+    if (!sp1 || !sp2 || strncmp(sp2 + 1, "HTTP/1.", 7) != 0) return HTTP_PARSE_BAD;
+    r.keepAlive = sp2[8] == '1';
+    *sp1 = *sp2 = '\0';
+    r.method = !strcmp(line, "GET")  ? HTTP_METHOD_GET
+             : !strcmp(line, "POST") ? HTTP_METHOD_POST : HTTP_METHOD_OTHER;
+    char* q = strchr(sp1 + 1, '?');
+    if (q) { *q = '\0'; r.query = q + 1; }
+    r.path = sp1 + 1;
+    return HTTP_PARSE_MORE;
+  }
+
+  char* colon = (char*)memchr(line, ':', end - line);
+  if (!colon) return HTTP_PARSE_BAD;
+  char* v = colon + 1;
+  while (*v == ' ' || *v == '\t') v++;
+  for (char* e = end; e > v && (e[-1] == ' ' || e[-1] == '\t'); ) *--e = '\0';
+  size_t n = colon - line;
+
+  if (nameIs(line, n, "Content-Length")) {
+    char* stop;
+    unsigned long len = strtoul(v, &stop, 10);
+    if (stop == v || *stop || len > 0x7FFFFFFF) return HTTP_PARSE_BAD;
+    if (!r.chunked) r.contentLength = len;
+  } else if (nameIs(line, n, "Transfer-Encoding")) {
+    if (strstr(v, "chunked")) { r.chunked = true; r.contentLength = -1; }
+  } else if (nameIs(line, n, "Connection")) {
+    if      (!strcasecmp(v, "close"))      r.keepAlive = false;
+    else if (!strcasecmp(v, "keep-alive")) r.keepAlive = true;
+  } else if (nameIs(line, n, "Authorization")) {
+    r.authorization = v;
+  } else if (nameIs(line, n, "Cookie")) {
+    r.cookie = v;
+  } else if (nameIs(line, n, "Content-Type")) {
+    r.contentType = v;
+  } else if (nameIs(line, n, "If-None-Match")) {
+    r.ifNoneMatch = v;
+  } else if (nameIs(line, n, "Accept-Encoding")) {
+    r.acceptGzip = strstr(v, "gzip") != nullptr;
+  }
+  return HTTP_PARSE_MORE;
+}
+
+HttpParseResult HttpParser::headReceived(size_t n, HttpRequest& r) {
+  headLen_ += n;
+  head_[headLen_] = '\0';
+  while (scan_ < headLen_) {
+    char* eol = (char*)memchr(head_ + scan_, '\n', headLen_ - scan_);
+    if (!eol) { scan_ = headLen_; break; }
+    char* line = head_ + lineStart_;
+    size_t next = eol - head_ + 1;
+    bool empty = eol == line || (eol == line + 1 && *line == '\r');
+    if (empty && !firstLine_) {
+      *line = '\0';
+      bodyStart_ = next;
+      return HTTP_PARSE_DONE;
+    }
+    if (!empty && parseLine(line, eol, r) == HTTP_PARSE_BAD) return HTTP_PARSE_BAD;
+    lineStart_ = scan_ = next;
+  }
+  return headLen_ + 1 >= headCap_ ? HTTP_PARSE_TOO_LARGE : HTTP_PARSE_MORE;
+}
+
+// ====== Tělo ======
+void HttpParser::beginBody(char* buf, size_t cap, const HttpRequest& r) {
+  body_    = buf;
+  bodyCap_ = cap;
+  bodyLen_ = 0;
+  leftPos_ = leftLen_ = 0;
+  lineHasData_ = false;
+  if (r.chunked) {
+    bstate_ = CHUNK_SIZE;
+    remain_ = 0;
+  } else {
+    bstate_ = BODY_LENGTH;
+    remain_ = r.contentLength > 0 ? r.contentLength : 0;
+  }
+}
+
+char* HttpParser::bodySpace(size_t& room) {
+  room = bodyCap_ - 1 - bodyLen_;
+  if (bstate_ == BODY_LENGTH && room > remain_) room = remain_;
+  return body_ + bodyLen_;
+}
+
+HttpParseResult HttpParser::finishBody(HttpRequest& r) {
+  body_[bodyLen_] = '\0';
+  r.body    = body_;
+  r.bodyLen = bodyLen_;
+  return HTTP_PARSE_DONE;
+}
+
+// Dekódování na místě: čtecí pozice p je vždy >= zápisové out, takže
+// data chunků stačí posunout (memmove) za už dekódovanou část.
+HttpParseResult HttpParser::bodyReceived(size_t n, HttpRequest& r) {
+  if (bstate_ == BODY_LENGTH) {
+    bodyLen_ += n;
+    remain_  -= n;
+    return remain_ ? HTTP_PARSE_MORE : finishBody(r);
+  }
+
+  size_t p = bodyLen_, out = bodyLen_, end = bodyLen_ + n;
+  while (p < end) {
+    char c = body_[p];
+    switch (bstate_) {
+      case CHUNK_SIZE:
+      case CHUNK_EXT:
+        p++;
+        if (c == '\n') {
+          if (!lineHasData_) return HTTP_PARSE_BAD;
+          lineHasData_ = false;
+          bstate_ = remain_ ? CHUNK_DATA : CHUNK_TRAILER;
+        } else if (c == '\r') {
+        } else if (bstate_ == CHUNK_EXT || c == ';' || c == ' ' || c == '\t') {
+          bstate_ = CHUNK_EXT;
+        } else {
+          int v = hexValue(c);
+          if (v < 0) return HTTP_PARSE_BAD;
+          if (remain_ > 0x0FFFFFFF) return HTTP_PARSE_TOO_LARGE;
+          remain_ = remain_ * 16 + v;
+          lineHasData_ = true;
+        }
+        break;
+
+      case CHUNK_DATA: {
+        size_t k = min((size_t)remain_, end - p);
+        memmove(body_ + out, body_ + p, k);
+        out += k; p += k; remain_ -= k;
+        if (!remain_) bstate_ = CHUNK_DATA_END;
+        break;
+      }
+
+      case CHUNK_DATA_END:
+        p++;
+        if (c == '\n')      bstate_ = CHUNK_SIZE;
+        else if (c != '\r') return HTTP_PARSE_BAD;
+        break;
+
+      case CHUNK_TRAILER:
+        p++;
+        if (c == '\n') {
+          if (!lineHasData_) {
+            bodyLen_ = out;
+            leftPos_ = p;
+            leftLen_ = end - p;
+            return finishBody(r);
+          }
+          lineHasData_ = false;
+        } else if (c != '\r') {
+          lineHasData_ = true;
+        }
+        break;
+
+      default:
+        return HTTP_PARSE_BAD;
+    }
+  }
+  bodyLen_ = out;
+  return bodyLen_ + 1 >= bodyCap_ ? HTTP_PARSE_TOO_LARGE : HTTP_PARSE_MORE;
+}
@@ -0,0 +1,90 @@
+// http_request.h – inkrementální parser HTTP/1.1 požadavku nad pevným bufferem
+//
+// Hlavičky se parsují po řádcích hned, jak dorazí, přímo v bufferu
+// spojení: oddělovače se přepíšou na '\0' a HttpRequest drží jen
+// ukazatele do bufferu. Tělo (Content-Length i chunked) se dekóduje na
+// místě v přiděleném bufferu těla – data chunků se jen posunou na konec
+// už dekódovaných. Na heapu se nic nealokuje.
+
+#pragma once
+#include <Arduino.h>
+#include <Ethernet.h>
+
+enum HttpMethod : uint8_t {
+  HTTP_METHOD_OTHER,
+  HTTP_METHOD_GET,
+  HTTP_METHOD_POST
+};
+
+struct HttpRequest {
+  EthernetClient client;
+  HttpMethod  method        = HTTP_METHOD_OTHER;
+  // pohledy do bufferu spojení (platné do konce obsluhy), vždy s '\0'
+  const char* path          = "";   // bez query stringu
+  const char* query         = "";
+  const char* authorization = "";   // hodnota hlavičky Authorization
+  const char* cookie        = "";   // hodnota hlavičky Cookie
+  const char* contentType   = "";
+  const char* ifNoneMatch   = "";   // ETagy z cache prohlížeče
+  bool        acceptGzip    = false;
+  int32_t     contentLength = -1;   // -1 = hlavička chybí
+  bool        chunked       = false;
+  bool        keepAlive     = false;  // HTTP/1.1 bez "Connection: close"
+  const char* body          = "";   // dekódované tělo s '\0'
+  size_t      bodyLen       = 0;
+  uint8_t     conn          = 0;    // index spojení (http_server)
+};
+
+enum HttpParseResult : uint8_t {
+  HTTP_PARSE_MORE,          // potřeba další data
+  HTTP_PARSE_DONE,          // hlavičky / tělo kompletní
+  HTTP_PARSE_BAD,           // 400
+  HTTP_PARSE_TOO_LARGE      // 431 (hlavičky) / 413 (tělo)
+};
+
+class HttpParser {
+public:
+  // Obsah bufferu se nemaže: u keep-alive tam server předem přesune
+  // bajty dalšího požadavku (pipelining) a předá je headReceived()
+  void reset(char* head, size_t headCap);
+
+  // ---- Hlavičky: data se zapisují do headSpace(), pak headReceived(n)
+  char*           headSpace(size_t& room);
+  HttpParseResult headReceived(size_t n, HttpRequest& r);
+  // Bajty přečtené za koncem hlaviček (začátek těla)
+  const char*     excess(size_t& n) const;
+  // Zatím nepřišel žádný bajt (spojení čeká na další požadavek)
+  bool            idle() const { return headLen_ == 0; }
+
+  bool            hasBody(const HttpRequest& r) const { return r.chunked || r.contentLength > 0; }
+
+  // ---- Tělo: surová data se zapisují do bodySpace(), pak bodyReceived(n)
+  void            beginBody(char* buf, size_t cap, const HttpRequest& r);
+  char*           bodySpace(size_t& room);
+  HttpParseResult bodyReceived(size_t n, HttpRequest& r);
+  // Bajty přečtené za koncem chunked těla (další požadavek v pořadí)
+  const char*     leftover(size_t& n) const { n = leftLen_; return body_ + leftPos_; }
+
+private:
+  enum BodyState : uint8_t { BODY_LENGTH, CHUNK_SIZE, CHUNK_EXT, CHUNK_DATA, CHUNK_DATA_END, CHUNK_TRAILER };
+
+  HttpParseResult parseLine(char* line, char* end, HttpRequest& r);
+  HttpParseResult finishBody(HttpRequest& r);
+
+  char*     head_     = nullptr;
+  size_t    headCap_  = 0;
+  size_t    headLen_  = 0;
+  size_t    lineStart_ = 0;    // začátek ještě nezpracovaného řádku
+  size_t    scan_      = 0;    // kam až se hledal konec řádku
+  size_t    bodyStart_ = 0;    // 0 = hlavičky ještě nejsou celé
+  bool      firstLine_ = true;
+
+  char*     body_     = nullptr;
+  size_t    bodyCap_  = 0;
+  size_t    bodyLen_  = 0;     // dekódované bajty
+  uint32_t  remain_   = 0;     // zbývá v Content-Length / aktuálním chunku
+  BodyState bstate_   = BODY_LENGTH;
+  bool      lineHasData_ = false;  // řádek velikosti má číslice / trailer není prázdný
+  size_t    leftPos_  = 0;
+  size_t    leftLen_  = 0;
+};
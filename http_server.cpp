@@ -0,0 +1,647 @@
+// http_server.cpp – stavové automaty HTTP spojení
+#include "http_server.h"
+#include <stdarg.h>
+
+#define LOG_TAG "HTTP"
+#include "log.h"
+
+enum HttpConnState : uint8_t {
+  HTTP_FREE,
+  HTTP_READ_HEAD,
+  HTTP_WAIT_BODY,                      // čeká na volný buffer těla
+  HTTP_READ_BODY,
+  HTTP_RECV_FILE,                      // tělo do souboru (HTTP_ROUTE_UPLOAD)
+  HTTP_WRITE_FILE,
+  HTTP_SSE                             // otevřený text/event-stream
+};
+
+struct HttpConn {
+  HttpConnState    state = HTTP_FREE;
+  int8_t           bodySlot = -1;      // index do bodyBuf[]
+  bool             framed = false;     // odpověď má délku (httpBeginResponse)
+  uint8_t          served = 0;         // požadavků na tomto spojení
+  uint16_t         excessUsed = 0;     // bajty za hlavičkami spotřebované tělem
+  uint16_t         pending = 0;        // pipelinované bajty na začátku head[]
+  uint32_t         lastIo = 0;         // millis() posledního posunu
+  uint32_t         remaining = 0;      // HTTP_RECV_FILE: bajty těla do konce
+  const HttpRoute* route = nullptr;    // nullptr = fallback
+  HttpParser       parser;
+  char             head[HTTP_HEAD_MAX + 1];
+  HttpRequest      req;
+  File             file;               // HTTP_WRITE_FILE / HTTP_RECV_FILE
+};
+
+static EthernetServer*   srv        = nullptr;
+static const HttpRoute*  routes     = nullptr;
+static size_t            routeCount = 0;
+static HttpHandler       onFallback = nullptr;
+static HttpAuthCheck     onAuth     = nullptr;
+static HttpConn          conns[HTTP_MAX_CONN];
+static HttpConn*         active     = nullptr;   // právě obsluhované spojení
+// Doba obsluhy po routách (index v tabulce); poslední = fallback
+// a routy za HTTP_ROUTE_METRICS
+static MetricHistogram   routeTime[HTTP_ROUTE_METRICS + 1];
+// Těla se načítají do sdílených statických bufferů – jen pár spojení
+// posílá tělo současně a HTTP_MAX_CONN × HTTP_BODY_MAX by zabralo RAM
+static char              bodyBuf[HTTP_BODY_SLOTS][HTTP_BODY_MAX + 1];
+static bool              bodyBusy[HTTP_BODY_SLOTS];
+static uint8_t           fileBuf[HTTP_FILE_CHUNK];    // sdílený, jen síťová úloha
+
+// Předkomprimované soubory (tools/build_assets.py)
+struct HttpAsset {
+  char     path[40];
+  char     etag[24];      // včetně uvozovek
+  uint32_t gzSize;        // neshoda = soubor změněn bez nového indexu
+};
+static HttpAsset         assets[HTTP_ASSET_MAX];
+static size_t            assetCount = 0;
+
+// ====== Pomocné ======
+static void releaseBody(HttpConn& c) {
+  if (c.bodySlot >= 0) bodyBusy[c.bodySlot] = false;
+  c.bodySlot = -1;
+}
+
+static void closeConn(HttpConn& c) {
+  if (c.file) c.file.close();
+  if (c.state == HTTP_RECV_FILE) LittleFS.remove(c.route->upload);   // nedokončený upload
+  releaseBody(c);
+  c.req.client.stop();
+  c.req     = HttpRequest();
+  c.route   = nullptr;
+  c.pending = 0;
+  c.state   = HTTP_FREE;
+}
+
+static void sendStatus(EthernetClient& client, int status) {
+  client.printf("HTTP/1.1 %d %s\r\nConnection: close\r\nContent-Length: 0\r\n\r\n",
+                status, httpStatusText(status));
+}
+
+static void fail(HttpConn& c, int status) {
+  sendStatus(c.req.client, status);
+  closeConn(c);
+}
+
+// snprintf za konec řetězce v buf; vrací novou délku, nejvýš cap - 1
+// (přetečení výstup zkrátí, další volání už nic nepřipíšou)
+static size_t appendf(char* buf, size_t cap, size_t n, const char* fmt, ...) {
+  if (n >= cap - 1) return cap - 1;
+  va_list ap;
+  va_start(ap, fmt);
+  int w = vsnprintf(buf + n, cap - n, fmt, ap);
+  va_end(ap);
+  if (w < 0) return n;
+  return min(n + (size_t)w, cap - 1);
+}
+
+// Nepřečtené bajty za koncem požadavku: zbytek za chunked tělem (v bufferu
+// těla) a část přečtená s hlavičkami, kterou tělo nespotřebovalo
+static size_t carryLength(const HttpConn& c) {
+  size_t left, pre;
+  c.parser.leftover(left);
+  c.parser.excess(pre);
+  return left + pre - c.excessUsed;
+}
+
+// Přesune pipelinované bajty na začátek head[] pro další požadavek
+static void stashCarry(HttpConn& c) {
+  size_t left, pre;
+  const char* lp = c.parser.leftover(left);
+  const char* ep = c.parser.excess(pre) + c.excessUsed;
+  pre -= c.excessUsed;
+  memmove(c.head + left, ep, pre);
+  if (left) memcpy(c.head, lp, left);
+  c.pending = left + pre;
+}
+
+// Odpověď je celá: spojení buď čeká na další požadavek, nebo se zavře
+static void finishResponse(HttpConn& c) {
+  if (c.file) c.file.close();
+  if (!c.req.keepAlive || !c.framed) { closeConn(c); return; }
+  EthernetClient client = c.req.client;
+  uint8_t        idx    = c.req.conn;
+  c.req        = HttpRequest();
+  c.req.client = client;
+  c.req.conn   = idx;
+  c.route      = nullptr;
+  c.framed     = false;
+  c.excessUsed = 0;
+  c.state      = HTTP_READ_HEAD;
+  c.lastIo     = millis();
+  c.parser.reset(c.head, sizeof(c.head));
+}
+
+static int routeCmp(const HttpRoute& a, const char* path, HttpMethod method) {
+  int d = strcmp(a.path, path);
+  return d ? d : (int)a.method - (int)method;
+}
+
+// Půlení intervalu v seřazené tabulce; `pathKnown` = path existuje
+// s jinou metodou (→ 405)
+static const HttpRoute* findRoute(const HttpRequest& r, bool& pathKnown) {
+  size_t lo = 0, hi = routeCount;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (routeCmp(routes[mid], r.path, r.method) < 0) lo = mid + 1;
+    else                                             hi = mid;
+  }
+  if (lo < routeCount && routeCmp(routes[lo], r.path, r.method) == 0) return &routes[lo];
+  pathKnown = (lo < routeCount && !strcmp(routes[lo].path, r.path)) ||
+              (lo > 0 && !strcmp(routes[lo - 1].path, r.path));
+  return nullptr;
+}
+
+static MetricHistogram& routeMetric(const HttpRoute* route) {
+  size_t i = route ? (size_t)(route - routes) : HTTP_ROUTE_METRICS;
+  return routeTime[i < HTTP_ROUTE_METRICS ? i : HTTP_ROUTE_METRICS];
+}
+
+static void dispatch(HttpConn& c) {
+  HttpRequest& r = c.req;
+  // o keep-alive se rozhodne před odpovědí (hlavička Connection)
+  if (c.served + 1 >= HTTP_KEEPALIVE_MAX || carryLength(c) > HTTP_HEAD_MAX) r.keepAlive = false;
+  HttpHandler h = c.route ? c.route->handler : onFallback;
+  c.framed = false;
+  active   = &c;
+  if (h) {
+    MetricScope m(routeMetric(c.route));
+    h(r);
+  }
+  active   = nullptr;
+  c.served++;
+  if (r.keepAlive && c.framed) stashCarry(c);
+  releaseBody(c);
+  if (c.state != HTTP_WRITE_FILE && c.state != HTTP_SSE) finishResponse(c);
+}
+
+static void bodyResult(HttpConn& c, HttpParseResult res) {
+  switch (res) {
+    case HTTP_PARSE_DONE:      dispatch(c); break;
+    case HTTP_PARSE_BAD:       fail(c, 400); break;
+    case HTTP_PARSE_TOO_LARGE: fail(c, 413); break;
+    default:                   c.state = HTTP_READ_BODY; break;
+  }
+}
+
+// Předá parseru bajty těla, které už leží jinde (přečtené s hlavičkami);
+// spotřebované bajty se připočtou do c.excessUsed
+static HttpParseResult feedBody(HttpConn& c, const char* p, size_t n) {
+  HttpParseResult res = HTTP_PARSE_MORE;
+  while (n > 0 && res == HTTP_PARSE_MORE) {
+    size_t room;
+    char* dst = c.parser.bodySpace(room);
+    if (!room) return HTTP_PARSE_TOO_LARGE;
+    size_t k = min(n, room);
+    memcpy(dst, p, k);
+    p += k; n -= k;
+    c.excessUsed += k;
+    res = c.parser.bodyReceived(k, c.req);
+  }
+  return res;
+}
+
+// ====== Stavy ======
+static void startBody(HttpConn& c) {
+  int slot = -1;
+  for (int i = 0; i < HTTP_BODY_SLOTS; ++i) {
+    if (!bodyBusy[i]) { slot = i; break; }
+  }
+  if (slot < 0) return;                // zkusí se v dalším průchodu
+  bodyBusy[slot] = true;
+  c.bodySlot = slot;
+  c.lastIo   = millis();
+  c.parser.beginBody(bodyBuf[slot], sizeof(bodyBuf[slot]), c.req);
+
+  size_t pre;
+  const char* p = c.parser.excess(pre);
+  bodyResult(c, feedBody(c, p, pre));
+}
+
+// Soubor je celý: dál jako požadavek s načteným tělem (mimo
+// HTTP_RECV_FILE, jinak by ho closeConn() smazal)
+static void uploadDone(HttpConn& c) {
+  c.file.close();
+  c.state = HTTP_READ_BODY;
+  dispatch(c);
+}
+
+static void startUpload(HttpConn& c) {
+  HttpRequest& r = c.req;
+  if (r.chunked || r.contentLength <= 0) { fail(c, 411); return; }
+  if ((uint32_t)r.contentLength > c.route->uploadMax) { fail(c, 413); return; }
+  for (const auto& o : conns) {         // jeden dočasný soubor na routu
+    if (o.state == HTTP_RECV_FILE && o.route == c.route) { fail(c, 409); return; }
+  }
+  c.file = LittleFS.open(c.route->upload, "w");
+  if (!c.file) { fail(c, 500); return; }
+  c.state     = HTTP_RECV_FILE;
+  c.remaining = r.contentLength;
+  c.lastIo    = millis();
+
+  size_t pre;
+  const char* p = c.parser.excess(pre);
+  size_t k = min(pre, (size_t)c.remaining);
+  if (k && c.file.write((const uint8_t*)p, k) != k) { fail(c, 500); return; }
+  c.excessUsed = k;
+  c.remaining -= k;
+  if (!c.remaining) uploadDone(c);
+}
+
+static void headDone(HttpConn& c) {
+  HttpRequest& r = c.req;
+  bool pathKnown = false;
+  c.route = findRoute(r, pathKnown);
+  if (!c.route && pathKnown) { fail(c, 405); return; }
+  if (c.route && (c.route->flags & HTTP_ROUTE_AUTH) && onAuth && !onAuth(r)) {
+    closeConn(c);
+    return;
+  }
+
+  if (c.route && (c.route->flags & HTTP_ROUTE_UPLOAD)) {
+    startUpload(c);
+    return;
+  }
+  if (c.route && (c.route->flags & HTTP_ROUTE_STREAM)) {
+    size_t pre;
+    const char* p = c.parser.excess(pre);
+    HttpBodyStream body(r.client, (const uint8_t*)p, pre);
+    {
+      MetricScope m(routeMetric(c.route));
+      c.route->stream(r, body);
+    }
+    closeConn(c);
+    return;
+  }
+
+  if (!c.parser.hasBody(r)) { dispatch(c); return; }
+  if (r.contentLength > HTTP_BODY_MAX) { fail(c, 413); return; }
+  c.state = HTTP_WAIT_BODY;
+  startBody(c);
+}
+
+static void readHead(HttpConn& c) {
+  int n;
+  if (c.pending) {
+    // pipelinovaný požadavek, už leží na začátku head[]
+    n = c.pending;
+    c.pending = 0;
+  } else {
+    EthernetClient& cl = c.req.client;
+    int avail = cl.available();
+    if (avail <= 0) return;
+    size_t room;
+    char* dst = c.parser.headSpace(room);
+    n = cl.read((uint8_t*)dst, min((size_t)avail, room));
+    if (n <= 0) return;
+  }
+  c.lastIo = millis();
+
+  switch (c.parser.headReceived(n, c.req)) {
+    case HTTP_PARSE_MORE:      return;
+    case HTTP_PARSE_BAD:       fail(c, 400); return;
+    case HTTP_PARSE_TOO_LARGE: fail(c, 431); return;
+    case HTTP_PARSE_DONE:      headDone(c); return;
+  }
+}
+
+// Čte přímo do bufferu těla, chunked se dekóduje na místě
+static void readBody(HttpConn& c) {
+  EthernetClient& cl = c.req.client;
+  int avail;
+  while ((avail = cl.available()) > 0) {
+    size_t room;
+    char* dst = c.parser.bodySpace(room);
+    if (!room) { fail(c, 413); return; }
+    int n = cl.read((uint8_t*)dst, min((size_t)avail, room));
+    if (n <= 0) return;
+    c.lastIo = millis();
+    HttpParseResult res = c.parser.bodyReceived(n, c.req);
+    if (res != HTTP_PARSE_MORE) { bodyResult(c, res); return; }
+  }
+}
+
+// Po blocích z TCP do souboru, jen co socket právě má
+static void recvFile(HttpConn& c) {
+  EthernetClient& cl = c.req.client;
+  int avail;
+  while (c.remaining && (avail = cl.available()) > 0) {
+    size_t k = min(min((size_t)avail, sizeof(fileBuf)), (size_t)c.remaining);
+    int n = cl.read(fileBuf, k);
+    if (n <= 0) return;
+    c.lastIo = millis();
+    if (c.file.write(fileBuf, n) != (size_t)n) { fail(c, 500); return; }
+    c.remaining -= n;
+  }
+  if (!c.remaining) uploadDone(c);
+}
+
+static void writeFile(HttpConn& c) {
+  EthernetClient& cl = c.req.client;
+  int room;
+  while ((room = cl.availableForWrite()) > 0) {
+    size_t n = c.file.read(fileBuf, min((size_t)room, sizeof(fileBuf)));
+    if (n == 0) { finishResponse(c); return; }
+    cl.write(fileBuf, n);
+    c.lastIo = millis();
+  }
+}
+
+// Od klienta se na SSE spojení nic nečeká; co pošle, se zahodí
+static void drainSse(HttpConn& c) {
+  EthernetClient& cl = c.req.client;
+  while (cl.available() > 0) {
+    if (cl.read(fileBuf, sizeof(fileBuf)) <= 0) break;
+  }
+}
+
+static const HttpAsset* findAsset(const char* path) {
+  for (size_t i = 0; i < assetCount; ++i) {
+    if (!strcmp(assets[i].path, path)) return &assets[i];
+  }
+  return nullptr;
+}
+
+static uint32_t stateTimeout(const HttpConn& c) {
+  switch (c.state) {
+    case HTTP_READ_HEAD:  return c.served && c.parser.idle() ? HTTP_KEEPALIVE_MS : HTTP_HEAD_TIMEOUT_MS;
+    case HTTP_WAIT_BODY:
+    case HTTP_READ_BODY:
+    case HTTP_RECV_FILE:  return HTTP_BODY_TIMEOUT_MS;
+    case HTTP_WRITE_FILE: return HTTP_WRITE_TIMEOUT_MS;
+    default:              return 0;   // HTTP_SSE: drží ho ping z http_events
+  }
+}
+
+// ====== Veřejné API ======
+void httpServerBegin(EthernetServer& server, const HttpRoute* table, size_t count,
+                     HttpHandler fallback, HttpAuthCheck auth) {
+  srv        = &server;
+  routes     = table;
+  routeCount = count;
+  onFallback = fallback;
+  onAuth     = auth;
+  httpLoadAssetIndex();
+  for (size_t i = 1; i < count; ++i) {
+    if (routeCmp(table[i - 1], table[i].path, table[i].method) >= 0) {
+      LOG_E("tabulka rout není seřazená u %s", table[i].path);
+    }
+  }
+  srv->begin();
+}
+
+void httpServerPrintMetrics(Print& out) {
+  out.print("# HELP smsgw_http_request_seconds Time spent in the route handler\n"
+            "# TYPE smsgw_http_request_seconds histogram\n");
+  char labels[80];
+  for (size_t i = 0; i < routeCount && i < HTTP_ROUTE_METRICS; ++i) {
+    if (!routeTime[i].count()) continue;       // nepoužité routy výstup nenafukují
+    snprintf(labels, sizeof(labels), "path=\"%s\",method=\"%s\"", routes[i].path,
+             routes[i].method == HTTP_METHOD_POST ? "POST" : "GET");
+    routeTime[i].print(out, "smsgw_http_request_seconds", labels);
+  }
+  if (routeTime[HTTP_ROUTE_METRICS].count()) {
+    routeTime[HTTP_ROUTE_METRICS].print(out, "smsgw_http_request_seconds", "path=\"*\",method=\"*\"");
+  }
+}
+
+void httpServerLoop() {
+  if (!srv) return;
+
+  // nová spojení (accept() vrací každé jen jednou)
+  for (EthernetClient cl = srv->accept(); cl; cl = srv->accept()) {
+    HttpConn* slot = nullptr;
+    for (auto& c : conns) {
+      if (c.state == HTTP_FREE) { slot = &c; break; }
+    }
+    cl.setConnectionTimeout(HTTP_CLOSE_WAIT_MS);
+    if (!slot) {
+      sendStatus(cl, 503);
+      cl.stop();
+      continue;
+    }
+    slot->req.client = cl;
+    slot->req.conn   = slot - conns;
+    slot->state      = HTTP_READ_HEAD;
+    slot->lastIo     = millis();
+    slot->served     = 0;
+    slot->framed     = false;
+    slot->excessUsed = 0;
+    slot->parser.reset(slot->head, sizeof(slot->head));
+  }
+
+  for (auto& c : conns) {
+    if (c.state == HTTP_FREE) continue;
+    if (!c.pending && !c.req.client.connected() && c.req.client.available() <= 0) {
+      closeConn(c);
+      continue;
+    }
+    switch (c.state) {
+      case HTTP_READ_HEAD:  readHead(c);  break;
+      case HTTP_WAIT_BODY:  startBody(c); break;
+      case HTTP_READ_BODY:  readBody(c);  break;
+      case HTTP_RECV_FILE:  recvFile(c);  break;
+      case HTTP_WRITE_FILE: writeFile(c); break;
+      case HTTP_SSE:        drainSse(c);  break;
+      default: break;
+    }
+    uint32_t timeout = stateTimeout(c);
+    if (c.state != HTTP_FREE && timeout && millis() - c.lastIo > timeout) {
+      // nečinné keep-alive spojení se zavře bez odpovědi
+      bool idle = c.state == HTTP_READ_HEAD && c.served && c.parser.idle();
+      if (c.state != HTTP_WRITE_FILE && !idle) sendStatus(c.req.client, 408);
+      closeConn(c);
+    }
+  }
+}
+
+size_t httpActiveConnections() {
+  size_t n = 0;
+  for (auto& c : conns) n += c.state != HTTP_FREE;
+  return n;
+}
+
+const char* httpStatusText(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 202: return "Accepted";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 409: return "Conflict";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 411: return "Length Required";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default:  return "Bad Request";
+  }
+}
+
+void httpBeginResponse(EthernetClient& client, int status, const char* contentType,
+                       int32_t contentLength, const char* extraHeaders) {
+  HttpConn* c = active && &active->req.client == &client ? active : nullptr;
+  bool keep = c && c->req.keepAlive;
+  if (c) c->framed = true;
+
+  // celá hlavička jedním zápisem (jedna SPI transakce do W5500)
+  char hdr[384];
+  size_t n = appendf(hdr, sizeof(hdr), 0, "HTTP/1.1 %d %s\r\n", status, httpStatusText(status));
+  if (contentType)        n = appendf(hdr, sizeof(hdr), n, "Content-Type: %s\r\n", contentType);
+  if (status != 304) {     // 304 je bez těla i bez délky
+    if (contentLength >= 0) n = appendf(hdr, sizeof(hdr), n, "Content-Length: %ld\r\n", (long)contentLength);
+    else                    n = appendf(hdr, sizeof(hdr), n, "Transfer-Encoding: chunked\r\n");
+  }
+  if (extraHeaders)       n = appendf(hdr, sizeof(hdr), n, "%s", extraHeaders);
+  if (keep) n = appendf(hdr, sizeof(hdr), n, "Connection: keep-alive\r\nKeep-Alive: timeout=%u, max=%u\r\n\r\n",
+                        (unsigned)(HTTP_KEEPALIVE_MS / 1000), (unsigned)(HTTP_KEEPALIVE_MAX - c->served - 1));
+  else      n = appendf(hdr, sizeof(hdr), n, "Connection: close\r\n\r\n");
+  // zkrácená hlavička by neměla konec – místo ní 500 a zavřít spojení
+  if (n >= sizeof(hdr) - 1) {
+    LOG_E("hlavička odpovědi %d přesahuje %u B", status, (unsigned)sizeof(hdr));
+    if (c) c->framed = false;
+    sendStatus(client, 500);
+    return;
+  }
+  client.write((const uint8_t*)hdr, n);
+}
+
+// ====== ChunkedPrint / HttpJsonResponse ======
+size_t ChunkedPrint::write(uint8_t b) {
+  if (len_ == CAP) flush();
+  buf_[HDR + len_++] = b;
+  return 1;
+}
+
+size_t ChunkedPrint::write(const uint8_t* p, size_t n) {
+  for (size_t left = n; left; ) {
+    if (len_ == CAP) flush();
+    size_t k = min(left, CAP - len_);
+    memcpy(buf_ + HDR + len_, p, k);
+    len_ += k; p += k; left -= k;
+  }
+  return n;
+}
+
+// velikost chunku před data, CRLF za ně – celý chunk jedním zápisem
+void ChunkedPrint::flush() {
+  if (!len_) return;
+  char hex[HDR + 1];
+  int h = snprintf(hex, sizeof(hex), "%X\r\n", (unsigned)len_);
+  memcpy(buf_ + HDR - h, hex, h);
+  buf_[HDR + len_]     = '\r';
+  buf_[HDR + len_ + 1] = '\n';
+  client_.write(buf_ + HDR - h, h + len_ + 2);
+  len_ = 0;
+}
+
+void ChunkedPrint::end() {
+  if (done_) return;
+  flush();
+  client_.write((const uint8_t*)"0\r\n\r\n", 5);
+  done_ = true;
+}
+
+HttpJsonResponse::HttpJsonResponse(EthernetClient& client, int status, const char* extraHeaders)
+    : ChunkedPrint(client), JsonWriter(static_cast<Print&>(*this)) {
+  httpBeginResponse(client, status, "application/json", -1, extraHeaders);
+}
+
+void httpLoadAssetIndex() {
+  assetCount = 0;
+  File f = LittleFS.open(HTTP_ASSET_INDEX, "r");
+  if (!f) return;
+  char line[96];
+  while (assetCount < HTTP_ASSET_MAX && f.available()) {
+    size_t n = f.readBytesUntil('\n', line, sizeof(line) - 1);
+    line[n] = '\0';
+    HttpAsset& a = assets[assetCount];
+    unsigned long size;
+    if (sscanf(line, "%39s %23s %lu", a.path, a.etag, &size) == 3) {
+      a.gzSize = size;
+      assetCount++;
+    }
+  }
+  f.close();
+}
+
+bool httpSendFile(HttpRequest& req, const char* path, const char* contentType) {
+  HttpConn& c = conns[req.conn];
+  const HttpAsset* a = findAsset(path);
+  const char* etag = nullptr;
+  File f;
+  if (a && req.acceptGzip) {
+    char gzPath[sizeof(a->path) + 3];
+    snprintf(gzPath, sizeof(gzPath), "%s.gz", path);
+    f = LittleFS.open(gzPath, "r");
+    if (f && f.size() == a->gzSize) etag = a->etag;
+  }
+  bool gzip = (bool)f;
+  if (!f) f = LittleFS.open(path, "r");
+  if (!f || f.isDirectory()) {
+    httpBeginResponse(req.client, 404, nullptr, 0);
+    return false;
+  }
+
+  // "?v=<hash>" doplňuje build_assets.py do index.html.gz – obsah
+  // takové URL se nemění, ostatní se vždy revalidují (ETag → 304)
+  bool versioned = !strncmp(req.query, "v=", 2) || strstr(req.query, "&v=");
+  char extra[160];
+  size_t n = appendf(extra, sizeof(extra), 0, "Cache-Control: %s\r\n",
+                     versioned ? "public, max-age=31536000, immutable" : "no-cache");
+  if (a)    n = appendf(extra, sizeof(extra), n, "Vary: Accept-Encoding\r\n");
+  if (gzip) n = appendf(extra, sizeof(extra), n, "Content-Encoding: gzip\r\n");
+  if (etag) n = appendf(extra, sizeof(extra), n, "ETag: %s\r\n", etag);
+
+  if (etag && strstr(req.ifNoneMatch, etag)) {
+    f.close();
+    httpBeginResponse(req.client, 304, nullptr, 0, extra);
+    return true;
+  }
+  httpBeginResponse(req.client, 200, contentType, f.size(), extra);
+  c.file   = f;
+  c.state  = HTTP_WRITE_FILE;
+  c.lastIo = millis();
+  return true;
+}
+
+bool httpBeginEventStream(HttpRequest& req) {
+  HttpConn& c = conns[req.conn];
+  if (httpEventStreams() >= HTTP_SSE_MAX) {
+    httpBeginResponse(req.client, 503, nullptr, 0);
+    return false;
+  }
+  static const char hdr[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n\r\n"
+    "retry: 3000\n\n";
+  req.client.write((const uint8_t*)hdr, sizeof(hdr) - 1);
+  c.state  = HTTP_SSE;
+  c.lastIo = millis();
+  return true;
+}
+
+void httpBroadcastEvent(const char* event, const char* data) {
+  char msg[320];
+  int n = event ? snprintf(msg, sizeof(msg), "event: %s\ndata: %s\n\n", event, data)
+                : snprintf(msg, sizeof(msg), ": %s\n\n", data);
+  if (n <= 0 || n >= (int)sizeof(msg)) return;
+  for (auto& c : conns) {
+    if (c.state != HTTP_SSE) continue;
+    if (c.req.client.availableForWrite() < n) { closeConn(c); continue; }
+    c.req.client.write((const uint8_t*)msg, n);
+    c.lastIo = millis();
+  }
+}
+
+size_t httpEventStreams() {
+  size_t n = 0;
+  for (auto& c : conns) n += c.state == HTTP_SSE;
+  return n;
+}
@@ -0,0 +1,184 @@
+// http_server.h – neblokující HTTP server nad sockety W5500
+//
+// Každé přijaté spojení má vlastní stavový automat (čtení hlaviček →
+// čtení těla → obsluha → odesílání souboru), takže pomalý klient
+// neblokuje ostatní a několik otevřených záložek se obsluhuje souběžně.
+// Po orámované odpovědi spojení zůstává otevřené (keep-alive) pro další,
+// i pipelinované požadavky – polling dashboardu neplatí TCP handshake.
+// Data se čtou po blocích, nikdy se nečeká na další bajty (ani u těla,
+// které routa s HTTP_ROUTE_UPLOAD ukládá do souboru); stav, který
+// se nehýbe déle než timeout, se ukončí (408 / zavření).
+// Požadavek rozebírá HttpParser (http_request.h) přímo v bufferu
+// spojení a routa se hledá v seřazené statické tabulce.
+//
+// Jen ze síťové úlohy (drží ethLock).
+
+#pragma once
+#include <Arduino.h>
+#include <Ethernet.h>
+#include <LittleFS.h>
+#include "http_request.h"
+#include "json_writer.h"
+#include "metrics.h"
+
+// ======= Limity (lze přepsat přes -D) =======
+#ifndef HTTP_MAX_CONN
+  #define HTTP_MAX_CONN          MAX_SOCK_NUM   // W5500 má 8 socketů (i pro MQTT/NTP)
+#endif
+#ifndef HTTP_HEAD_MAX
+  #define HTTP_HEAD_MAX          1536    // request line + hlavičky
+#endif
+#ifndef HTTP_BODY_MAX
+  #define HTTP_BODY_MAX          8192    // větší tělo → 413 (mimo streamované routy)
+#endif
+#ifndef HTTP_BODY_SLOTS
+  #define HTTP_BODY_SLOTS        2       // souběžně načítaná těla (statické buffery)
+#endif
+#ifndef HTTP_KEEPALIVE_MS
+  #define HTTP_KEEPALIVE_MS      8000    // nečinné spojení mezi požadavky
+#endif
+#ifndef HTTP_KEEPALIVE_MAX
+  #define HTTP_KEEPALIVE_MAX     100     // požadavků na jedno spojení
+#endif
+#ifndef HTTP_FILE_CHUNK
+  #define HTTP_FILE_CHUNK        2048    // blok souboru na jeden zápis do socketu
+#endif
+#ifndef HTTP_ASSET_MAX
+  #define HTTP_ASSET_MAX         16      // položek v HTTP_ASSET_INDEX
+#endif
+#ifndef HTTP_ROUTE_METRICS
+  #define HTTP_ROUTE_METRICS     48      // rout s vlastním histogramem času obsluhy
+#endif
+#ifndef HTTP_SSE_MAX
+  #define HTTP_SSE_MAX           2       // souběžných /api/events (drží socket)
+#endif
+#define HTTP_ASSET_INDEX         "/assets.etag"   // tools/build_assets.py
+#define HTTP_HEAD_TIMEOUT_MS     5000
+#define HTTP_BODY_TIMEOUT_MS     10000
+#define HTTP_WRITE_TIMEOUT_MS    10000
+#define HTTP_CLOSE_WAIT_MS       50      // EthernetClient::stop() čeká na FIN
+
+// Tělo požadavku jako Stream: nejdřív bajty přečtené spolu s hlavičkami,
+// pak přímo ze socketu. Pro routy, které tělo nenačítají do paměti (OTA).
+class HttpBodyStream : public Stream {
+public:
+  HttpBodyStream(EthernetClient& c, const uint8_t* pre, size_t preLen)
+    : client_(c), pre_(pre), preLen_(preLen) {}
+  int    available() override { return (int)(preLen_ - prePos_) + client_.available(); }
+  int    read() override      { return prePos_ < preLen_ ? pre_[prePos_++] : client_.read(); }
+  int    peek() override      { return prePos_ < preLen_ ? pre_[prePos_] : client_.peek(); }
+  size_t write(uint8_t b) override { return client_.write(b); }
+  using Print::write;
+  int read(uint8_t* buf, size_t n) {
+    if (prePos_ < preLen_) {
+      size_t k = min(n, preLen_ - prePos_);
+      memcpy(buf, pre_ + prePos_, k);
+      prePos_ += k;
+      return (int)k;
+    }
+    return client_.read(buf, n);
+  }
+  bool connected() { return prePos_ < preLen_ || client_.connected(); }
+
+private:
+  EthernetClient& client_;
+  const uint8_t*  pre_;
+  size_t          preLen_;
+  size_t          prePos_ = 0;
+};
+
+// Obsluha požadavku s načteným tělem. Odpověď zapisuje do req.client;
+// spojení po návratu zavře server (nebo pokračuje httpSendFile()).
+typedef void (*HttpHandler)(HttpRequest& req);
+// Routa, která si tělo čte sama (po hlavičkách, bez bufferu těla)
+typedef void (*HttpStreamHandler)(HttpRequest& req, HttpBodyStream& body);
+// Kontrola přístupu pro routy s HTTP_ROUTE_AUTH; false = odpověď už odeslána
+typedef bool (*HttpAuthCheck)(HttpRequest& req);
+
+enum : uint8_t {
+  HTTP_ROUTE_AUTH   = 0x01,
+  HTTP_ROUTE_STREAM = 0x02,   // volá se `stream` místo `handler`
+  // Tělo (Content-Length, max. `uploadMax`) server po blocích zapíše do
+  // souboru `upload` a `handler` zavolá až s celým souborem. Chybějící
+  // délka → 411, větší → 413; nedokončený soubor se smaže.
+  HTTP_ROUTE_UPLOAD = 0x04
+};
+
+// Položka tabulky rout. Tabulka musí být seřazená podle path (strcmp)
+// a pak podle method – hledá se půlením intervalu, takže další endpoint
+// cestu dispatch neprodlužuje. Neseřazenou tabulku ohlásí httpServerBegin().
+struct HttpRoute {
+  const char*       path;
+  HttpMethod        method;
+  uint8_t           flags;
+  HttpHandler       handler;
+  HttpStreamHandler stream;
+  const char*       upload;      // HTTP_ROUTE_UPLOAD
+  uint32_t          uploadMax;
+};
+
+// `fallback` dostane požadavky, pro které v tabulce není path
+// (statické soubory, 404); path s jinou metodou dostane 405.
+void   httpServerBegin(EthernetServer& server, const HttpRoute* routes, size_t count,
+                       HttpHandler fallback, HttpAuthCheck auth);
+void   httpServerLoop();
+size_t httpActiveConnections();
+// Histogram doby obsluhy každé použité routy (a fallbacku) pro /api/metrics
+void   httpServerPrintMetrics(Print& out);
+
+// Stavový řádek a hlavičky odpovědi v jednom zápisu: Content-Length,
+// nebo pro contentLength < 0 Transfer-Encoding: chunked. Jen takto
+// orámovaná odpověď nechá spojení otevřené (keep-alive); po odpovědi
+// zapsané jinak server spojení zavře. `extraHeaders` = celé řádky s CRLF.
+void        httpBeginResponse(EthernetClient& client, int status, const char* contentType,
+                              int32_t contentLength, const char* extraHeaders = nullptr);
+const char* httpStatusText(int status);
+
+// Výstup do klienta po větších blocích: každý client.write() je
+// samostatná SPI transakce do W5500, po bajtech je to řádově pomalejší.
+// Blok odchází jako jeden HTTP chunk (Transfer-Encoding: chunked), takže
+// odpověď neznámé délky nemusí kvůli ukončení zavírat spojení.
+class ChunkedPrint : public Print {
+public:
+  explicit ChunkedPrint(EthernetClient& c) : client_(c) {}
+  ~ChunkedPrint() { end(); }
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* p, size_t n) override;
+  void   flush() override;
+  void   end();           // zbytek dat a ukončovací chunk
+private:
+  static const size_t HDR = 6;       // "400\r\n"
+  static const size_t CAP = 1024;
+  EthernetClient& client_;
+  uint8_t         buf_[HDR + CAP + 2];
+  size_t          len_  = 0;
+  bool            done_ = false;
+};
+
+// JSON odpověď bez dokumentu a Stringu: hlavička (chunked) hned, tělo
+// přes JsonWriter rovnou do ChunkedPrint; ukončí ji end() nebo destruktor.
+//   HttpJsonResponse res(req.client, 200);
+//   res.beginObject().field("success", true).endObject();
+class HttpJsonResponse : private ChunkedPrint, public JsonWriter {
+public:
+  HttpJsonResponse(EthernetClient& client, int status, const char* extraHeaders = nullptr);
+  using ChunkedPrint::end;
+};
+
+// Pošle hlavičku a soubor odešle po blocích z httpServerLoop() podle
+// volného místa v TX bufferu socketu. false = soubor neexistuje (404 odeslána).
+// Soubory z HTTP_ASSET_INDEX jdou jako <path>.gz s ETagem (shoda
+// If-None-Match → 304); s "?v=" v URL s dlouhou platností v cache.
+bool   httpSendFile(HttpRequest& req, const char* path, const char* contentType);
+// Znovu načte HTTP_ASSET_INDEX (po nahrání souborů na FS)
+void   httpLoadAssetIndex();
+
+// ======= Server-Sent Events =======
+// Přepne spojení na text/event-stream; zůstává otevřené, dokud ho klient
+// nezavře. false = plno (HTTP_SSE_MAX), 503 odeslána.
+bool   httpBeginEventStream(HttpRequest& req);
+// Pošle událost všem SSE spojením (data = jeden řádek, typicky JSON);
+// event == nullptr → jen komentář (keep-alive). Spojení, kterému se
+// zpráva nevejde do TX bufferu, se zavře – EventSource se znovu připojí.
+void   httpBroadcastEvent(const char* event, const char* data);
+size_t httpEventStreams();
@@ -0,0 +1,125 @@
+// json_writer.cpp – proudový zápis JSON (escapování, čísla, oddělovače)
+#include "json_writer.h"
+
+void JsonWriter::separator() {
+  if (afterKey_) { afterKey_ = false; return; }
+  uint32_t bit = 1UL << depth_;
+  if (depth_ && (nonEmpty_ & bit)) out_.write((uint8_t)',');
+  nonEmpty_ |= bit;
+}
+
+JsonWriter& JsonWriter::beginObject() {
+  separator();
+  out_.write((uint8_t)'{');
+  if (depth_ + 1 < JSON_WRITER_DEPTH) depth_++;
+  nonEmpty_ &= ~(1UL << depth_);
+  return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+  if (depth_) depth_--;
+  out_.write((uint8_t)'}');
+  return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+  separator();
+  out_.write((uint8_t)'[');
+  if (depth_ + 1 < JSON_WRITER_DEPTH) depth_++;
+  nonEmpty_ &= ~(1UL << depth_);
+  return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+  if (depth_) depth_--;
+  out_.write((uint8_t)']');
+  return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* k) {
+  separator();
+  writeString(k);
+  out_.write((uint8_t)':');
+  afterKey_ = true;
+  return *this;
+}
+
+// Úseky bez escapování jdou jedním write(); UTF-8 projde beze změny
+void JsonWriter::writeString(const char* s) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  out_.write((uint8_t)'"');
+  const char* run = s;
+  for (; *s; ++s) {
+    uint8_t c = (uint8_t)*s;
+    if (c >= 0x20 && c != '"' && c != '\\') continue;
+    if (s > run) out_.write((const uint8_t*)run, s - run);
+    char esc[6] = { '\\', 0 };
+    size_t n = 2;
+    switch (c) {
+      case '"':  esc[1] = '"';  break;
+      case '\\': esc[1] = '\\'; break;
+      case '\n': esc[1] = 'n';  break;
+      case '\r': esc[1] = 'r';  break;
+      case '\t': esc[1] = 't';  break;
+      default:
+        esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+        esc[4] = HEX_DIGITS[c >> 4]; esc[5] = HEX_DIGITS[c & 0x0F];
+        n = 6;
+    }
+    out_.write((const uint8_t*)esc, n);
+    run = s + 1;
+  }
+  if (s > run) out_.write((const uint8_t*)run, s - run);
+  out_.write((uint8_t)'"');
+}
+
+JsonWriter& JsonWriter::value(const char* s) {
+  if (!s) return nullValue();
+  separator();
+  writeString(s);
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+  separator();
+  if (b) out_.write((const uint8_t*)"true", 4);
+  else   out_.write((const uint8_t*)"false", 5);
+  return *this;
+}
+
+JsonWriter& JsonWriter::value(double v) {
+  if (isnan(v) || isinf(v)) return nullValue();
+  separator();
+  char buf[24];
+  int n = snprintf(buf, sizeof(buf), "%.6g", v);
+  out_.write((const uint8_t*)buf, n);
+  return *this;
+}
+
+JsonWriter& JsonWriter::nullValue() {
+  separator();
+  out_.write((const uint8_t*)"null", 4);
+  return *this;
+}
+
+JsonWriter& JsonWriter::unumber(uint64_t v) {
+  separator();
+  char buf[20];
+  size_t n = sizeof(buf);
+  do { buf[--n] = '0' + v % 10; v /= 10; } while (v);
+  out_.write((const uint8_t*)buf + n, sizeof(buf) - n);
+  return *this;
+}
+
+JsonWriter& JsonWriter::number(int64_t v) {
+  if (v >= 0) return unumber((uint64_t)v);
+  separator();
+  out_.write((uint8_t)'-');
+  afterKey_ = true;            // oddělovač už je zapsaný
+  return unumber(0 - (uint64_t)v);
+}
+
+Print& JsonWriter::raw() {
+  separator();
+  return out_;
+}
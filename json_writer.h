@@ -0,0 +1,58 @@
+// json_writer.h – proudový zápis JSON do Print bez mezilehlého dokumentu
+//
+// Místo StaticJsonDocument → serializeJson → String → client.print jde
+// každá hodnota rovnou do výstupu (u HTTP do ChunkedPrint, tj. po
+// blocích do TX bufferu W5500). Čárky doplňuje writer podle zanoření,
+// takže odpověď není omezená velikostí dokumentu ani heapem.
+//
+//   JsonWriter j(out);
+//   j.beginObject().field("id", 7).key("ids").beginArray();
+//   for (...) j.value(id);
+//   j.endArray().endObject();
+
+#pragma once
+#include <Arduino.h>
+#include <type_traits>
+
+#define JSON_WRITER_DEPTH  32   // max. zanoření (bit na úroveň)
+
+class JsonWriter {
+public:
+  explicit JsonWriter(Print& out) : out_(out) {}
+
+  JsonWriter& beginObject();
+  JsonWriter& endObject();
+  JsonWriter& beginArray();
+  JsonWriter& endArray();
+  JsonWriter& key(const char* k);
+
+  JsonWriter& value(const char* s);        // nullptr = null
+  JsonWriter& value(const String& s) { return value(s.c_str()); }
+  JsonWriter& value(bool b);
+  JsonWriter& value(double v);             // %g, NaN/Inf → null
+  JsonWriter& nullValue();
+  // všechny celočíselné typy (int32_t je na různých toolchainech int i long)
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, JsonWriter&>::type
+  value(T v) {
+    return std::is_signed<T>::value ? number((int64_t)v) : unumber((uint64_t)v);
+  }
+
+  template <typename T>
+  JsonWriter& field(const char* k, const T& v) { return key(k).value(v); }
+  JsonWriter& field(const char* k, const char* v) { return key(k).value(v); }
+
+  // Místo jedné hodnoty: výstup pro hotový JSON (soubor, *PrintJson())
+  Print& raw();
+
+private:
+  void separator();
+  void writeString(const char* s);
+  JsonWriter& number(int64_t v);
+  JsonWriter& unumber(uint64_t v);
+
+  Print&   out_;
+  uint32_t nonEmpty_ = 0;     // bit = na dané úrovni už je prvek
+  uint8_t  depth_    = 0;
+  bool     afterKey_ = false;
+};
@@ -0,0 +1,61 @@
+// jsonl_file.cpp – soubory s jedním JSON objektem na řádek
+#include "jsonl_file.h"
+#include <LittleFS.h>
+
+bool jsonlAppend(const char* path, const JsonDocument& doc) {
+  File f = LittleFS.open(path, "a");
+  if (!f) return false;
+  bool ok = serializeJson(doc, f) > 0;
+  f.print('\n');
+  f.close();
+  return ok;
+}
+
+uint16_t jsonlCountLines(const char* path) {
+  uint16_t n = 0;
+  File f = LittleFS.open(path, "r");
+  if (!f) return 0;
+  while (f.available()) {
+    if (f.read() == '\n') n++;
+  }
+  f.close();
+  return n;
+}
+
+void jsonlPrintArray(Print& out, const char* path) {
+  out.print('[');
+  File f = LittleFS.open(path, "r");
+  bool first = true;
+  if (f) {
+    while (f.available()) {
+      String line = f.readStringUntil('\n');
+      // rozepsaný řádek (souběžný append) přeskočíme
+      if (!line.startsWith("{") || !line.endsWith("}")) continue;
+      if (!first) out.print(',');
+      out.print(line);
+      first = false;
+    }
+    f.close();
+  }
+  out.print(']');
+}
+
+void jsonlKeepLast(const char* path, const char* tmpPath, uint16_t total, uint16_t keep) {
+  File in = LittleFS.open(path, "r");
+  if (!in) return;
+  File out = LittleFS.open(tmpPath, "w");
+  if (!out) { in.close(); return; }
+  uint16_t skip = total > keep ? total - keep : 0;
+  uint16_t line = 0;
+  while (in.available()) {
+    String s = in.readStringUntil('\n');
+    if (line++ >= skip) {
+      out.print(s);
+      out.print('\n');
+    }
+  }
+  in.close();
+  out.close();
+  LittleFS.remove(path);
+  LittleFS.rename(tmpPath, path);
+}
@@ -0,0 +1,16 @@
+// jsonl_file.h – soubory s jedním JSON objektem na řádek (LittleFS)
+//
+// Přidání záznamu je append bez načítání celého souboru; čtení jde po
+// řádcích rovnou do klienta jako JSON pole. Používá dead-letter seznam
+// a inbox přijatých SMS.
+
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+bool     jsonlAppend(const char* path, const JsonDocument& doc);
+uint16_t jsonlCountLines(const char* path);
+// Vypíše soubor jako "[{...},{...}]"; rozepsaný poslední řádek přeskočí
+void     jsonlPrintArray(Print& out, const char* path);
+// Ponechá posledních `keep` z `total` řádků (přes dočasný soubor)
+void     jsonlKeepLast(const char* path, const char* tmpPath, uint16_t total, uint16_t keep);
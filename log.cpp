@@ -0,0 +1,95 @@
+// log.cpp – kruhový buffer logu, výpis na Serial a čtení pro /api/logs
+#include "log.h"
+#include "rt_queue.h"
+#include <stdarg.h>
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE musí být mocnina 2");
+
+// Pozice rostou monotónně (uint32), index v bufferu = pozice & (SIZE - 1).
+// V bufferu jsou platné bajty [head - SIZE, head).
+static char       ring[LOG_RING_SIZE];
+static uint32_t   head      = 0;    // konec zapsaných dat
+static uint32_t   serialPos = 0;    // kam až je vypsáno na Serial
+static uint32_t   dropped   = 0;
+static RtSpinLock lock;
+
+static const char LEVEL_CHARS[] = "-EWID";
+
+static void copyOut(char* dst, uint32_t pos, size_t n) {
+  size_t i = pos & (LOG_RING_SIZE - 1);
+  size_t first = min(n, (size_t)LOG_RING_SIZE - i);
+  memcpy(dst, ring + i, first);
+  memcpy(dst + first, ring, n - first);
+}
+
+void logWrite(uint8_t level, const char* tag, const char* fmt, ...) {
+  char line[LOG_LINE_MAX];
+  int n = snprintf(line, sizeof(line), "[%lu] %c %s: ", (unsigned long)millis(),
+                   LEVEL_CHARS[level < 5 ? level : 0], tag);
+  va_list ap;
+  va_start(ap, fmt);
+  int m = vsnprintf(line + n, sizeof(line) - n, fmt, ap);
+  va_end(ap);
+  size_t len = min((size_t)(n + max(m, 0)), sizeof(line) - 2);
+  line[len++] = '\n';
+
+  RtLockGuard g(lock);
+  size_t i = head & (LOG_RING_SIZE - 1);
+  size_t first = min(len, (size_t)LOG_RING_SIZE - i);
+  memcpy(ring + i, line, first);
+  memcpy(ring, line + first, len - first);
+  head += len;
+  if (head - serialPos > LOG_RING_SIZE) {
+    // Serial nestíhá: nejstarší řádky pro něj přepsané, pokračuje se
+    // od začátku nejbližšího celého řádku
+    serialPos = head - LOG_RING_SIZE;
+    while (serialPos != head && ring[(serialPos++) & (LOG_RING_SIZE - 1)] != '\n') {}
+    dropped++;
+  }
+}
+
+// availableForWrite() bere mutex ovladače UART – nesmí do kritické sekce
+bool logDrain() {
+  for (;;) {
+    char buf[128];
+    size_t n = min((size_t)max(Serial.availableForWrite(), 0), sizeof(buf));
+    {
+      RtLockGuard g(lock);
+      n = min(n, (size_t)(head - serialPos));
+      if (!n) return head != serialPos;
+      copyOut(buf, serialPos, n);
+      serialPos += n;
+    }
+    Serial.write((const uint8_t*)buf, n);
+  }
+}
+
+void logTail(Print& out, uint32_t since, uint32_t until) {
+  uint32_t pos = (since && until - since <= LOG_RING_SIZE) ? since
+               : (until > LOG_RING_SIZE ? until - LOG_RING_SIZE : 0);
+  while (pos != until) {
+    char buf[256];
+    size_t n = min((size_t)(until - pos), sizeof(buf));
+    {
+      RtLockGuard g(lock);
+      if (head - pos > LOG_RING_SIZE) {       // mezitím přepsáno
+        pos = head - LOG_RING_SIZE;
+        if ((int32_t)(until - pos) <= 0) return;
+        continue;
+      }
+      copyOut(buf, pos, n);
+    }
+    out.write((const uint8_t*)buf, n);
+    pos += n;
+  }
+}
+
+uint32_t logPosition() {
+  RtLockGuard g(lock);
+  return head;
+}
+
+uint32_t logDropped() {
+  RtLockGuard g(lock);
+  return dropped;
+}
@@ -0,0 +1,70 @@
+// log.h – odložený log s úrovněmi určenými při překladu
+//
+// LOG_E/W/I/D("fmt", ...) naformátuje řádek "[ms] L TAG: text" do
+// zásobníku volajícího a jen ho zkopíruje do kruhového bufferu v RAM;
+// na Serial ho vypíše logDrain() z úlohy s nejnižší prioritou (nebo
+// z loop()). Pomalý Serial tak nebrzdí smyčku modemu ani obsluhu HTTP –
+// při zahlcení se na Serialu zahodí nejstarší řádky, /api/logs vrací
+// vždy posledních LOG_RING_SIZE bajtů.
+//
+// Úroveň modulu: před použitím maker definovat LOG_TAG a LOG_LEVEL_MODULE
+// (obvykle z -D <MODUL>_LOG_LEVEL; bez ní platí LOG_LEVEL). Volání nad
+// úrovní je konstantně nepravdivá podmínka – překladač ho i s argumenty
+// vypustí.
+//
+//   #define LOG_TAG "GSM"
+//   #ifndef GSM_LOG_LEVEL
+//     #define GSM_LOG_LEVEL LOG_LEVEL
+//   #endif
+//   #define LOG_LEVEL_MODULE GSM_LOG_LEVEL
+//   #include "log.h"
+
+#pragma once
+#include <Arduino.h>
+
+#define LOG_LEVEL_NONE   0
+#define LOG_LEVEL_ERROR  1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_INFO   3
+#define LOG_LEVEL_DEBUG  4
+
+#ifndef LOG_LEVEL
+  #define LOG_LEVEL      LOG_LEVEL_INFO   // výchozí pro moduly bez vlastní úrovně
+#endif
+#ifndef LOG_RING_SIZE
+  #define LOG_RING_SIZE  4096             // mocnina 2; historie pro /api/logs
+#endif
+#ifndef LOG_LINE_MAX
+  #define LOG_LINE_MAX   160              // delší řádek se zkrátí
+#endif
+
+#ifndef LOG_TAG
+  #define LOG_TAG "APP"
+#endif
+#ifndef LOG_LEVEL_MODULE
+  #define LOG_LEVEL_MODULE LOG_LEVEL
+#endif
+
+#define LOG_AT(level, fmt, ...) do { \
+    if (LOG_LEVEL_MODULE >= (level)) logWrite((level), LOG_TAG, (fmt), ##__VA_ARGS__); \
+  } while (0)
+
+#define LOG_E(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_W(fmt, ...) LOG_AT(LOG_LEVEL_WARN,  fmt, ##__VA_ARGS__)
+#define LOG_I(fmt, ...) LOG_AT(LOG_LEVEL_INFO,  fmt, ##__VA_ARGS__)
+#define LOG_D(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+// Z libovolné úlohy; zámek drží jen po dobu memcpy do bufferu
+void     logWrite(uint8_t level, const char* tag, const char* fmt, ...)
+           __attribute__((format(printf, 3, 4)));
+
+// Vypíše čekající řádky na Serial, jen kolik se vejde do TX bufferu
+// (neblokuje); true = ještě něco čeká
+bool     logDrain();
+
+// Historie pro /api/logs: bajty [since, until), kde until = logPosition()
+// z okamžiku dotazu. Co už je přepsané (nebo since = 0), začíná
+// nejstarším bajtem v bufferu.
+void     logTail(Print& out, uint32_t since, uint32_t until);
+uint32_t logPosition();
+uint32_t logDropped();                    // řádky, které Serial nestihl
@@ -0,0 +1,67 @@
+// metrics.cpp – histogramy časů a čítače (bez závislostí na zbytku
+// firmwaru, překládá se i v tests/); export viz metrics_export.cpp
+#include "metrics.h"
+
+static MetricHistogram       timers[MT_COUNT];
+static std::atomic<uint32_t> counters[MC_COUNT];
+
+// ====== MetricHistogram ======
+void MetricHistogram::record(uint32_t us) {
+  // koš k: us <= 2^k µs
+  uint8_t k = us <= 1 ? 0 : 32 - __builtin_clz(us - 1);
+  if (k > METRICS_BUCKETS) k = METRICS_BUCKETS;
+  auto bump = [](std::atomic<uint32_t>& a, uint32_t n) {
+    a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  };
+  bump(buckets_[k], 1);
+  bump(count_, 1);
+  uint32_t s = sumUs_.load(std::memory_order_relaxed) + us;
+  if (s >= 1000000) {
+    bump(sumSec_, s / 1000000);
+    s %= 1000000;
+  }
+  sumUs_.store(s, std::memory_order_relaxed);
+}
+
+uint32_t MetricHistogram::percentileUs(uint8_t pct) const {
+  uint32_t total = count();
+  if (!total) return 0;
+  uint32_t want = (uint64_t)total * pct / 100;
+  uint32_t cum = 0;
+  for (uint8_t k = 0; k < METRICS_BUCKETS; ++k) {
+    cum += buckets_[k].load(std::memory_order_relaxed);
+    if (cum > want) return 1UL << k;
+  }
+  return UINT32_MAX;                         // v koši +Inf
+}
+
+void MetricHistogram::print(Print& out, const char* name, const char* labels) const {
+  uint32_t cum = 0;
+  for (uint8_t k = 0; k <= METRICS_BUCKETS; ++k) {
+    cum += buckets_[k].load(std::memory_order_relaxed);
+    if (k < METRICS_BUCKETS) {
+      out.printf("%s_bucket{%s,le=\"%.6f\"} %u\n", name, labels, (1UL << k) / 1e6, (unsigned)cum);
+    } else {
+      out.printf("%s_bucket{%s,le=\"+Inf\"} %u\n", name, labels, (unsigned)cum);
+    }
+  }
+  out.printf("%s_sum{%s} %u.%06u\n", name, labels,
+             (unsigned)sumSec_.load(std::memory_order_relaxed),
+             (unsigned)sumUs_.load(std::memory_order_relaxed));
+  out.printf("%s_count{%s} %u\n", name, labels, (unsigned)cum);
+}
+
+// ====== Registr ======
+MetricHistogram& metricsTimer(MetricTimer t) {
+  return timers[t];
+}
+
+void metricsAdd(MetricCounter c, uint32_t n) {
+#if METRICS_ENABLE
+  counters[c].fetch_add(n, std::memory_order_relaxed);
+#endif
+}
+
+uint32_t metricsCounter(MetricCounter c) {
+  return counters[c].load(std::memory_order_relaxed);
+}
@@ -0,0 +1,99 @@
+// metrics.h – časování smyček a čítače pro /api/metrics (Prometheus)
+//
+// MetricHistogram má pevné koše po mocninách dvou mikrosekund (1 µs …
+// 32 ms, pak +Inf); zápis je pár instrukcí bez alokace a bez zámku.
+// Zapisuje vždy jen úloha, která měří, číst smí kdokoli. Čas se bere
+// z čítače cyklů jádra – úlohy jsou připnuté (rt_tasks.h), začátek
+// i konec měření jsou tedy na stejném jádře.
+//
+//   { MetricScope m(metricsTimer(MT_SMS_QUEUE)); processSmsQueue(); }
+//
+// Časy HTTP rout drží http_server (httpServerPrintMetrics()); export
+// (Prometheus, MQTT souhrn) je v metrics_export.cpp.
+
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+#ifndef METRICS_ENABLE
+  #define METRICS_ENABLE    1
+#endif
+#ifndef METRICS_AUTH
+  #define METRICS_AUTH      0       // 1 = /api/metrics jen s přihlášením
+#endif
+#ifndef METRICS_MQTT_MS
+  #define METRICS_MQTT_MS   60000   // souhrn na <pubTopic>/metrics, 0 = vypnuto
+#endif
+#define METRICS_BUCKETS     16      // horní meze 1, 2, 4 … 32768 µs (+Inf navíc)
+
+class MetricHistogram {
+public:
+  void     record(uint32_t us);
+  uint32_t count() const { return count_.load(std::memory_order_relaxed); }
+  // Horní mez koše, do kterého padá pct % měření (0 = zatím nic)
+  uint32_t percentileUs(uint8_t pct) const;
+  // Řádky _bucket/_sum/_count; `labels` bez složených závorek
+  void     print(Print& out, const char* name, const char* labels) const;
+
+private:
+  std::atomic<uint32_t> buckets_[METRICS_BUCKETS + 1] = {};
+  std::atomic<uint32_t> count_{0};
+  std::atomic<uint32_t> sumSec_{0};   // součet = sumSec_ + sumUs_ / 1e6
+  std::atomic<uint32_t> sumUs_{0};
+};
+
+enum MetricTimer : uint8_t {
+  MT_NETWORK_LOOP,          // networkLoop()    – HTTP server, SSE
+  MT_MQTT_LOOP,             // mqttModuleLoop()
+  MT_MODEM_URC,             // handleModemURC() – UART, AT engine, URC
+  MT_SMS_QUEUE,             // processSmsQueue()
+  MT_COUNT
+};
+
+enum MetricCounter : uint8_t {
+  MC_AT_COMMANDS,           // příkazy odeslané AT enginem
+  MC_UART_RX_BYTES,
+  MC_UART_TX_BYTES,         // příkazy a PDU z AT enginu
+  MC_UART_RX_OVERFLOWS,     // přetečení HW FIFO (ztracená data)
+  MC_UART_RX_BUFFER_FULL,   // plný ring ovladače (zdržení, bez ztráty)
+  MC_UART_RX_ERRORS,        // chyby rámce / parity
+  MC_MQTT_CONNECTS,         // úspěšná (znovu)připojení k brokeru
+  MC_URC_LINES,             // neprázdné řádky z modemu (modem_urc)
+  MC_URC_OVERFLOWS,         // z toho zkrácené na URC_LINE_MAX
+  MC_COUNT
+};
+
+MetricHistogram& metricsTimer(MetricTimer t);
+void     metricsAdd(MetricCounter c, uint32_t n = 1);
+uint32_t metricsCounter(MetricCounter c);
+
+#if defined(ARDUINO_ARCH_ESP32)
+  inline uint32_t metricsCycles()               { return ESP.getCycleCount(); }
+  inline uint32_t metricsCyclesToUs(uint32_t c) { return c / ESP.getCpuFreqMHz(); }
+#else
+  inline uint32_t metricsCycles()               { return micros(); }
+  inline uint32_t metricsCyclesToUs(uint32_t c) { return c; }
+#endif
+
+#if METRICS_ENABLE
+class MetricScope {
+public:
+  explicit MetricScope(MetricHistogram& h) : h_(h), start_(metricsCycles()) {}
+  ~MetricScope() { h_.record(metricsCyclesToUs(metricsCycles() - start_)); }
+  MetricScope(const MetricScope&) = delete;
+  MetricScope& operator=(const MetricScope&) = delete;
+private:
+  MetricHistogram& h_;
+  uint32_t         start_;
+};
+#else
+class MetricScope {
+public:
+  explicit MetricScope(MetricHistogram&) {}
+};
+#endif
+
+// Prometheus text (smyčky, čítače, SMS, heap) – HTTP routy doplní volající
+void   metricsPrint(Print& out);
+// Krátký JSON souhrn (p50/p99 smyček, čítače, heap) pro MQTT
+size_t metricsSummaryJson(char* buf, size_t cap);
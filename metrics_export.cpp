@@ -0,0 +1,83 @@
+// metrics_export.cpp – export metrik pro Prometheus (/api/metrics) a MQTT
+#include "metrics.h"
+#include "gsm_modem.h"
+#include "log.h"
+#include <ArduinoJson.h>
+
+static const char* const TIMER_NAMES[MT_COUNT] = { "network", "mqtt", "modem_urc", "sms_queue" };
+
+static uint32_t heapFree() {
+#if defined(ARDUINO_ARCH_ESP32)
+  return ESP.getFreeHeap();
+#else
+  return 0;
+#endif
+}
+
+static uint32_t heapMinFree() {
+#if defined(ARDUINO_ARCH_ESP32)
+  return ESP.getMinFreeHeap();
+#else
+  return 0;
+#endif
+}
+
+// ====== Export ======
+static void printMetric(Print& out, const char* name, const char* type, const char* help, uint32_t v) {
+  out.printf("# HELP %s %s\n# TYPE %s %s\n%s %u\n", name, help, name, type, name, (unsigned)v);
+}
+
+void metricsPrint(Print& out) {
+  out.print("# HELP smsgw_loop_seconds Duration of one pass of a subsystem loop\n"
+            "# TYPE smsgw_loop_seconds histogram\n");
+  for (uint8_t t = 0; t < MT_COUNT; ++t) {
+    char labels[32];
+    snprintf(labels, sizeof(labels), "loop=\"%s\"", TIMER_NAMES[t]);
+    metricsTimer((MetricTimer)t).print(out, "smsgw_loop_seconds", labels);
+  }
+
+  printMetric(out, "smsgw_at_commands_total",   "counter", "AT commands sent by the AT engine", metricsCounter(MC_AT_COMMANDS));
+  printMetric(out, "smsgw_uart_rx_bytes_total", "counter", "Bytes received from the modem",     metricsCounter(MC_UART_RX_BYTES));
+  printMetric(out, "smsgw_uart_tx_bytes_total", "counter", "Bytes sent to the modem",           metricsCounter(MC_UART_TX_BYTES));
+  printMetric(out, "smsgw_uart_rx_overflows_total",   "counter", "Modem UART FIFO overflows (bytes lost)", metricsCounter(MC_UART_RX_OVERFLOWS));
+  printMetric(out, "smsgw_uart_rx_buffer_full_total", "counter", "Modem UART ring buffer full events",     metricsCounter(MC_UART_RX_BUFFER_FULL));
+  printMetric(out, "smsgw_uart_rx_errors_total",      "counter", "Modem UART framing/parity errors",       metricsCounter(MC_UART_RX_ERRORS));
+  printMetric(out, "smsgw_mqtt_connects_total", "counter", "Successful MQTT (re)connects",      metricsCounter(MC_MQTT_CONNECTS));
+  printMetric(out, "smsgw_urc_lines_total",     "counter", "Non-empty lines received from the modem", metricsCounter(MC_URC_LINES));
+  printMetric(out, "smsgw_urc_overflows_total", "counter", "Modem lines truncated to URC_LINE_MAX",  metricsCounter(MC_URC_OVERFLOWS));
+  printMetric(out, "smsgw_log_dropped_total",   "counter", "Log lines overwritten before Serial", logDropped());
+
+  SmsThroughput sms = getSmsStatus().stats;
+  printMetric(out, "smsgw_sms_sent_total",      "counter", "SMS sent",                          sms.sent);
+  printMetric(out, "smsgw_sms_failed_total",    "counter", "SMS moved to dead-letter",          sms.failed);
+  printMetric(out, "smsgw_sms_retried_total",   "counter", "Transient SMS errors retried",      sms.retried);
+  printMetric(out, "smsgw_sms_segments_total",  "counter", "PDU segments sent",                 sms.segments);
+  printMetric(out, "smsgw_sms_queue_length",    "gauge",   "SMS jobs waiting in the queue",     getSmsQueueSize());
+
+  printMetric(out, "smsgw_heap_free_bytes",     "gauge",   "Free heap",                         heapFree());
+  printMetric(out, "smsgw_heap_min_free_bytes", "gauge",   "Lowest free heap since boot",       heapMinFree());
+  printMetric(out, "smsgw_uptime_seconds",      "gauge",   "Seconds since boot",                millis() / 1000);
+}
+
+size_t metricsSummaryJson(char* buf, size_t cap) {
+  StaticJsonDocument<512> j;
+  j["uptime"]       = millis() / 1000;
+  j["heapFree"]     = heapFree();
+  j["heapMinFree"]  = heapMinFree();
+  SmsThroughput sms = getSmsStatus().stats;
+  j["smsSent"]      = sms.sent;
+  j["smsFailed"]    = sms.failed;
+  j["atCommands"]   = metricsCounter(MC_AT_COMMANDS);
+  j["uartRx"]       = metricsCounter(MC_UART_RX_BYTES);
+  j["uartTx"]       = metricsCounter(MC_UART_TX_BYTES);
+  j["uartOverflows"] = metricsCounter(MC_UART_RX_OVERFLOWS);
+  j["mqttConnects"] = metricsCounter(MC_MQTT_CONNECTS);
+  // [p50, p99] v µs (horní mez koše)
+  JsonObject loops = j.createNestedObject("loopUs");
+  for (uint8_t t = 0; t < MT_COUNT; ++t) {
+    JsonArray a = loops.createNestedArray(TIMER_NAMES[t]);
+    a.add(metricsTimer((MetricTimer)t).percentileUs(50));
+    a.add(metricsTimer((MetricTimer)t).percentileUs(99));
+  }
+  return serializeJson(j, buf, cap);
+}
@@ -0,0 +1,105 @@
+// modem_uart.cpp – UART modemu nad ovladačem ESP-IDF (fronta událostí)
+#include "modem_uart.h"
+#include "metrics.h"
+
+#define LOG_TAG "UART"
+#include "log.h"
+
+bool ModemUart::begin(uint32_t baud, int rxPin, int txPin) {
+  uart_config_t cfg = {};
+  cfg.baud_rate  = baud;
+  cfg.data_bits  = UART_DATA_8_BITS;
+  cfg.parity     = UART_PARITY_DISABLE;
+  cfg.stop_bits  = UART_STOP_BITS_1;
+  cfg.flow_ctrl  = UART_HW_FLOWCTRL_DISABLE;
+  cfg.source_clk = UART_SCLK_APB;
+  if (uart_driver_install(port_, MODEM_UART_RX_BUF, MODEM_UART_TX_BUF,
+                          MODEM_UART_EVENTS, &events_, 0) != ESP_OK ||
+      uart_param_config(port_, &cfg) != ESP_OK ||
+      uart_set_pin(port_, txPin, rxPin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+    LOG_E("UART%d: instalace ovladače selhala", (int)port_);
+    return false;
+  }
+  // LF = konec řádku → UART_PATTERN_DET; prompt "> " končí bez LF a
+  // probudí úlohu až ticho na lince (UART_DATA po MODEM_UART_RX_TOUT)
+  uart_enable_pattern_det_baud_intr(port_, '\n', 1, 9, 0, 0);
+  uart_pattern_queue_reset(port_, MODEM_UART_EVENTS);
+  uart_set_rx_timeout(port_, MODEM_UART_RX_TOUT);
+  return true;
+}
+
+bool ModemUart::waitEvent(uint32_t ms) {
+  if (!events_) {
+    delay(ms);
+    return false;
+  }
+  uart_event_t ev;
+  bool woke = false;
+  // první událost čekáním, zbytek fronty hned za ní
+  while (xQueueReceive(events_, &ev, woke ? 0 : pdMS_TO_TICKS(ms)) == pdTRUE) {
+    woke = true;
+    switch (ev.type) {
+      case UART_PATTERN_DET:
+        // pozice LF nepotřebujeme (řádky dělí modem_urc), jen ať
+        // se fronta pozic nezaplní
+        while (uart_pattern_pop_pos(port_) >= 0) {}
+        break;
+      case UART_FIFO_OVF:           // HW FIFO přeteklo, ovladač ho vyprázdnil
+        metricsAdd(MC_UART_RX_OVERFLOWS);
+        LOG_W("UART%d: přetečení FIFO, data ztracena", (int)port_);
+        break;
+      case UART_BUFFER_FULL:        // plný ring: data čekají v FIFO, dokud nečteme
+        metricsAdd(MC_UART_RX_BUFFER_FULL);
+        break;
+      case UART_FRAME_ERR:
+      case UART_PARITY_ERR:
+        metricsAdd(MC_UART_RX_ERRORS);
+        break;
+      default:
+        break;
+    }
+  }
+  return woke;
+}
+
+int ModemUart::available() {
+  size_t n = 0;
+  uart_get_buffered_data_len(port_, &n);
+  return (int)n + (peeked_ >= 0);
+}
+
+int ModemUart::read() {
+  uint8_t b;
+  return readBytes(&b, 1) ? b : -1;
+}
+
+int ModemUart::peek() {
+  if (peeked_ < 0) {
+    uint8_t b;
+    if (uart_read_bytes(port_, &b, 1, 0) == 1) peeked_ = b;
+  }
+  return peeked_;
+}
+
+// Neblokující: vrátí jen to, co už je v bufferu
+size_t ModemUart::readBytes(uint8_t* buf, size_t len) {
+  size_t n = 0;
+  if (len && peeked_ >= 0) {
+    buf[n++] = (uint8_t)peeked_;
+    peeked_  = -1;
+  }
+  if (n < len) {
+    int r = uart_read_bytes(port_, buf + n, len - n, 0);
+    if (r > 0) n += r;
+  }
+  return n;
+}
+
+size_t ModemUart::write(const uint8_t* buf, size_t len) {
+  int n = uart_write_bytes(port_, (const char*)buf, len);
+  return n > 0 ? n : 0;
+}
+
+void ModemUart::flush() {
+  uart_wait_tx_done(port_, portMAX_DELAY);
+}
@@ -0,0 +1,54 @@
+// modem_uart.h – UART modemu přes ovladač ESP-IDF s frontou událostí
+//
+// Přijatá data ukládá přerušení ovladače do kruhového bufferu
+// MODEM_UART_RX_BUF, takže nezáleží na tom, jak dlouho modemová úloha
+// zrovna nečte (zápis do flash, dlouhý HTTP požadavek). Úloha čeká ve
+// waitEvent(): probudí ji LF (pattern detekce), ticho na lince po
+// datech bez LF (prompt "> ") nebo naplnění FIFO. Přetečení se počítají
+// do metrik (smsgw_uart_rx_overflows_total …).
+//
+// Navenek je to Stream – AT engine i handleModemURC() ho používají
+// stejně jako dřív HardwareSerial.
+
+#pragma once
+#include <Arduino.h>
+#include <driver/uart.h>
+
+#ifndef MODEM_UART_BAUD
+  #define MODEM_UART_BAUD     9600
+#endif
+#ifndef MODEM_UART_RX_BUF
+  #define MODEM_UART_RX_BUF   4096   // ~4 s provozu při 9600 Bd
+#endif
+#ifndef MODEM_UART_TX_BUF
+  #define MODEM_UART_TX_BUF   1024   // PDU se zapíše bez čekání na odvysílání
+#endif
+#ifndef MODEM_UART_EVENTS
+  #define MODEM_UART_EVENTS   32     // fronta událostí i pozic LF
+#endif
+#ifndef MODEM_UART_RX_TOUT
+  #define MODEM_UART_RX_TOUT  3      // ticho [znaky] → událost s daty bez LF
+#endif
+
+class ModemUart : public Stream {
+public:
+  explicit ModemUart(uart_port_t port) : port_(port) {}
+
+  bool   begin(uint32_t baud, int rxPin, int txPin);
+  // Čeká na událost UART nejvýš `ms`; true = něco přišlo (nebo chyba)
+  bool   waitEvent(uint32_t ms);
+
+  int    available() override;
+  int    read() override;
+  int    peek() override;
+  size_t readBytes(uint8_t* buf, size_t len);
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t* buf, size_t len) override;
+  void   flush() override;
+  using Print::write;
+
+private:
+  uart_port_t   port_;
+  QueueHandle_t events_ = nullptr;
+  int           peeked_ = -1;
+};
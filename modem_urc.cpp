@@ -0,0 +1,104 @@
+// modem_urc.cpp – řádkový rámec UART modemu a tabulka URC
+#include "modem_urc.h"
+#include "at_engine.h"
+#include "sms_inbox.h"
+#include "metrics.h"
+
+#define LOG_TAG "URC"
+#ifndef URC_LOG_LEVEL
+  #define URC_LOG_LEVEL LOG_LEVEL
+#endif
+#define LOG_LEVEL_MODULE URC_LOG_LEVEL
+#include "log.h"
+
+// ====== Stav (jen modemová úloha) ======
+static char            line[URC_LINE_MAX];
+static size_t          lineLen    = 0;
+static bool            overflow   = false;   // zbytek řádku se zahazuje
+static const UrcRoute* urcs       = nullptr;
+static size_t          urcCount   = 0;
+
+// Délka klíče: do ':' (bez něj), jinak celý řádek ("RING", "NO CARRIER")
+static size_t keyLen(const char* s, size_t len) {
+  const char* colon = (const char*)memchr(s, ':', len);
+  return colon ? colon - s : len;
+}
+
+static int keyCmp(const char* key, const char* s, size_t n) {
+  int d = strncmp(key, s, n);
+  return d ? d : (key[n] ? 1 : 0);
+}
+
+static const UrcRoute* findUrc(const char* s, size_t len) {
+  size_t n = keyLen(s, len);
+  size_t lo = 0, hi = urcCount;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    int d = keyCmp(urcs[mid].key, s, n);
+    if (d == 0) return &urcs[mid];
+    if (d < 0) lo = mid + 1;
+    else       hi = mid;
+  }
+  return nullptr;
+}
+
+static void dispatch(const char* s, size_t len) {
+  if (smsInboxWantsBody()) {                 // i prázdný řádek (prázdná SMS)
+    smsInboxOnBody(s);
+    return;
+  }
+  if (len == 0) return;
+  metricsAdd(MC_URC_LINES);
+  LOG_D("  < %s", s);
+  const UrcRoute* r = findUrc(s, len);
+  if (r && (r->flags & URC_FIRST)) {
+    r->handler(s, len);
+    return;
+  }
+  if (atEngineOnLine(s)) return;
+  if (r) r->handler(s, len);
+}
+
+static void endLine() {
+  while (lineLen && line[lineLen - 1] == ' ') --lineLen;
+  line[lineLen] = '\0';
+  if (overflow) {
+    metricsAdd(MC_URC_OVERFLOWS);
+    LOG_W("řádek delší než %u B zkrácen: %.24s…", (unsigned)URC_LINE_MAX - 1, line);
+  }
+  dispatch(line, lineLen);
+  lineLen  = 0;
+  overflow = false;
+}
+
+// ====== API ======
+void urcBegin(const UrcRoute* table, size_t count) {
+  urcs     = table;
+  urcCount = count;
+  for (size_t i = 1; i < count; ++i) {
+    if (strcmp(table[i - 1].key, table[i].key) >= 0) {
+      LOG_E("tabulka URC není seřazená u %s", table[i].key);
+    }
+  }
+}
+
+// Prompt '>' přichází bez konce řádku, proto se hlídá po znacích.
+void urcFeed(const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    char c = (char)data[i];
+    if (c == '\n') {
+      endLine();
+      continue;
+    }
+    if (c == '\r') continue;
+    if (lineLen == 0) {
+      if (c == '>' && atEngineWantsPrompt()) {
+        atEngineOnPrompt();
+        continue;
+      }
+      if (c == ' ') continue;                // "> " i odsazení
+    }
+    if (lineLen < sizeof(line) - 1) line[lineLen++] = c;
+    else                            overflow = true;
+  }
+}
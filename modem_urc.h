@@ -0,0 +1,40 @@
+// modem_urc.h – skládání řádků z UART modemu a rozesílání URC
+//
+// Bajty z UART se skládají do pevného bufferu (bez Stringu), LF uzavírá
+// řádek. Hotový řádek dostane postupně:
+//   1. inbox, čeká-li na řádek s PDU po +CMT/+CMGR,
+//   2. URC s příznakem URC_FIRST (musí předběhnout AT_CAPTURE_ALL),
+//   3. aktivní AT příkaz (echo, prefix, finální řádek),
+//   4. ostatní URC z tabulky.
+// Tabulka je seřazená podle klíče (text před ':', u "RING" celý řádek)
+// a hledá se binárně, stejně jako routy HTTP serveru.
+//
+//   static const UrcRoute URCS[] = {
+//     { "+CLIP", 0, onClip },
+//     { "RING",  0, onRing },
+//   };
+//   urcBegin(URCS, sizeof(URCS) / sizeof(URCS[0]));
+
+#pragma once
+#include <Arduino.h>
+
+#ifndef URC_LINE_MAX
+  #define URC_LINE_MAX  512   // delší řádek se zkrátí (SMS-DELIVER PDU < 360 znaků)
+#endif
+
+#define URC_FIRST       0x01  // před AT enginem (hlavičky přijatých SMS)
+
+// `line` je ukončený '\0', bez CR/LF a okrajových mezer
+typedef void (*UrcHandler)(const char* line, size_t len);
+
+struct UrcRoute {
+  const char* key;            // např. "+CMTI" (bez ':')
+  uint8_t     flags;
+  UrcHandler  handler;
+};
+
+// Tabulka musí mít statickou životnost; neseřazenou ohlásí do logu
+void urcBegin(const UrcRoute* table, size_t count);
+
+// Zpracuje přijaté bajty včetně promptu '>' pro AT engine (modemová úloha)
+void urcFeed(const uint8_t* data, size_t len);
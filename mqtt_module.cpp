@@ -1,14 +1,20 @@
 // mqtt_module.cpp (optimalizovaná verze)
 #include "mqtt_module.h"
+#include "sms_retry.h"
+#include "sms_inbox.h"
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <WiFiClient.h>
 #include "gsm_modem.h"
+#include "rt_queue.h"
+#include "http_server.h"
+#include "metrics.h"
 
 // ─── Forward declarations ────────────────────────────────────
 // so that restartMqttConnection() can refer to these below
 static void mqttCallback(char* topic, byte* payload, unsigned int length);
 static const char* stateToString(int8_t state);
+static void flushModemEvents();
 
 // ====== Konfigurace a proměnné ======
 MqttConfig cfg;
@@ -19,15 +25,13 @@ PubSubClient mqttClient(ethClient);
 constexpr const char* CONFIG_PATH = "/mqtt_config.json";
 constexpr unsigned long RECONNECT_INTERVAL = 5000;
 
-// ====== Pomocné makro pro debug výpisy ======
-#ifndef MQTT_DEBUG
-#define MQTT_DEBUG 1
-#endif
-#if MQTT_DEBUG
-  #define MQTT_DBG(x) do { Serial.print(F("[MQTT] ")); Serial.println(x); } while(0)
-#else
-  #define MQTT_DBG(x)
+// ====== Log ======
+#define LOG_TAG "MQTT"
+#ifndef MQTT_LOG_LEVEL
+  #define MQTT_LOG_LEVEL LOG_LEVEL
 #endif
+#define LOG_LEVEL_MODULE MQTT_LOG_LEVEL
+#include "log.h"
 
 // ====== Pomocné funkce pro JSON a konfiguraci ======
 static bool loadConfig() {
@@ -49,6 +53,7 @@ static bool loadConfig() {
   cfg.smsTopic     = doc["smsTopic"].as<String>();
   cfg.callerTopic  = doc["callerTopic"].as<String>();
   cfg.pubTopic     = doc["pubTopic"].as<String>();
+  cfg.inboxTopic   = doc["inboxTopic"] | "";
   return true;
 }
 
@@ -65,6 +70,7 @@ static bool saveConfig() {
   doc["smsTopic"]     = cfg.smsTopic;
   doc["callerTopic"]  = cfg.callerTopic;
   doc["pubTopic"]     = cfg.pubTopic;
+  doc["inboxTopic"]   = cfg.inboxTopic;
   File f = LittleFS.open(CONFIG_PATH, "w");
   if (!f) return false;
   bool ok = serializeJson(doc, f) > 0;
@@ -76,13 +82,13 @@ static bool saveConfig() {
 bool restartMqttConnection() {
   // 1) Ujisti se, že máme config na FS
   if (!loadConfig() || !cfg.broker.length()) {
-    MQTT_DBG("⚠️ restartMQTT: žádný konfig");
+    LOG_W("⚠️ restartMQTT: žádný konfig");
     return false;
   }
   // 2) Pokud už jsme připojení, odpoj
   if (mqttClient.connected()) {
     mqttClient.disconnect();
-    MQTT_DBG("⏹️ MQTT disconnected (restart)");
+    LOG_I("⏹️ MQTT disconnected (restart)");
   }
   // 3) Nastav server a keepalive/zpětný callback
   mqttClient.setServer(cfg.broker.c_str(), cfg.port);
@@ -90,7 +96,7 @@ bool restartMqttConnection() {
   mqttClient.setCallback(mqttCallback);
 
   // 4) Pokus se připojit znovu
-  MQTT_DBG(String("⏳ MQTT reconnect to ") + cfg.broker + ":" + cfg.port);
+  LOG_I("⏳ MQTT reconnect to %s:%u", cfg.broker.c_str(), (unsigned)cfg.port);
   bool ok = cfg.username.length()
     ? mqttClient.connect(
         cfg.clientId.c_str(),
@@ -102,10 +108,10 @@ bool restartMqttConnection() {
     : mqttClient.connect(cfg.clientId.c_str());
   if (!ok) {
     int8_t st = mqttClient.state();
-    MQTT_DBG(String("❌ restartMQTT failed: ") + st + " (" + stateToString(st) + ")");
+    LOG_W("❌ restartMQTT failed: %d (%s)", st, stateToString(st));
     return false;
   }
-  MQTT_DBG("✅ restartMQTT ok");
+  LOG_I("✅ restartMQTT ok");
 
   // 5) Přihlásit se na topicy
   if (cfg.statusTopic.length())  mqttClient.subscribe(cfg.statusTopic.c_str());
@@ -133,8 +139,8 @@ static const char* stateToString(int8_t s) {
 
 // ====== MQTT Callback ======
 static void mqttCallback(char* topic, byte* payload, unsigned int length) {
+  LOG_D("📥 MQTT zpráva na [%s]: %.*s", topic, (int)length, (const char*)payload);
   String msg((char*)payload, length);
-  MQTT_DBG(String("📥 MQTT zpráva na [") + topic + "]: " + msg);
   String tp(topic);
 
   // 1) Odeslání SMS přes frontu
@@ -143,11 +149,12 @@ static void mqttCallback(char* topic, byte* payload, unsigned int length) {
     if (deserializeJson(j, msg) == DeserializationError::Ok) {
       String rec = j["recipients"].as<String>();
       String txt = j["message"].   as<String>();
-      bool ok = modemScheduleSMS(rec, txt, "");
+      String at  = j["sendTime"] | "";
+      bool ok = modemScheduleSMS(rec, txt, at, SMS_SRC_MQTT);
       // ACK
       if (cfg.pubTopic.length()) {
         StaticJsonDocument<128> ack;
-        ack["status"]     = ok ? "queued" : "error";
+        ack["status"]     = ok ? (at.length() ? "scheduled" : "queued") : "error";
         ack["recipients"] = rec;
         ack["message"]    = txt;
         char buf[128];
@@ -155,7 +162,7 @@ static void mqttCallback(char* topic, byte* payload, unsigned int length) {
         mqttClient.publish(cfg.pubTopic.c_str(), buf, n);
       }
     } else {
-      MQTT_DBG("❌ JSON CHYBA SMS");
+      LOG_W("❌ JSON CHYBA SMS");
     }
   }
   // 2) Stav zařízení
@@ -163,6 +170,7 @@ static void mqttCallback(char* topic, byte* payload, unsigned int length) {
     StaticJsonDocument<128> st;
     st["uptime"]   = millis() / 1000;
     st["freeHeap"] = ESP.getFreeHeap();
+    st["smsDeadLetters"] = smsDeadLetterCount();
     char buf[128];
     size_t n = serializeJson(st, buf);
     if (cfg.pubTopic.length())
@@ -177,66 +185,175 @@ static void mqttCallback(char* topic, byte* payload, unsigned int length) {
 
 // ====== Inicializace MQTT modulu ======
 void mqttModuleInit() {
-  if (!LittleFS.begin()) Serial.println("⚠️ LittleFS mount failed");
+  if (!LittleFS.begin()) LOG_E("⚠️ LittleFS mount failed");
+  mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
   if (loadConfig()) {
-    MQTT_DBG(String("⚡ MQTT config: ") + cfg.broker + ':' + cfg.port + "  clientId=" + cfg.clientId);
+    LOG_I("⚡ MQTT config: %s:%u  clientId=%s", cfg.broker.c_str(), (unsigned)cfg.port, cfg.clientId.c_str());
     mqttClient.setServer(cfg.broker.c_str(), cfg.port);
     mqttClient.setKeepAlive(cfg.keepalive);
     mqttClient.setCallback(mqttCallback);
   } else {
-    MQTT_DBG("⚠️ MQTT config nenalezen");
+    LOG_W("⚠️ MQTT config nenalezen");
   }
 }
 
 // ====== Smyčka + reconnect + subscribe ======
 void mqttModuleLoop() {
+  flushModemEvents();   // bez spojení se události jen zahodí (s logem)
   if (!cfg.broker.length()) return;
   static unsigned long lastReconnect = 0;
   unsigned long now = millis();
   if (!mqttClient.connected()) {
     if (now - lastReconnect < RECONNECT_INTERVAL) return;
     lastReconnect = now;
-    MQTT_DBG(String("⏳ MQTT reconnect to ") + cfg.broker + ':' + cfg.port + "…");
+    LOG_I("⏳ MQTT reconnect to %s:%u…", cfg.broker.c_str(), (unsigned)cfg.port);
     bool ok = cfg.username.length()
       ? mqttClient.connect(cfg.clientId.c_str(), cfg.username.c_str(), cfg.password.c_str())
       : mqttClient.connect(cfg.clientId.c_str());
     if (ok) {
-      MQTT_DBG("✅ MQTT připojeno");
+      LOG_I("✅ MQTT připojeno");
+      metricsAdd(MC_MQTT_CONNECTS);
       if (cfg.statusTopic.length()) mqttClient.subscribe(cfg.statusTopic.c_str());
       if (cfg.smsTopic.length())    mqttClient.subscribe(cfg.smsTopic.c_str());
       if (cfg.callerTopic.length()) mqttClient.subscribe(cfg.callerTopic.c_str());
     } else {
       int8_t st = mqttClient.state();
-      MQTT_DBG(String("❌ MQTT fail: ") + st + " (" + stateToString(st) + ")");
+      LOG_W("❌ MQTT fail: %d (%s)", st, stateToString(st));
     }
     return;
   }
   mqttClient.loop();
+
+#if METRICS_MQTT_MS
+  // Souhrn metrik pro dohled bez Promethea
+  static unsigned long lastMetrics = 0;
+  if (cfg.pubTopic.length() && now - lastMetrics >= METRICS_MQTT_MS) {
+    lastMetrics = now;
+    char buf[MQTT_BUFFER_SIZE - 128];
+    size_t n = metricsSummaryJson(buf, sizeof(buf));
+    mqttClient.publish((cfg.pubTopic + "/metrics").c_str(), (const uint8_t*)buf, n);
+  }
+#endif
 }
 
 // ====== Publikace Caller ID na MQTT ======
-void mqttPublishCaller(const String &caller) {
-  if (cfg.callerTopic.length() > 0 && mqttClient.connected()) {
-    MQTT_DBG(String("⬆️ MQTT publish [") + cfg.callerTopic + "]: " + caller);
-    mqttClient.publish(cfg.callerTopic.c_str(), caller.c_str());
-  } else {
-    MQTT_DBG("⚠️ mqttPublishCaller skipped: no topic or MQTT disconnected");
+// Volá modemová úloha – číslo jen předá SPSC frontou, publikuje MQTT úloha.
+struct CallerEvent {
+  char number[24];
+  char name[CONTACT_NAME_MAX];      // "" = neznámé číslo
+  char group[CONTACT_GROUP_MAX];
+};
+static SpscRing<CallerEvent, 8> callerEvents;
+
+void mqttPublishCaller(const char* caller, const ContactInfo* contact) {
+  CallerEvent ev;
+  strlcpy(ev.number, caller, sizeof(ev.number));
+  strlcpy(ev.name,  contact ? contact->name  : "", sizeof(ev.name));
+  strlcpy(ev.group, contact ? contact->group : "", sizeof(ev.group));
+  if (!callerEvents.push(ev)) LOG_W("⚠️ mqttPublishCaller: fronta událostí plná");
+}
+
+// Přijaté SMS – publikuje se celý text, proto větší záznam
+static SpscRing<SmsDeliver, 8> smsReceivedEvents;
+
+bool mqttPublishSmsReceived(const SmsDeliver& msg) {
+  if (smsReceivedEvents.push(msg)) return true;
+  LOG_W("⚠️ mqttPublishSmsReceived: fronta událostí plná");
+  return false;
+}
+
+// Dead-letter události – stejná cesta jako Caller ID, cíl je pubTopic
+struct SmsFailedEvent {
+  uint32_t id;
+  int16_t  error;
+  uint8_t  attempts;
+  char     recipient[24];
+};
+static SpscRing<SmsFailedEvent, 8> smsFailedEvents;
+
+void mqttPublishSmsFailed(uint32_t id, const char* recipient, int error, uint8_t attempts) {
+  SmsFailedEvent ev;
+  ev.id       = id;
+  ev.error    = error;
+  ev.attempts = attempts;
+  strncpy(ev.recipient, recipient, sizeof(ev.recipient) - 1);
+  ev.recipient[sizeof(ev.recipient) - 1] = '\0';
+  if (!smsFailedEvents.push(ev)) LOG_W("⚠️ mqttPublishSmsFailed: fronta událostí plná");
+}
+
+static void flushModemEvents() {
+  SmsDeliver re;
+  while (smsReceivedEvents.pop(re)) {
+    if (cfg.inboxTopic.length() > 0 && mqttClient.connected()) {
+      StaticJsonDocument<256> j;
+      j["from"] = (const char*)re.from;
+      j["scts"] = (const char*)re.scts;
+      j["text"] = (const char*)re.text;
+      if (re.parts > 1) {
+        j["ref"]   = re.ref;
+        j["part"]  = re.part;
+        j["parts"] = re.parts;
+      }
+      char buf[MQTT_BUFFER_SIZE - 128];
+      size_t n = serializeJson(j, buf, sizeof(buf));
+      mqttClient.publish(cfg.inboxTopic.c_str(), (const uint8_t*)buf, n);
+    } else {
+      LOG_W("⚠️ mqttPublishSmsReceived skipped: MQTT disconnected");
+    }
+  }
+
+  SmsFailedEvent fe;
+  while (smsFailedEvents.pop(fe)) {
+    if (cfg.pubTopic.length() > 0 && mqttClient.connected()) {
+      StaticJsonDocument<160> j;
+      j["status"]     = "failed";
+      j["id"]         = fe.id;
+      j["recipients"] = fe.recipient;
+      j["error"]      = fe.error;
+      j["attempts"]   = fe.attempts;
+      char buf[160];
+      size_t n = serializeJson(j, buf);
+      mqttClient.publish(cfg.pubTopic.c_str(), (const uint8_t*)buf, n);
+    } else {
+      LOG_W("⚠️ mqttPublishSmsFailed skipped: no topic or MQTT disconnected");
+    }
+  }
+
+  CallerEvent ev;
+  while (callerEvents.pop(ev)) {
+    if (cfg.callerTopic.length() > 0 && mqttClient.connected()) {
+      LOG_D("⬆️ MQTT publish [%s]: %s", cfg.callerTopic.c_str(), ev.number);
+      mqttClient.publish(cfg.callerTopic.c_str(), ev.number);
+      String topic = cfg.callerTopic + "/contact";
+      if (!*ev.number) {
+        mqttClient.publish(topic.c_str(), "");
+        continue;
+      }
+      StaticJsonDocument<160> j;
+      j["number"] = (const char*)ev.number;
+      j["name"]   = *ev.name  ? (const char*)ev.name  : nullptr;
+      j["group"]  = *ev.group ? (const char*)ev.group : nullptr;
+      char buf[160];
+      size_t len = serializeJson(j, buf);
+      mqttClient.publish(topic.c_str(), (const uint8_t*)buf, len);
+    } else {
+      LOG_W("⚠️ mqttPublishCaller skipped: no topic or MQTT disconnected");
+    }
   }
 }
 
 // ====== HTTP API handlery ======
 void handleGetMqttConfig(EthernetClient &client) {
-  client.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n");
-  if (LittleFS.exists(CONFIG_PATH)) {
-    File f = LittleFS.open(CONFIG_PATH, "r");
-    while (f.available()) client.write(f.read());
-    f.close();
-  } else {
-    client.print("{}");
-  }
+  httpBeginResponse(client, 200, "application/json", -1);
+  ChunkedPrint out(client);
+  File f = LittleFS.open(CONFIG_PATH, "r");
+  if (!f) { out.print("{}"); return; }
+  uint8_t buf[256];
+  while (size_t n = f.read(buf, sizeof(buf))) out.write(buf, n);
+  f.close();
 }
 
-void handlePostMqttConfig(EthernetClient &client, const String &body) {
+void handlePostMqttConfig(EthernetClient &client, const char* body) {
   StaticJsonDocument<512> doc;
   if (deserializeJson(doc, body) == DeserializationError::Ok) {
     cfg.clientId     = doc["clientId"].as<String>();
@@ -250,18 +367,21 @@ void handlePostMqttConfig(EthernetClient &client, const String &body) {
     cfg.smsTopic     = doc["smsTopic"].as<String>();
     cfg.callerTopic  = doc["callerTopic"].as<String>();
     cfg.pubTopic     = doc["pubTopic"].as<String>();
+    cfg.inboxTopic   = doc["inboxTopic"] | "";
     saveConfig();
     // ihned restartuj MQTT podle nové konfigurace
     if (!restartMqttConnection()) {
-      MQTT_DBG("⚠️ MQTT reconnect after config update failed");
+      LOG_W("⚠️ MQTT reconnect after config update failed");
     }
-    client.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n{\"success\":true}");
-    } else {
-    client.print("HTTP/1.1 400 Bad Request\r\nContent-Type: application/json\r\n\r\n{\"success\":false}");
+    HttpJsonResponse res(client, 200);
+    res.beginObject().field("success", true).endObject();
+  } else {
+    HttpJsonResponse res(client, 400);
+    res.beginObject().field("success", false).endObject();
   }
 }
 
-void handleMqttTest(EthernetClient &client, const String &body) {
+void handleMqttTest(EthernetClient &client, const char* body) {
   StaticJsonDocument<256> doc;
   bool ok = false; String err;
   if (deserializeJson(doc, body) == DeserializationError::Ok) {
@@ -280,8 +400,8 @@ void handleMqttTest(EthernetClient &client, const String &body) {
   } else {
     err = "invalid JSON";
   }
-  client.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n");
-  client.printf("{\"success\":%s", ok ? "true" : "false");
-  if (!ok) client.printf(",\"error\":\"%s\"", err.c_str());
-  client.print("}");
+  HttpJsonResponse res(client, 200);
+  res.beginObject().field("success", ok);
+  if (!ok) res.field("error", err);
+  res.endObject();
 }
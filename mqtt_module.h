@@ -5,6 +5,11 @@
 #include <Arduino.h>
 #include <Ethernet.h>
 #include "gsm_modem.h"        // modemScheduleSMS()
+#include "contact_store.h"    // ContactInfo
+
+#ifndef MQTT_BUFFER_SIZE
+  #define MQTT_BUFFER_SIZE  768   // přijatá SMS v JSON se do výchozích 256 B nevejde
+#endif
 
 // ======= Konfigurační struktura =======
 struct MqttConfig {
@@ -13,6 +18,7 @@ struct MqttConfig {
   uint16_t keepalive = 60;
   bool    cleanSession = true;
   String  statusTopic, smsTopic, callerTopic, pubTopic;
+  String  inboxTopic;               // přijaté SMS (prázdné = nepublikovat)
 };
 
 extern MqttConfig   cfg;
@@ -26,9 +32,18 @@ void mqttModuleLoop();
 bool restartMqttConnection();
 
 // ======= Publikace Caller ID na MQTT =======
-void mqttPublishCaller(const String &caller);
+// Číslo jde na callerTopic beze změny; <callerTopic>/contact dostane
+// {"number","name","group"} z adresáře (null, když číslo není v adresáři)
+void mqttPublishCaller(const char* caller, const ContactInfo* contact = nullptr);
+
+// ======= Přijatá SMS na inboxTopic (false = plná fronta) =======
+struct SmsDeliver;
+bool mqttPublishSmsReceived(const SmsDeliver& msg);
+
+// ======= Definitivně neodeslaná SMS (dead-letter) na pubTopic =======
+void mqttPublishSmsFailed(uint32_t id, const char* recipient, int error, uint8_t attempts);
 
 // ======= HTTP API pro konfiguraci =======
 void handleGetMqttConfig(EthernetClient &client);
-void handlePostMqttConfig(EthernetClient &client, const String &body);
-void handleMqttTest(EthernetClient &client, const String &body);
+void handlePostMqttConfig(EthernetClient &client, const char* body);
+void handleMqttTest(EthernetClient &client, const char* body);
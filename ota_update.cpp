@@ -16,53 +16,41 @@ static const char* otaPage = R"rawliteral(
 )rawliteral";
 
 // čte řádek (LF-terminated)
-static String readLine(EthernetClient &c) {
-  return c.readStringUntil('\n');
+static String readLine(HttpBodyStream &in) {
+  return in.readStringUntil('\n');
 }
 
 void otaInit() {
   // žádná speciální inicializace
 }
 
-bool otaHandle(EthernetClient &client, const String& method, const String& path) {  
-  if (path != "/ota") return false;
+void otaHandle(HttpRequest& req, HttpBodyStream& in) {
+  EthernetClient& client = req.client;
 
   // GET → formulář
-  if (method == "GET") {
+  if (req.method == HTTP_METHOD_GET) {
     client.print(
       "HTTP/1.1 200 OK\r\n"
       "Content-Type: text/html; charset=utf-8\r\n"
       "Connection: close\r\n\r\n"
     );
     client.print(otaPage);
-    delay(1);
-    client.stop();
-    return true;
+    return;
   }
 
   // POST → multipart parsování
-  // 1) načti hlavičky až po prázdný řádek
-  String line;
-  int contentLength = 0;
+  // 1) hlavičky už rozebral http_server
+  int contentLength = req.contentLength;
   String boundary;
-  while (client.connected()) {
-    line = readLine(client);
-    if (line.startsWith("Content-Length:")) {
-      contentLength = line.substring(15).toInt();
-    }
-    else if (line.startsWith("Content-Type: multipart/form-data")) {
-      int b = line.indexOf("boundary=");
-      if (b != -1) {
-        boundary = "--" + line.substring(b + 9);
-        boundary.trim();
-      }
-    }
-    if (line == "\r" || line == "") break;
+  const char* b = strstr(req.contentType, "boundary=");
+  if (!strncmp(req.contentType, "multipart/form-data", 19) && b) {
+    boundary = "--";
+    boundary += b + 9;
+    boundary.trim();
   }
   if (boundary.isEmpty() || contentLength <= 0) {
     client.print("HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\nChybí boundary nebo Content-Length");
-    client.stop();
-    return true;
+    return;
   }
 
   // 2) projdi části
@@ -74,13 +62,13 @@ bool otaHandle(EthernetClient &client, const String& method, const String& path)
   uint8_t buf[bufSize];
 
   while (!otaDone && toRead > 0) {
-    String hdr = readLine(client);
+    String hdr = readLine(in);
     toRead -= hdr.length() + 1;
     if (!hdr.startsWith(boundary)) continue;
     if (hdr.endsWith("--")) break; // konec multipart
 
     // Content-Disposition
-    String disp = readLine(client);
+    String disp = readLine(in);
     toRead -= disp.length() + 1;
     int fn = disp.indexOf("filename=\"");
     if (fn == -1) break;
@@ -89,7 +77,7 @@ bool otaHandle(EthernetClient &client, const String& method, const String& path)
 
     // skip zbylé hlavičky části
     while (true) {
-      String l2 = readLine(client);
+      String l2 = readLine(in);
       toRead -= l2.length() + 1;
       if (l2 == "\r" || l2 == "") break;
     }
@@ -99,12 +87,12 @@ bool otaHandle(EthernetClient &client, const String& method, const String& path)
       if (!Update.begin(UPDATE_SIZE_UNKNOWN)) {
         client.print("HTTP/1.1 500 Internal Server Error\r\nConnection: close\r\n\r\nOTA begin failed");
         client.stop();
-        return true;
+        return;
       }
       mode = OTA;
       // čti firmware data
       while (toRead > 0) {
-        int r = client.read(buf, min(bufSize, toRead));
+        int r = in.read(buf, min(bufSize, toRead));
         if (r <= 0) break;
         toRead -= r;
         // boundary check
@@ -123,16 +111,16 @@ bool otaHandle(EthernetClient &client, const String& method, const String& path)
       if (!f) {
         client.print("HTTP/1.1 500 Internal Server Error\r\nConnection: close\r\n\r\nNelze otevřít " + filename);
         client.stop();
-        return true;
+        return;
       }
       mode = FS;
       bool fsDone = false;
       // čti dokud nejsi na další boundary
-      while (!fsDone && client.connected()) {
+      while (!fsDone && in.connected()) {
         unsigned long start = millis();
-        while (!client.available() && (millis() - start < 1000)) { /* timeout */ }
-        if (!client.available()) break;
-        int len = client.read(buf, bufSize);
+        while (!in.available() && (millis() - start < 1000)) { /* timeout */ }
+        if (!in.available()) break;
+        int len = in.read(buf, bufSize);
         if (len <= 0) break;
         String chk((char*)buf, min((int)boundary.length(), len));
         if (chk.startsWith(boundary)) {
@@ -157,10 +145,10 @@ bool otaHandle(EthernetClient &client, const String& method, const String& path)
       client.print("HTTP/1.1 500 Internal Server Error\r\nConnection: close\r\n\r\nOTA failed");
     }
     client.stop();
-    return true;
+    return;
   }
 
+  httpLoadAssetIndex();   // mohl přijít nový assets.etag / .gz
   client.print("HTTP/1.1 200 OK\r\nConnection: close\r\n\r\nUpload FS OK");
   client.stop();
-  return true;
 }
@@ -2,10 +2,12 @@
 #pragma once
 #include <Arduino.h>
 #include <Ethernet.h>
+#include "http_server.h"
 
 // inicializace (stávající)
 void otaInit();
 
-// hlavní handler pro /ota (FW i FS upload)
-bool otaHandle(EthernetClient &client, const String& method, const String& path);
+// stream routa GET/POST /ota (FW i FS upload); hlavičky už načetl
+// http_server, tělo se čte průběžně z `body`
+void otaHandle(HttpRequest& req, HttpBodyStream& body);
 
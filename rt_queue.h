@@ -0,0 +1,127 @@
+// rt_queue.h – bezzámkové předávání dat mezi úlohami (modem / síť / MQTT)
+//
+// SpscRing:    ohraničená fronta pro právě jednoho producenta a jednoho
+//              konzumenta (každý směr má vlastní instanci).
+// SeqSnapshot: poslední stav publikovaný jednou úlohou, čtený kýmkoli
+//              (seqlock – čtenář při souběhu se zápisem čte znovu).
+// RtSpinLock:  krátká kritická sekce pro sdílené tabulky (jen pár
+//              instrukcí, nikdy kolem alokace nebo I/O).
+//
+// Vše funguje stejně na ESP32 (FreeRTOS) i v hostitelském buildu (pthreads).
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+#if defined(ARDUINO_ARCH_ESP32)
+  #include <freertos/FreeRTOS.h>
+#endif
+
+template <typename T, size_t N>
+class SpscRing {
+  static_assert((N & (N - 1)) == 0, "SpscRing: N musí být mocnina 2");
+  static_assert(std::is_trivially_copyable<T>::value, "SpscRing: T musí být POD");
+
+public:
+  // Producent
+  bool push(const T& v) {
+    uint32_t t = tail_.load(std::memory_order_relaxed);
+    if (t - head_.load(std::memory_order_acquire) >= N) return false;
+    buf_[t & (N - 1)] = v;
+    tail_.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Konzument: náhled na nejstarší prvek bez vyjmutí (nullptr = prázdno)
+  const T* front() const {
+    uint32_t h = head_.load(std::memory_order_relaxed);
+    if (h == tail_.load(std::memory_order_acquire)) return nullptr;
+    return &buf_[h & (N - 1)];
+  }
+
+  void popFront() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  bool pop(T& out) {
+    const T* p = front();
+    if (!p) return false;
+    out = *p;
+    popFront();
+    return true;
+  }
+
+  size_t size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+private:
+  T buf_[N];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+};
+
+template <typename T>
+class SeqSnapshot {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqSnapshot: T musí být POD");
+
+public:
+  // Jediný zapisovatel (vlastník stavu)
+  void publish(const T& v) {
+    uint32_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&data_, &v, sizeof(T));
+    seq_.store(s + 2, std::memory_order_release);
+  }
+
+  // Libovolný počet čtenářů; kopie je vždy konzistentní
+  T read() const {
+    T out;
+    uint32_t s1, s2;
+    do {
+      s1 = seq_.load(std::memory_order_acquire);
+      memcpy(&out, &data_, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      s2 = seq_.load(std::memory_order_relaxed);
+    } while ((s1 & 1) || s1 != s2);
+    return out;
+  }
+
+private:
+  T data_{};
+  std::atomic<uint32_t> seq_{0};
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+class RtSpinLock {
+public:
+  void lock()   { portENTER_CRITICAL(&mux_); }
+  void unlock() { portEXIT_CRITICAL(&mux_); }
+private:
+  portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+};
+#else
+class RtSpinLock {
+public:
+  void lock()   { while (flag_.test_and_set(std::memory_order_acquire)) {} }
+  void unlock() { flag_.clear(std::memory_order_release); }
+private:
+  std::atomic_flag flag_ = ATOMIC_FLAG_INIT;
+};
+#endif
+
+class RtLockGuard {
+public:
+  explicit RtLockGuard(RtSpinLock& l) : l_(l) { l_.lock(); }
+  ~RtLockGuard() { l_.unlock(); }
+  RtLockGuard(const RtLockGuard&) = delete;
+  RtLockGuard& operator=(const RtLockGuard&) = delete;
+private:
+  RtSpinLock& l_;
+};
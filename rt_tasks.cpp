@@ -0,0 +1,137 @@
+// rt_tasks.cpp – úlohy modem / síť / MQTT
+#include "rt_tasks.h"
+#include "gsm_modem.h"
+#include "mqtt_module.h"
+#include "webserver.h"
+#include "ntp_sync.h"
+#include "sms_inbox.h"
+#include "sms_scheduler.h"
+#include "sms_bulk.h"
+#include "call_log.h"
+#include "metrics.h"
+#include "log.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
+  #include <freertos/semphr.h>
+#else
+  #include <thread>
+  #include <mutex>
+  #include <chrono>
+#endif
+
+// ====== Jeden průchod subsystémem ======
+// Měřené bloky viz metrics.h (/api/metrics)
+void modemStep() {
+  { MetricScope m(metricsTimer(MT_MODEM_URC));
+    handleModemURC(); }   // UART → AT engine / URC handlery
+  modemStatusLoop();      // Telemetrie modemu na pozadí (CSQ/COPS/CREG/CGATT)
+  { MetricScope m(metricsTimer(MT_SMS_QUEUE));
+    processSmsQueue(); }  // Fronta SMS (příjem úloh z HTTP/MQTT front)
+  smsInboxLoop();         // Rotace logu přijatých SMS, statistika
+}
+
+void networkStep() {
+  ntpIsSynced();
+  { MetricScope m(metricsTimer(MT_NETWORK_LOOP));
+    networkLoop(); }      // Webserver (HTTP API a statické soubory)
+  smsSchedulerLoop();     // Plánované SMS (jen vrchol haldy)
+  smsBulkLoop();          // Hromadné SMS (po SMS_BULK_STEP kontaktech)
+  callLogLoop();          // Log volání z modemové úlohy → /call_log.jsonl
+}
+
+void mqttStep() {
+  MetricScope m(metricsTimer(MT_MQTT_LOOP));
+  mqttModuleLoop();       // MQTT klient (příjem/publikace zpráv, reconnecty)
+}
+
+void logStep() {
+  logDrain();
+}
+
+// ====== Platformní vrstva ======
+#if defined(ARDUINO_ARCH_ESP32)
+
+static SemaphoreHandle_t ethMutex = nullptr;
+
+void ethLock()   { xSemaphoreTakeRecursive(ethMutex, portMAX_DELAY); }
+void ethUnlock() { xSemaphoreGiveRecursive(ethMutex); }
+
+// Spí do události UART (řádek, prompt), nejdéle MODEM_TASK_IDLE_MS
+static void modemTask(void*) {
+  for (;;) {
+    modemStep();
+    modemWaitRx(MODEM_TASK_IDLE_MS);
+  }
+}
+
+static void networkTask(void*) {
+  for (;;) {
+    ethLock();
+    networkStep();
+    ethUnlock();
+    vTaskDelay(1);
+  }
+}
+
+static void mqttTask(void*) {
+  for (;;) {
+    ethLock();
+    mqttStep();
+    ethUnlock();
+    vTaskDelay(1);
+  }
+}
+
+static void logTask(void*) {
+  for (;;) {
+    logStep();
+    vTaskDelay(pdMS_TO_TICKS(LOG_TASK_PERIOD_MS));
+  }
+}
+
+void tasksStart() {
+#if GSM_USE_TASKS
+  ethMutex = xSemaphoreCreateRecursiveMutex();
+  xTaskCreatePinnedToCore(modemTask,   "modem", MODEM_TASK_STACK, nullptr, MODEM_TASK_PRIO, nullptr, MODEM_TASK_CORE);
+  xTaskCreatePinnedToCore(networkTask, "net",   NET_TASK_STACK,   nullptr, NET_TASK_PRIO,   nullptr, NET_TASK_CORE);
+  xTaskCreatePinnedToCore(mqttTask,    "mqtt",  MQTT_TASK_STACK,  nullptr, MQTT_TASK_PRIO,  nullptr, MQTT_TASK_CORE);
+  xTaskCreatePinnedToCore(logTask,     "log",   LOG_TASK_STACK,   nullptr, LOG_TASK_PRIO,   nullptr, LOG_TASK_CORE);
+#endif
+}
+
+#else  // hostitelský build (tests/): stejné úlohy jako pthready
+
+static std::recursive_mutex ethMutex;
+
+void ethLock()   { ethMutex.lock(); }
+void ethUnlock() { ethMutex.unlock(); }
+
+// Jako na ESP32: spí do události UART (poll na pty), nejdéle MODEM_TASK_IDLE_MS
+static void modemTask() {
+  for (;;) {
+    modemStep();
+    modemWaitRx(MODEM_TASK_IDLE_MS);
+  }
+}
+
+static void runForever(void (*step)(), bool needsEth, int periodMs) {
+  for (;;) {
+    if (needsEth) ethLock();
+    step();
+    if (needsEth) ethUnlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(periodMs));
+  }
+}
+
+void tasksStart() {
+#if GSM_USE_TASKS
+  std::thread(modemTask).detach();
+  std::thread(runForever, networkStep, true,  1).detach();
+  std::thread(runForever, mqttStep,    true,  1).detach();
+  std::thread(runForever, logStep,     false, LOG_TASK_PERIOD_MS).detach();
+#endif
+}
+
+#endif
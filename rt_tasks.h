@@ -0,0 +1,73 @@
+// rt_tasks.h – běhové prostředí: modem, síť a MQTT ve vlastních úlohách
+//
+// Každý subsystém má jednu "step" funkci (jeden průchod neblokující
+// smyčkou). S GSM_USE_TASKS je tasksStart() spustí ve FreeRTOS úlohách
+// připnutých na zvolená jádra (na hostiteli jako pthready), bez něj je
+// volá klasicky loop(). Data mezi úlohami tečou jen přes rt_queue.h.
+
+#pragma once
+#include <Arduino.h>
+
+#ifndef GSM_USE_TASKS
+  #define GSM_USE_TASKS 1
+#endif
+
+// ======= Rozložení úloh (lze přepsat přes -D) =======
+#ifndef MODEM_TASK_CORE
+  #define MODEM_TASK_CORE   0     // UART modemu na jádře 0 (s Wi-Fi/BT stackem nepoužíváme)
+#endif
+#ifndef NET_TASK_CORE
+  #define NET_TASK_CORE     1     // HTTP + NTP
+#endif
+#ifndef MQTT_TASK_CORE
+  #define MQTT_TASK_CORE    1
+#endif
+#ifndef MODEM_TASK_PRIO
+  #define MODEM_TASK_PRIO   3
+#endif
+#ifndef NET_TASK_PRIO
+  #define NET_TASK_PRIO     2
+#endif
+#ifndef MQTT_TASK_PRIO
+  #define MQTT_TASK_PRIO    2
+#endif
+#ifndef MODEM_TASK_IDLE_MS
+  #define MODEM_TASK_IDLE_MS 10   // nejdelší spánek bez dat z UART (limity AT, fronta SMS)
+#endif
+#ifndef MODEM_TASK_STACK
+  #define MODEM_TASK_STACK  6144
+#endif
+#ifndef NET_TASK_STACK
+  #define NET_TASK_STACK    8192
+#endif
+#ifndef MQTT_TASK_STACK
+  #define MQTT_TASK_STACK   6144
+#endif
+#ifndef LOG_TASK_CORE
+  #define LOG_TASK_CORE     1
+#endif
+#ifndef LOG_TASK_PRIO
+  #define LOG_TASK_PRIO     1     // pod ostatními: Serial dostane jen zbytek času
+#endif
+#ifndef LOG_TASK_STACK
+  #define LOG_TASK_STACK    2048
+#endif
+#ifndef LOG_TASK_PERIOD_MS
+  #define LOG_TASK_PERIOD_MS 10
+#endif
+
+// ======= Jeden průchod subsystémem =======
+void modemStep();     // URC, AT engine, telemetrie, fronta SMS (vlastní UART)
+void networkStep();   // NTP + HTTP server
+void mqttStep();      // MQTT klient + odchozí události z modemu
+void logStep();       // log.h: čekající řádky na Serial (neblokuje)
+
+// ======= Spuštění =======
+void tasksStart();    // bez GSM_USE_TASKS nedělá nic
+
+// ======= Sdílený W5500 =======
+// HTTP i MQTT jdou přes jeden SPI čip a knihovna Ethernet není
+// reentrantní; každý průchod networkStep()/mqttStep() drží tento zámek.
+// Tím je chráněn i mqttClient, když ho volají HTTP handlery.
+void ethLock();
+void ethUnlock();
@@ -27,11 +27,14 @@ void loadSettings() {
     settings.smsTimeout       = 15000;
     settings.cmdInterval      = 200;
     settings.maxRingCount     = 1;
+    settings.modemPollInterval = 30000;
+    settings.smsMaxAttempts    = 4;
+    settings.smsRetryBaseMs    = 10000;
     return;
   }
 
   File f = LittleFS.open(SETTINGS_PATH, "r");
-  StaticJsonDocument<512> doc;
+  StaticJsonDocument<768> doc;
   if (deserializeJson(doc, f) == DeserializationError::Ok) {
     settings.ntpServer        = doc["ntpServer"]        | settings.ntpServer;
     settings.ntpPort          = doc["ntpPort"]          | settings.ntpPort;
@@ -46,6 +49,9 @@ void loadSettings() {
     settings.smsTimeout       = doc["smsTimeout"]       | settings.smsTimeout;
     settings.cmdInterval      = doc["cmdInterval"]      | settings.cmdInterval;
     settings.maxRingCount     = doc["maxRingCount"]     | settings.maxRingCount;
+    settings.modemPollInterval = doc["modemPollInterval"] | settings.modemPollInterval;
+    settings.smsMaxAttempts    = doc["smsMaxAttempts"]    | settings.smsMaxAttempts;
+    settings.smsRetryBaseMs    = doc["smsRetryBaseMs"]    | settings.smsRetryBaseMs;
   }
   f.close();
 }
@@ -55,7 +61,7 @@ bool saveSettings() {
   File f = LittleFS.open(SETTINGS_PATH, "w");
   if (!f) return false;
 
-  StaticJsonDocument<512> doc;
+  StaticJsonDocument<768> doc;
   doc["ntpServer"]        = settings.ntpServer;
   doc["ntpPort"]          = settings.ntpPort;
   doc["localPort"]        = settings.localPort;
@@ -69,6 +75,9 @@ bool saveSettings() {
   doc["smsTimeout"]       = settings.smsTimeout;
   doc["cmdInterval"]      = settings.cmdInterval;
   doc["maxRingCount"]     = settings.maxRingCount;
+  doc["modemPollInterval"] = settings.modemPollInterval;
+  doc["smsMaxAttempts"]    = settings.smsMaxAttempts;
+  doc["smsRetryBaseMs"]    = settings.smsRetryBaseMs;
 
   size_t written = serializeJson(doc, f);
   f.close();
@@ -86,10 +95,8 @@ void applySettings() {
   // 3) Sériová linka
   Serial.begin(settings.baudRate);
 
-  // 4) GSM modem
-  sendAtCommand("AT+CTZU="  + String(settings.atctzu ? 1 : 0), "OK");
-  sendAtCommand("AT+CTZR="  + String(settings.atctr  ? 1 : 0), "OK");
-  sendAtCommand("AT+CLIP=" + String(settings.atclip ? 1 : 0), "OK");
+  // 4) GSM modem (AT příkazy odešle modemová úloha)
+  modemRequestReconfigure();
 
   // 5) Ring count
   saveRingSetting(settings.maxRingCount);
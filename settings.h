@@ -19,6 +19,9 @@ struct Settings {
   uint32_t smsTimeout;
   uint32_t cmdInterval;
   uint8_t  maxRingCount;
+  uint32_t modemPollInterval = 30000;  // obnova CSQ/COPS/CREG/CGATT [ms], 0 = vypnuto
+  uint8_t  smsMaxAttempts    = 4;      // pokusů na SMS včetně prvního
+  uint32_t smsRetryBaseMs    = 10000;  // první prodleva, dál se zdvojuje
 };
 
 extern Settings settings;
@@ -15,6 +15,7 @@
 #include "webserver.h"
 #include "ntp_sync.h"
 #include "settings.h"
+#include "rt_tasks.h"
 
 void setup() {
   Serial.begin(9600);
@@ -26,13 +27,17 @@ void setup() {
   modemInit();
   setupDTR();
   mqttModuleInit();
+  tasksStart();      // modem / síť / MQTT do vlastních úloh
 }
 
 
 void loop() {
-  ntpIsSynced();
-  networkLoop();          // Webserver (HTTP API a statické soubory)
-  mqttModuleLoop();       // MQTT klient (příjem/publikace zpráv, reconnecty)
-  handleModemURC();
-  processSmsQueue();      // Zpracování příchozích SMS a fronty pro GSM
+#if GSM_USE_TASKS
+  vTaskDelay(portMAX_DELAY);   // vše běží ve vlastních úlohách (rt_tasks.cpp)
+#else
+  networkStep();          // NTP + webserver (HTTP API a statické soubory)
+  mqttStep();             // MQTT klient (příjem/publikace zpráv, reconnecty)
+  modemStep();            // URC, telemetrie a fronta SMS pro GSM
+  logStep();              // odložený log na Serial
+#endif
 }
@@ -0,0 +1,279 @@
+// sms_bulk.cpp – rozvinutí skupin a šablon do fronty SMS po kontaktech
+#include "sms_bulk.h"
+#include "sms_queue.h"
+#include "contact_store.h"
+#include <LittleFS.h>
+
+#define LOG_TAG "BULK"
+#include "log.h"
+
+static const char* const CONTACT_FIELDS[] = { "name", "phone", "email", "group" };
+
+// ====== Stav dávky ======
+static SmsBulkStatus st = {};
+static char     groups[SMS_BULK_GROUPS][SMS_BULK_GROUP_LEN];
+static uint8_t  groupCount = 0;           // 0 = všechny kontakty
+static char     tmpl[SMS_TEXT_MAX];
+static StaticJsonDocument<384> vars;      // kopie "vars" z požadavku
+static uint32_t fileSize   = 0;           // změna /contacts.json = konec dávky
+static uint32_t offset     = 0;           // za posledním zpracovaným kontaktem
+static bool     firstElem  = true;
+static uint32_t retryAt    = 0;
+
+// vyrenderovaná SMS, na kterou ještě nebylo místo ve frontě
+static bool     pending = false;
+static char     pendingNumber[SMS_NUMBER_MAX];
+static char     pendingText[SMS_TEXT_MAX];
+
+static uint32_t seen[SMS_BULK_DEDUP];     // hashe čísel, 0 = volno
+static uint16_t seenCount = 0;
+
+static StaticJsonDocument<192> contact;
+static StaticJsonDocument<64>  contactFilter;
+
+// ====== Kontakty (JSON pole čtené po prvcích) ======
+static bool contactNext(File& f, bool first) {
+  if (!f.find(first ? "[" : ",")) return false;
+  return deserializeJson(contact, f, DeserializationOption::Filter(contactFilter)) == DeserializationError::Ok;
+}
+
+static bool contactMatches() {
+  if (groupCount == 0) return true;
+  const char* g = contact["group"] | "";
+  for (uint8_t i = 0; i < groupCount; ++i) {
+    if (strcasecmp(g, groups[i]) == 0) return true;
+  }
+  return false;
+}
+
+// Číslo v E.164 do `out` (stejný zápis jako index adresáře, takže
+// "777 123 456" a "+420777123456" jsou pro duplicity totéž)
+static bool normalizeNumber(const char* in, char* out) {
+  return contactNormalize(in, out, SMS_NUMBER_MAX) && strlen(out) >= 6;
+}
+
+// FNV-1a do otevřené tabulky; false = číslo už v dávce je
+static bool markSeen(const char* number) {
+  uint32_t h = 2166136261u;
+  for (const char* p = number; *p; ++p) h = (h ^ (uint8_t)*p) * 16777619u;
+  if (h == 0) h = 1;
+  if (seenCount >= SMS_BULK_DEDUP - 1) return true;      // plno: bez kontroly
+  for (uint32_t i = h & (SMS_BULK_DEDUP - 1); ; i = (i + 1) & (SMS_BULK_DEDUP - 1)) {
+    if (seen[i] == h) return false;
+    if (seen[i] == 0) { seen[i] = h; seenCount++; return true; }
+  }
+}
+
+static void resetSeen() {
+  memset(seen, 0, sizeof(seen));
+  seenCount = 0;
+}
+
+// ====== Šablona ======
+static bool isContactField(const char* key) {
+  for (const char* f : CONTACT_FIELDS) {
+    if (strcmp(key, f) == 0) return true;
+  }
+  return false;
+}
+
+// Další {{klíč}} od `p`; klíč (oříznutý) do `key`, vrací konec "}}"
+static const char* nextPlaceholder(const char* p, const char*& start, char* key, size_t cap) {
+  for (;;) {
+    start = strstr(p, "{{");
+    if (!start) return nullptr;
+    const char* end = strstr(start + 2, "}}");
+    if (!end) return nullptr;
+    const char* k = start + 2;
+    while (k < end && *k == ' ') k++;
+    const char* e = end;
+    while (e > k && e[-1] == ' ') e--;
+    size_t len = e - k;
+    if (len > 0 && len < cap) {
+      memcpy(key, k, len);
+      key[len] = '\0';
+      return end + 2;
+    }
+    p = end + 2;                          // prázdné / dlouhé {{…}} zůstane textem
+  }
+}
+
+static const char* lookup(const char* key) {
+  if (isContactField(key)) return contact[key] | "";
+  return vars[key] | (const char*)nullptr;
+}
+
+// Dosazení do `out`; false = výsledek by překročil SMS_TEXT_MAX
+static bool render(char* out) {
+  size_t n = 0;
+  const char* p = tmpl;
+  const char* start;
+  char key[SMS_BULK_GROUP_LEN];
+  auto append = [&](const char* s, size_t len) {
+    if (n + len >= SMS_TEXT_MAX) return false;
+    memcpy(out + n, s, len);
+    n += len;
+    return true;
+  };
+  while (const char* next = nextPlaceholder(p, start, key, sizeof(key))) {
+    const char* val = lookup(key);
+    if (!append(p, start - p) || !append(val ? val : "", val ? strlen(val) : 0)) return false;
+    p = next;
+  }
+  if (!append(p, strlen(p))) return false;
+  out[n] = '\0';
+  return n > 0;
+}
+
+static bool loadTemplate(uint32_t id) {
+  File f = LittleFS.open(SMS_TEMPLATES_PATH, "r");
+  if (!f) return false;
+  StaticJsonDocument<32> filter;
+  filter["id"] = true; filter["content"] = true;
+  StaticJsonDocument<SMS_TEXT_MAX + 64> t;
+  bool found = false;
+  for (bool first = true; f.find(first ? "[" : ","); first = false) {
+    if (deserializeJson(t, f, DeserializationOption::Filter(filter))) break;
+    if ((t["id"] | 0u) != id) continue;
+    strlcpy(tmpl, t["content"] | "", sizeof(tmpl));
+    found = true;
+    break;
+  }
+  f.close();
+  return found;
+}
+
+// ====== API ======
+SmsBulkResult smsBulkStart(JsonVariantConst req, char* detail, size_t cap) {
+  if (st.active) return SMS_BULK_BUSY;
+
+  groupCount = 0;
+  if (!(req["all"] | false)) {
+    JsonArrayConst g = req["groups"];
+    if (g.isNull() || g.size() == 0 || g.size() > SMS_BULK_GROUPS) return SMS_BULK_BAD_REQUEST;
+    for (JsonVariantConst v : g) strlcpy(groups[groupCount++], v | "", SMS_BULK_GROUP_LEN);
+  }
+
+  if (req.containsKey("template")) {
+    if (!loadTemplate(req["template"] | 0u)) return SMS_BULK_NO_TEMPLATE;
+  } else {
+    strlcpy(tmpl, req["message"] | "", sizeof(tmpl));
+  }
+  if (!*tmpl) return SMS_BULK_BAD_REQUEST;
+
+  vars.clear();
+  if (!vars.set(req["vars"]) && !req["vars"].isNull()) return SMS_BULK_BAD_REQUEST;
+
+  // každá proměnná šablony musí mít odkud se vzít
+  const char* start;
+  char key[SMS_BULK_GROUP_LEN];
+  for (const char* p = tmpl; (p = nextPlaceholder(p, start, key, sizeof(key))); ) {
+    if (!isContactField(key) && vars[key].isNull()) {
+      strlcpy(detail, key, cap);
+      return SMS_BULK_MISSING_VAR;
+    }
+  }
+
+  contactFilter.clear();
+  for (const char* f : CONTACT_FIELDS) contactFilter[f] = true;
+
+  // první průchod jen spočítá příjemce (bez duplicit; total = queued + failed)
+  File f = LittleFS.open(SMS_CONTACTS_PATH, "r");
+  if (!f) return SMS_BULK_NO_RECIPIENTS;
+  uint16_t total = 0;
+  char number[SMS_NUMBER_MAX];
+  resetSeen();
+  for (bool first = true; contactNext(f, first); first = false) {
+    if (!contactMatches()) continue;
+    if (!normalizeNumber(contact["phone"] | "", number) || markSeen(number)) total++;
+  }
+  fileSize = f.size();
+  f.close();
+  if (total == 0) return SMS_BULK_NO_RECIPIENTS;
+
+  uint32_t id = st.id + 1;
+  st = {};
+  st.id     = id;
+  st.active = true;
+  st.total  = total;
+  offset    = 0;
+  firstElem = true;
+  pending   = false;
+  retryAt   = millis();
+  resetSeen();
+  return SMS_BULK_OK;
+}
+
+static void finish(const char* error) {
+  st.active = false;
+  st.error  = error;
+  pending   = false;
+  LOG_I("#%u: %u ve frontě, %u chyb, %u duplicit%s%s",
+        (unsigned)st.id, st.queued, st.failed, st.duplicates,
+        error ? " – " : "", error ? error : "");
+}
+
+static bool submitPending() {
+  uint32_t id = smsJobSubmit(pendingNumber, pendingText, SMS_SRC_HTTP);
+  if (!id) {                                 // tabulka úloh / pool textů plné
+    retryAt = millis() + SMS_BULK_RETRY_MS;
+    return false;
+  }
+  if (!st.firstJobId) st.firstJobId = id;
+  st.lastJobId = id;
+  st.queued++;
+  pending = false;
+  return true;
+}
+
+void smsBulkLoop() {
+  if (!st.active || (int32_t)(millis() - retryAt) < 0) return;
+  if (pending && !submitPending()) return;
+
+  File f = LittleFS.open(SMS_CONTACTS_PATH, "r");
+  if (!f || f.size() != fileSize) {
+    if (f) f.close();
+    finish("contacts changed");
+    return;
+  }
+  f.seek(offset);
+  for (uint8_t n = 0; n < SMS_BULK_STEP; ++n) {
+    if (!contactNext(f, firstElem)) {
+      f.close();
+      finish(nullptr);
+      return;
+    }
+    firstElem = false;
+    offset    = f.position();
+    if (!contactMatches()) continue;
+
+    if (!normalizeNumber(contact["phone"] | "", pendingNumber)) { st.failed++; continue; }
+    if (!markSeen(pendingNumber))                               { st.duplicates++; continue; }
+    if (!render(pendingText))                                   { st.failed++; continue; }
+    pending = true;
+    if (!submitPending()) break;
+  }
+  f.close();
+}
+
+bool smsBulkCancel() {
+  if (!st.active) return false;
+  finish("cancelled");
+  return true;
+}
+
+SmsBulkStatus smsBulkStatus() {
+  return st;
+}
+
+const char* smsBulkResultString(SmsBulkResult r) {
+  switch (r) {
+    case SMS_BULK_OK:            return "ok";
+    case SMS_BULK_BUSY:          return "another bulk send is running";
+    case SMS_BULK_BAD_REQUEST:   return "groups (or all) and template or message required";
+    case SMS_BULK_NO_TEMPLATE:   return "unknown template";
+    case SMS_BULK_MISSING_VAR:   return "missing variable";
+    case SMS_BULK_NO_RECIPIENTS: return "no contacts in the selected groups";
+  }
+  return "error";
+}
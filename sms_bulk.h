@@ -0,0 +1,56 @@
+// sms_bulk.h – hromadné SMS podle skupin kontaktů a šablon
+//
+// Požadavek nese jen názvy skupin, ID šablony (nebo text) a proměnné;
+// příjemce i text pro každého z nich sestaví zařízení. /contacts.json
+// se čte po jednom kontaktu (malý filtrovaný dokument), {{klíč}} se
+// nahradí polem kontaktu (name, phone, email, group) nebo hodnotou
+// z "vars". Do fronty se úlohy zakládají postupně z smsBulkLoop(): když
+// je plná tabulka úloh nebo pool textů, pokračuje se od stejného
+// kontaktu v dalším průchodu, takže velká skupina se nezahodí.
+//
+// Jen ze síťové úlohy (producent SMS_SRC_HTTP); běží jedna dávka naráz.
+
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#ifndef SMS_BULK_GROUPS
+  #define SMS_BULK_GROUPS     8      // skupin v jednom požadavku
+#endif
+#ifndef SMS_BULK_DEDUP
+  #define SMS_BULK_DEDUP      512    // mocnina 2; čísel hlídaných proti duplicitě
+#endif
+#define SMS_BULK_GROUP_LEN    32
+#define SMS_BULK_STEP         8      // kontaktů na jeden průchod smyčkou
+#define SMS_BULK_RETRY_MS     500    // pauza, když je fronta plná
+#define SMS_CONTACTS_PATH     "/contacts.json"
+#define SMS_TEMPLATES_PATH    "/sms_templates.json"
+
+enum SmsBulkResult : uint8_t {
+  SMS_BULK_OK,
+  SMS_BULK_BUSY,            // jiná dávka ještě běží
+  SMS_BULK_BAD_REQUEST,     // chybí skupiny / text, moc skupin
+  SMS_BULK_NO_TEMPLATE,     // neznámé ID šablony
+  SMS_BULK_MISSING_VAR,     // {{klíč}} není pole kontaktu ani ve "vars"
+  SMS_BULK_NO_RECIPIENTS    // skupinám neodpovídá žádný kontakt
+};
+
+struct SmsBulkStatus {
+  uint32_t id;              // 0 = zatím žádná dávka
+  bool     active;
+  uint16_t total;           // unikátních příjemců
+  uint16_t queued;
+  uint16_t failed;          // neplatné číslo / text po dosazení moc dlouhý
+  uint16_t duplicates;
+  uint32_t firstJobId;      // rozsah ID úloh ve frontě (viz /api/sms-status)
+  uint32_t lastJobId;
+  const char* error;        // důvod předčasného ukončení, jinak nullptr
+};
+
+// {"groups":[...] | "all":true, "template":ID | "message":"...", "vars":{...}}
+// `detail` dostane název chybějící proměnné (SMS_BULK_MISSING_VAR)
+SmsBulkResult smsBulkStart(JsonVariantConst req, char* detail, size_t cap);
+void          smsBulkLoop();
+bool          smsBulkCancel();
+SmsBulkStatus smsBulkStatus();
+const char*   smsBulkResultString(SmsBulkResult r);
@@ -0,0 +1,269 @@
+// sms_history.cpp – append-only log odeslaných SMS se segmenty
+#include "sms_history.h"
+#include "gsm_modem.h"        // getSmsHistoryMaxCount()
+#include "sms_queue.h"        // SMS_NUMBER_MAX
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <time.h>
+
+static const char* HIST_PATH   = "/sms_history.log";
+static const char* HIST_SEALED = "/sms_history.1.log";
+static const char* HIST_TMP    = "/sms_history.tmp";
+static const char* HIST_LEGACY = "/sms_history.json";
+
+static constexpr uint8_t  REC_MAGIC    = 0xA5;
+static constexpr uint32_t FOOTER_MAGIC = 0x31464853;   // "SHF1"
+static constexpr size_t   REC_MAX      = 1024;         // hlavička + JSON
+
+// ====== Formát ======
+// Záznam:  RecHdr + len bajtů JSON objektu
+// Patička: uint32 offset[n] + uint32 n + uint32 FOOTER_MAGIC
+// První bajt patičky je nízký bajt offsetu 0, tedy nikdy REC_MAGIC.
+struct __attribute__((packed)) RecHdr {
+  uint8_t  magic;
+  uint8_t  sum;          // součet bajtů JSON (mod 256)
+  uint16_t len;
+  uint32_t ts;           // epoch [s]
+};
+
+static uint8_t payloadSum(const uint8_t* p, size_t n) {
+  uint8_t s = 0;
+  while (n--) s += *p++;
+  return s;
+}
+
+// Projde záznamy od začátku; vrací počet platných, `end` = konec posledního
+static uint16_t scanSegment(File& f, uint32_t* idx, uint16_t cap, uint32_t& end) {
+  uint32_t size = f.size(), pos = 0;
+  uint16_t n = 0;
+  RecHdr h;
+  while (n < cap && pos + sizeof(h) <= size) {
+    f.seek(pos);
+    if (f.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || h.magic != REC_MAGIC) break;
+    if (pos + sizeof(h) + h.len > size) break;
+    idx[n++] = pos;
+    pos += sizeof(h) + h.len;
+  }
+  end = pos;
+  return n;
+}
+
+// Uzavřený segment: tabulka z patičky, bez patičky (výpadek při
+// uzavírání) záložně průchodem
+static uint16_t loadSealedIndex(File& f, uint32_t* idx, uint16_t cap) {
+  uint32_t size = f.size();
+  uint32_t tail[2];
+  if (size >= sizeof(tail)) {
+    f.seek(size - sizeof(tail));
+    if (f.read((uint8_t*)tail, sizeof(tail)) == sizeof(tail) && tail[1] == FOOTER_MAGIC &&
+        tail[0] <= cap && (uint64_t)tail[0] * 4 + sizeof(tail) <= size) {
+      f.seek(size - sizeof(tail) - tail[0] * 4);
+      if (f.read((uint8_t*)idx, tail[0] * 4) == (int)(tail[0] * 4)) return tail[0];
+    }
+  }
+  uint32_t end;
+  return scanSegment(f, idx, cap, end);
+}
+
+// ====== Zapisovatel (modemová úloha) ======
+static uint32_t activeIdx[SMS_HISTORY_SEG_MAX];
+static uint16_t activeCount = 0;
+static uint32_t activeSize  = 0;
+static uint8_t  recBuf[REC_MAX];
+
+static uint16_t segmentLimit() {
+  uint16_t n = getSmsHistoryMaxCount();
+  if (n == 0) n = 1;
+  return n > SMS_HISTORY_SEG_MAX ? SMS_HISTORY_SEG_MAX : n;
+}
+
+static void sealActive() {
+  File f = LittleFS.open(HIST_PATH, "a");
+  if (f) {
+    uint32_t tail[2] = { activeCount, FOOTER_MAGIC };
+    f.write((const uint8_t*)activeIdx, activeCount * 4);
+    f.write((const uint8_t*)tail, sizeof(tail));
+    f.close();
+  }
+  LittleFS.remove(HIST_SEALED);
+  LittleFS.rename(HIST_PATH, HIST_SEALED);
+  activeCount = 0;
+  activeSize  = 0;
+}
+
+static bool appendRecord(const JsonDocument& rec, uint32_t ts) {
+  size_t len = serializeJson(rec, (char*)recBuf + sizeof(RecHdr), REC_MAX - sizeof(RecHdr));
+  if (len == 0 || len >= REC_MAX - sizeof(RecHdr) - 1) return false;
+
+  if (activeCount >= segmentLimit()) sealActive();
+
+  RecHdr h = { REC_MAGIC, payloadSum(recBuf + sizeof(RecHdr), len), (uint16_t)len, ts };
+  memcpy(recBuf, &h, sizeof(h));
+  File f = LittleFS.open(HIST_PATH, "a");
+  if (!f) return false;
+  size_t w = f.write(recBuf, sizeof(h) + len);
+  f.close();
+  if (w != sizeof(h) + len) return false;
+
+  activeIdx[activeCount++] = activeSize;
+  activeSize += w;
+  return true;
+}
+
+bool smsHistoryAppend(const char* recipient, const char* message) {
+  StaticJsonDocument<128> rec;
+  uint32_t ts = time(nullptr);
+  rec["timestamp"] = ts;
+  rec["recipient"] = recipient;
+  rec["message"]   = message;
+  return appendRecord(rec, ts);
+}
+
+// Rozepsaný záznam na konci (výpadek napájení) by blokoval další append:
+// platné záznamy se přepíšou do nového souboru. Stane se jen po pádu.
+static void recoverActive() {
+  File f = LittleFS.open(HIST_PATH, "r");
+  if (!f) return;
+  uint32_t end;
+  activeCount = scanSegment(f, activeIdx, SMS_HISTORY_SEG_MAX, end);
+  activeSize  = end;
+  // záznamy s chybným součtem zahodíme
+  uint16_t valid = 0;
+  bool dirty = end != f.size();
+  for (uint16_t i = 0; i < activeCount; ++i) {
+    RecHdr h;
+    f.seek(activeIdx[i]);
+    f.read((uint8_t*)&h, sizeof(h));
+    if (h.len > REC_MAX - sizeof(h) ||
+        f.read(recBuf, h.len) != h.len || payloadSum(recBuf, h.len) != h.sum) {
+      dirty = true;
+      continue;
+    }
+    activeIdx[valid++] = activeIdx[i];
+  }
+  activeCount = valid;
+  if (!dirty) { f.close(); return; }
+
+  File out = LittleFS.open(HIST_TMP, "w");
+  uint32_t pos = 0;
+  for (uint16_t i = 0; out && i < activeCount; ++i) {
+    RecHdr h;
+    f.seek(activeIdx[i]);
+    f.read((uint8_t*)&h, sizeof(h));
+    f.read(recBuf, h.len);
+    out.write((const uint8_t*)&h, sizeof(h));
+    out.write(recBuf, h.len);
+    activeIdx[i] = pos;
+    pos += sizeof(h) + h.len;
+  }
+  f.close();
+  if (!out) { activeCount = 0; activeSize = 0; LittleFS.remove(HIST_PATH); return; }
+  out.close();
+  LittleFS.remove(HIST_PATH);
+  LittleFS.rename(HIST_TMP, HIST_PATH);
+  activeSize = pos;
+}
+
+// Starý formát: JSON pole od nejnovějšího záznamu, max. 4 KB
+static void importLegacy() {
+  static StaticJsonDocument<4096> old;
+  File f = LittleFS.open(HIST_LEGACY, "r");
+  if (!f) return;
+  DeserializationError err = deserializeJson(old, f);
+  f.close();
+  if (!err) {
+    JsonArray arr = old.as<JsonArray>();
+    for (size_t i = arr.size(); i-- > 0; ) {
+      JsonObject o = arr[i];
+      StaticJsonDocument<128> rec;
+      uint32_t ts = o["timestamp"] | 0;
+      rec["timestamp"] = ts;
+      rec["recipient"] = o["recipient"].as<const char*>();
+      rec["message"]   = o["message"].as<const char*>();
+      appendRecord(rec, ts);
+    }
+  }
+  old.clear();
+  LittleFS.remove(HIST_LEGACY);
+}
+
+void smsHistoryInit() {
+  recoverActive();
+  if (LittleFS.exists(HIST_LEGACY)) importLegacy();
+}
+
+// ====== Čtenář ======
+// Vlastní index, nezávislý na zapisovateli; segmenty se otevřou hned na
+// začátku, takže souběžná rotace čtení nerozbije.
+static uint32_t readIdx[SMS_HISTORY_SEG_MAX];
+
+static void copyPayload(Print& out, File& f, uint16_t len) {
+  uint8_t buf[256];
+  while (len) {
+    int n = f.read(buf, len < sizeof(buf) ? len : sizeof(buf));
+    if (n <= 0) break;
+    out.write(buf, n);
+    len -= n;
+  }
+}
+
+// Záznamy jsou serializované ArduinoJsonem (bez mezer), příjemce tedy
+// stačí hledat jako přesný token
+static bool matchesNumber(const uint8_t* p, uint16_t len, const char* number) {
+  char key[SMS_NUMBER_MAX + 16];
+  int k = snprintf(key, sizeof(key), "\"recipient\":\"%s\"", number);
+  if (k <= 0 || k >= (int)sizeof(key)) return false;
+  for (uint16_t i = 0; i + k <= len; ++i) {
+    if (p[i] == '"' && memcmp(p + i, key, k) == 0) return true;
+  }
+  return false;
+}
+
+struct PrintState {
+  uint16_t skip;
+  uint16_t printed;
+  bool     first;
+  bool     more;
+  bool     done;
+};
+
+static uint8_t readBuf[REC_MAX];
+
+// Od nejnovějšího; čas záznamů neklesá, první starší než `since` končí výpis
+static void printSegment(Print& out, File& f, uint16_t n, const LogQuery& q, PrintState& st) {
+  for (uint16_t i = n; i-- > 0 && !st.done; ) {
+    RecHdr h;
+    f.seek(readIdx[i]);
+    if (f.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || h.magic != REC_MAGIC) continue;
+    if (h.ts < q.since) { st.done = true; break; }
+    if (q.number && *q.number) {
+      if (h.len > REC_MAX || f.read(readBuf, h.len) != h.len) continue;
+      if (!matchesNumber(readBuf, h.len, q.number)) continue;
+      f.seek(readIdx[i] + sizeof(h));
+    }
+    if (st.skip) { st.skip--; continue; }
+    if (st.printed >= q.limit) { st.more = true; st.done = true; break; }
+    if (!st.first) out.print(',');
+    copyPayload(out, f, h.len);
+    st.first = false;
+    st.printed++;
+  }
+}
+
+bool smsHistoryPrintJson(Print& out, const LogQuery& q) {
+  File act    = LittleFS.open(HIST_PATH, "r");
+  File sealed = LittleFS.open(HIST_SEALED, "r");
+  PrintState st = { q.offset, 0, true, false, false };
+  out.print('[');
+  if (act) {
+    uint32_t end;
+    printSegment(out, act, scanSegment(act, readIdx, SMS_HISTORY_SEG_MAX, end), q, st);
+    act.close();
+  }
+  if (sealed) {
+    if (!st.done) printSegment(out, sealed, loadSealedIndex(sealed, readIdx, SMS_HISTORY_SEG_MAX), q, st);
+    sealed.close();
+  }
+  out.print(']');
+  return st.more;
+}
@@ -0,0 +1,35 @@
+// sms_history.h – historie odeslaných SMS jako append-only log
+//
+// Každé odeslání = jeden malý append do /sms_history.log: hlavička
+// (magic, kontrolní součet, délka, čas) a za ní JSON objekt záznamu.
+// Po getSmsHistoryMaxCount() záznamech se segment uzavře patičkou
+// s tabulkou offsetů a přejmenuje na /sms_history.1.log (předchozí
+// uzavřený segment se smaže). Čtenář tak jde od nejnovějších záznamů
+// bez parsování celého souboru a historie není omezena velikostí
+// JSON dokumentu.
+//
+// Zápis jen z modemové úlohy (po +CMGS), čtení z libovolné úlohy.
+
+#pragma once
+#include <Arduino.h>
+
+#ifndef SMS_HISTORY_SEG_MAX
+  #define SMS_HISTORY_SEG_MAX  512    // max. záznamů v segmentu (4 B RAM každý, 2×)
+#endif
+
+// Při startu (před tasksStart): obnova indexu, oříznutí rozepsaného
+// záznamu, jednorázový import starého /sms_history.json
+void     smsHistoryInit();
+bool     smsHistoryAppend(const char* recipient, const char* message);
+
+// Stránkování a filtr pro výpis logů (historie SMS, log volání)
+struct LogQuery {
+  uint16_t    offset = 0;         // přeskočit N nejnovějších vyhovujících
+  uint16_t    limit  = 0xFFFF;
+  uint32_t    since  = 0;         // epoch [s], 0 = bez omezení
+  const char* number = nullptr;   // přesná shoda příjemce/volajícího
+};
+
+// Vypíše vyhovující záznamy od nejnovějšího jako JSON pole; vrací true,
+// pokud za stránkou následují další
+bool     smsHistoryPrintJson(Print& out, const LogQuery& q);
@@ -0,0 +1,122 @@
+// sms_inbox.cpp – příjem SMS (+CMT / +CMTI)
+#include "sms_inbox.h"
+#include "at_engine.h"
+#include "jsonl_file.h"
+#include "mqtt_module.h"
+#include "rt_queue.h"
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <time.h>
+
+static const char* INBOX_PATH     = "/sms_inbox.jsonl";
+static const char* INBOX_OLD_PATH = "/sms_inbox.1.jsonl";
+
+// ====== Stav parseru (jen modemová úloha) ======
+// Po hlavičce +CMT/+CMGR následuje řádek s PDU.
+static bool       wantBody = false;
+static SmsDeliver msg;
+static uint32_t   logBytes = 0;
+
+static SmsInboxStats              stats;
+static SeqSnapshot<SmsInboxStats> statsSnap;
+static uint32_t                   minuteStart    = 0;
+static uint32_t                   minuteReceived = 0;
+
+static void storeMessage(const char* pdu) {
+  if (!smsDecodeDeliver(pdu, msg)) {
+    stats.invalid++;
+    return;
+  }
+  stats.received++;
+  stats.lastAt = millis();
+
+  StaticJsonDocument<256> doc;
+  doc["timestamp"] = time(nullptr);
+  doc["from"]      = (const char*)msg.from;
+  doc["scts"]      = (const char*)msg.scts;
+  doc["text"]      = (const char*)msg.text;
+  if (msg.parts > 1) {
+    doc["ref"]   = msg.ref;
+    doc["part"]  = msg.part;
+    doc["parts"] = msg.parts;
+  }
+  if (jsonlAppend(INBOX_PATH, doc)) {
+    stats.stored++;
+    logBytes += measureJson(doc) + 1;
+  } else {
+    stats.dropped++;
+  }
+  if (!mqttPublishSmsReceived(msg)) stats.dropped++;
+}
+
+// ====== +CMTI → AT+CMGR / AT+CMGD ======
+static void onCmgrDone(const AtResult& res, void* ctx) {
+  int idx = (int)(intptr_t)ctx;
+  wantBody = false;                   // bez těla (chyba) hlavičku zahodíme
+  if (res.status != AT_OK) return;
+  char cmd[20];
+  snprintf(cmd, sizeof(cmd), "AT+CMGD=%d", idx);
+  atSubmit(cmd);
+}
+
+static void readStoredMessage(const char* line) {
+  const char* comma = strrchr(line, ',');
+  if (!comma) return;
+  int idx = atoi(comma + 1);
+  char cmd[20];
+  snprintf(cmd, sizeof(cmd), "AT+CMGR=%d", idx);
+  atSubmit(cmd, onCmgrDone, (void*)(intptr_t)idx, 5000);
+}
+
+// ====== API ======
+void smsInboxInit() {
+  File f = LittleFS.open(INBOX_PATH, "r");
+  if (f) {
+    logBytes = f.size();
+    f.close();
+  }
+  atSubmit("AT+CMGF=0");              // PDU mód (stejný jako pro odesílání)
+  atSubmit("AT+CNMI=2,2,0,0,0");      // přímé doručení bez ukládání na SIM
+}
+
+bool smsInboxWantsBody() {
+  return wantBody;
+}
+
+void smsInboxOnBody(const char* pdu) {
+  wantBody = false;
+  storeMessage(pdu);
+}
+
+// PDU mód: "+CMT: [<alpha>],<length>" / "+CMGR: <stat>,[<alpha>],<length>",
+// adresa i čas jsou až v PDU na dalším řádku
+void smsInboxOnHeader(const char*, size_t) {
+  wantBody = true;
+}
+
+void smsInboxOnCmti(const char* line, size_t) {
+  readStoredMessage(line);
+}
+
+void smsInboxLoop() {
+  uint32_t now = millis();
+  if (now - minuteStart >= 60000) {
+    stats.perMinute = stats.received - minuteReceived;
+    minuteReceived  = stats.received;
+    minuteStart     = now;
+  }
+  if (logBytes >= SMS_INBOX_MAX_BYTES) {
+    LittleFS.remove(INBOX_OLD_PATH);
+    LittleFS.rename(INBOX_PATH, INBOX_OLD_PATH);
+    logBytes = 0;
+  }
+  statsSnap.publish(stats);
+}
+
+SmsInboxStats smsInboxGetStats() {
+  return statsSnap.read();
+}
+
+void smsInboxPrintJson(Print& out) {
+  jsonlPrintArray(out, INBOX_PATH);
+}
@@ -0,0 +1,38 @@
+// sms_inbox.h – příjem SMS (přímé doručení +CMT, záložně +CMTI)
+//
+// AT+CNMI=2,2 nechá modem posílat každou zprávu rovnou jako URC +CMT
+// (hlavička + řádek s PDU), takže odpadá AT+CMGR/AT+CMGD pro každou
+// zprávu. PDU dekóduje sms_pdu; segmenty dělené zprávy se ukládají
+// jednotlivě s ref/part/parts, skládá je až odběratel. Hlásí-li modem přesto +CMTI (uloženo na SIM), zprávu přečteme
+// a smažeme. Hlavičky i řádek s PDU dodává modem_urc, každá zpráva se
+// připíše do /sms_inbox.jsonl a předá MQTT úloze.
+
+#pragma once
+#include <Arduino.h>
+#include "sms_pdu.h"
+
+#ifndef SMS_INBOX_MAX_BYTES
+  #define SMS_INBOX_MAX_BYTES   32768   // pak rotace do /sms_inbox.1.jsonl
+#endif
+#define SMS_INBOX_TEXT_MAX      SMS_PDU_TEXT_MAX
+
+struct SmsInboxStats {
+  uint32_t received  = 0;     // od startu
+  uint32_t stored    = 0;     // z toho zapsáno do logu
+  uint32_t dropped   = 0;     // plná MQTT fronta / chyba zápisu
+  uint32_t invalid   = 0;     // PDU, které nešlo dekódovat
+  uint32_t perMinute = 0;     // za poslední celou minutu
+  uint32_t lastAt    = 0;     // millis() poslední zprávy, 0 = zatím žádná
+};
+
+// ======= Modemová úloha =======
+void smsInboxInit();                       // CMGF/CNMI do AT enginu
+bool smsInboxWantsBody();                  // čeká se na řádek s PDU?
+void smsInboxOnBody(const char* pdu);      // řádek po hlavičce (i prázdný)
+void smsInboxOnHeader(const char* line, size_t len);   // URC +CMT / +CMGR
+void smsInboxOnCmti(const char* line, size_t len);     // URC +CMTI
+void smsInboxLoop();                       // rotace logu, statistika
+
+// ======= Libovolná úloha =======
+SmsInboxStats smsInboxGetStats();
+void          smsInboxPrintJson(Print& out);   // aktuální log jako JSON pole
@@ -0,0 +1,405 @@
+// sms_pdu.cpp – PDU kodek SMS (3GPP TS 23.040 / 23.038)
+#include "sms_pdu.h"
+
+// ====== Tabulky GSM-7 (TS 23.038) ======
+static const uint16_t GSM7_BASIC[128] = {
+  '@',    0x00A3, '$',    0x00A5, 0x00E8, 0x00E9, 0x00F9, 0x00EC,
+  0x00F2, 0x00C7, '\n',   0x00D8, 0x00F8, '\r',   0x00C5, 0x00E5,
+  0x0394, '_',    0x03A6, 0x0393, 0x039B, 0x03A9, 0x03A0, 0x03A8,
+  0x03A3, 0x0398, 0x039E, 0xFFFF, 0x00C6, 0x00E6, 0x00DF, 0x00C9,
+  ' ',    '!',    '"',    '#',    0x00A4, '%',    '&',    '\'',
+  '(',    ')',    '*',    '+',    ',',    '-',    '.',    '/',
+  '0',    '1',    '2',    '3',    '4',    '5',    '6',    '7',
+  '8',    '9',    ':',    ';',    '<',    '=',    '>',    '?',
+  0x00A1, 'A',    'B',    'C',    'D',    'E',    'F',    'G',
+  'H',    'I',    'J',    'K',    'L',    'M',    'N',    'O',
+  'P',    'Q',    'R',    'S',    'T',    'U',    'V',    'W',
+  'X',    'Y',    'Z',    0x00C4, 0x00D6, 0x00D1, 0x00DC, 0x00A7,
+  0x00BF, 'a',    'b',    'c',    'd',    'e',    'f',    'g',
+  'h',    'i',    'j',    'k',    'l',    'm',    'n',    'o',
+  'p',    'q',    'r',    's',    't',    'u',    'v',    'w',
+  'x',    'y',    'z',    0x00E4, 0x00F6, 0x00F1, 0x00FC, 0x00E0
+};
+
+static const uint8_t GSM7_ESC = 0x1B;
+
+struct Gsm7Ext { uint8_t code; uint16_t cp; };
+static const Gsm7Ext GSM7_EXT[] = {
+  { 0x0A, 0x000C }, { 0x14, '^' }, { 0x28, '{' }, { 0x29, '}' }, { 0x2F, '\\' },
+  { 0x3C, '[' },    { 0x3D, '~' }, { 0x3E, ']' }, { 0x40, '|' }, { 0x65, 0x20AC }
+};
+
+// ASCII → GSM-7 rychle přes reverzní tabulku (0xFF = není v základní sadě)
+static uint8_t asciiToGsm[128];
+static bool    asciiReady = false;
+
+static void buildAsciiTable() {
+  memset(asciiToGsm, 0xFF, sizeof(asciiToGsm));
+  for (uint8_t i = 0; i < 128; ++i) {
+    if (GSM7_BASIC[i] < 128) asciiToGsm[GSM7_BASIC[i]] = i;
+  }
+  asciiReady = true;
+}
+
+// Kód znaku v GSM-7; ext = potřebuje ESC (2 septety)
+static bool gsmLookup(uint32_t cp, uint8_t& code, bool& ext) {
+  if (!asciiReady) buildAsciiTable();
+  ext = false;
+  if (cp < 128 && asciiToGsm[cp] != 0xFF) { code = asciiToGsm[cp]; return true; }
+  if (cp < 0x10000) {
+    for (uint8_t i = 0; i < 128; ++i) {
+      if (GSM7_BASIC[i] == cp) { code = i; return true; }
+    }
+  }
+  for (const Gsm7Ext& e : GSM7_EXT) {
+    if (e.cp == cp) { code = e.code; ext = true; return true; }
+  }
+  return false;
+}
+
+// ====== UTF-8 ======
+// Další znak, posune p; 0 = konec, -1 = neplatná sekvence
+static int32_t nextCodepoint(const char*& p) {
+  const uint8_t* s = (const uint8_t*)p;
+  if (!*s) return 0;
+  uint32_t cp;
+  int n;
+  if (s[0] < 0x80)              { cp = s[0];        n = 1; }
+  else if ((s[0] & 0xE0) == 0xC0) { cp = s[0] & 0x1F; n = 2; }
+  else if ((s[0] & 0xF0) == 0xE0) { cp = s[0] & 0x0F; n = 3; }
+  else if ((s[0] & 0xF8) == 0xF0) { cp = s[0] & 0x07; n = 4; }
+  else return -1;
+  for (int i = 1; i < n; ++i) {
+    if ((s[i] & 0xC0) != 0x80) return -1;
+    cp = (cp << 6) | (s[i] & 0x3F);
+  }
+  p += n;
+  return (int32_t)cp;
+}
+
+// Připojí znak, pokud se vejde celý (text se nikdy neusekne uprostřed znaku)
+static bool appendUtf8(char* dst, size_t& len, size_t cap, uint32_t cp) {
+  char buf[4];
+  size_t n;
+  if (cp < 0x80)         { buf[0] = cp; n = 1; }
+  else if (cp < 0x800)   { buf[0] = 0xC0 | (cp >> 6);  buf[1] = 0x80 | (cp & 0x3F); n = 2; }
+  else if (cp < 0x10000) { buf[0] = 0xE0 | (cp >> 12); buf[1] = 0x80 | ((cp >> 6) & 0x3F);
+                           buf[2] = 0x80 | (cp & 0x3F); n = 3; }
+  else                   { buf[0] = 0xF0 | (cp >> 18); buf[1] = 0x80 | ((cp >> 12) & 0x3F);
+                           buf[2] = 0x80 | ((cp >> 6) & 0x3F); buf[3] = 0x80 | (cp & 0x3F); n = 4; }
+  if (len + n >= cap) return false;
+  memcpy(dst + len, buf, n);
+  len += n;
+  dst[len] = '\0';
+  return true;
+}
+
+// ====== Plánování segmentů ======
+static uint8_t unitsOf(uint32_t cp, SmsEncoding enc) {
+  if (enc == SMS_ENC_UCS2) return cp > 0xFFFF ? 2 : 1;
+  uint8_t code; bool ext;
+  return gsmLookup(cp, code, ext) ? (ext ? 2 : 1) : 0;
+}
+
+// Rozdělí text na segmenty po perSeg jednotkách; starts[i] = začátek
+// segmentu i. Vrací počet segmentů, 0 = chyba / nad SMS_MAX_SEGMENTS.
+static uint8_t splitSegments(const char* utf8, SmsEncoding enc, uint16_t perSeg,
+                             const char** starts) {
+  uint8_t  n    = 1;
+  uint16_t used = 0;
+  starts[0] = utf8;
+  const char* p = utf8;
+  for (;;) {
+    const char* at = p;
+    int32_t cp = nextCodepoint(p);
+    if (cp == 0) break;
+    if (cp < 0) return 0;
+    uint8_t u = unitsOf(cp, enc);
+    if (!u) return 0;
+    if (used + u > perSeg) {
+      if (n == SMS_MAX_SEGMENTS) return 0;
+      starts[n++] = at;
+      used = 0;
+    }
+    used += u;
+  }
+  return n;
+}
+
+static uint8_t segmentsFor(const char* utf8, SmsEncoding enc, uint16_t units) {
+  const char* starts[SMS_MAX_SEGMENTS];
+  uint16_t single = enc == SMS_ENC_GSM7 ? 160 : 70;
+  if (units <= single) return 1;
+  return splitSegments(utf8, enc, enc == SMS_ENC_GSM7 ? 153 : 67, starts);
+}
+
+bool smsPlan(const char* utf8, SmsPlan& out) {
+  uint16_t septets = 0, ucs = 0;
+  bool     gsm     = true;
+  const char* p = utf8;
+  for (;;) {
+    int32_t cp = nextCodepoint(p);
+    if (cp == 0) break;
+    if (cp < 0) { out.segments = 0; return false; }
+    ucs += cp > 0xFFFF ? 2 : 1;
+    if (gsm) {
+      uint8_t u = unitsOf(cp, SMS_ENC_GSM7);
+      if (u) septets += u;
+      else   gsm = false;
+    }
+  }
+
+  uint8_t segUcs = segmentsFor(utf8, SMS_ENC_UCS2, ucs);
+  uint8_t segGsm = gsm ? segmentsFor(utf8, SMS_ENC_GSM7, septets) : 0;
+  if (segGsm && (!segUcs || segGsm <= segUcs)) {
+    out.encoding = SMS_ENC_GSM7;
+    out.units    = septets;
+    out.segments = segGsm;
+  } else {
+    out.encoding = SMS_ENC_UCS2;
+    out.units    = ucs;
+    out.segments = segUcs;
+  }
+  return out.segments != 0;
+}
+
+// ====== Kódování SMS-SUBMIT ======
+static const char HEX[] = "0123456789ABCDEF";
+
+static void packSeptet(uint8_t* ud, uint16_t bit, uint8_t v) {
+  uint16_t o = bit / 8, s = bit % 8;
+  ud[o] |= v << s;
+  if (s > 1) ud[o + 1] |= v >> (8 - s);
+}
+
+size_t smsEncodeSubmit(const char* number, const char* utf8, const SmsPlan& plan,
+                       uint8_t part, uint8_t ref, char* hex, size_t cap) {
+  if (!plan.segments || part >= plan.segments) return 0;
+
+  const char* starts[SMS_MAX_SEGMENTS];
+  const char* segBegin = utf8;
+  const char* segEnd   = utf8 + strlen(utf8);
+  bool concat = plan.segments > 1;
+  if (concat) {
+    uint16_t per = plan.encoding == SMS_ENC_GSM7 ? 153 : 67;
+    if (splitSegments(utf8, plan.encoding, per, starts) != plan.segments) return 0;
+    segBegin = starts[part];
+    if (part + 1 < plan.segments) segEnd = starts[part + 1];
+  }
+
+  uint8_t tp[176];
+  size_t  o = 0;
+  memset(tp, 0, sizeof(tp));
+  tp[o++] = 0x11 | (concat ? 0x40 : 0);   // SMS-SUBMIT, relativní VP, UDHI
+  tp[o++] = 0x00;                          // TP-MR doplní modem
+
+  // TP-DA: počet číslic, typ, BCD s prohozenými nibbly
+  const char* d = number;
+  uint8_t toa = 0x81;
+  if (*d == '+') { toa = 0x91; d++; }
+  size_t nd = strlen(d);
+  if (nd == 0 || nd > 20) return 0;
+  tp[o++] = nd;
+  tp[o++] = toa;
+  for (size_t i = 0; i < nd; i += 2) {
+    if (!isdigit((unsigned char)d[i]) || (i + 1 < nd && !isdigit((unsigned char)d[i + 1]))) return 0;
+    uint8_t lo = d[i] - '0';
+    uint8_t hi = (i + 1 < nd) ? d[i + 1] - '0' : 0x0F;
+    tp[o++] = (hi << 4) | lo;
+  }
+
+  tp[o++] = 0x00;                                          // TP-PID
+  tp[o++] = plan.encoding == SMS_ENC_GSM7 ? 0x00 : 0x08;   // TP-DCS
+  tp[o++] = 0xAA;                                          // TP-VP: 4 dny
+  size_t udlPos = o++;
+  uint8_t* ud = tp + o;
+
+  size_t udhLen = 0;
+  if (concat) {
+    const uint8_t udh[] = { 0x05, 0x00, 0x03, ref, plan.segments, (uint8_t)(part + 1) };
+    memcpy(ud, udh, sizeof(udh));
+    udhLen = sizeof(udh);
+  }
+
+  const char* p = segBegin;
+  if (plan.encoding == SMS_ENC_GSM7) {
+    // UDH 6 oktetů = 48 bitů → 1 výplňový bit, text začíná septetem 7
+    uint16_t sept = concat ? 7 : 0;
+    while (p < segEnd) {
+      int32_t cp = nextCodepoint(p);
+      uint8_t code; bool ext;
+      if (cp <= 0 || !gsmLookup(cp, code, ext)) return 0;
+      if (ext) packSeptet(ud, 7 * sept++, GSM7_ESC);
+      packSeptet(ud, 7 * sept++, code);
+    }
+    tp[udlPos] = sept;
+    o += (sept * 7 + 7) / 8;
+  } else {
+    size_t b = udhLen;
+    while (p < segEnd) {
+      int32_t cp = nextCodepoint(p);
+      if (cp <= 0) return 0;
+      if (cp > 0xFFFF) {
+        uint32_t v = cp - 0x10000;
+        uint16_t hiS = 0xD800 | (v >> 10), loS = 0xDC00 | (v & 0x3FF);
+        ud[b++] = hiS >> 8; ud[b++] = hiS & 0xFF;
+        ud[b++] = loS >> 8; ud[b++] = loS & 0xFF;
+      } else {
+        ud[b++] = cp >> 8; ud[b++] = cp & 0xFF;
+      }
+    }
+    tp[udlPos] = b;
+    o += b;
+  }
+  if (o > sizeof(tp) || (o + 1) * 2 + 1 > cap) return 0;
+
+  hex[0] = '0'; hex[1] = '0';                  // SCA z nastavení SIM
+  for (size_t i = 0; i < o; ++i) {
+    hex[2 + 2 * i]     = HEX[tp[i] >> 4];
+    hex[2 + 2 * i + 1] = HEX[tp[i] & 0x0F];
+  }
+  hex[2 + 2 * o] = '\0';
+  return o;
+}
+
+// ====== Dekódování SMS-DELIVER ======
+static int hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+static uint8_t unpackSeptet(const uint8_t* ud, size_t len, uint16_t bit) {
+  size_t  o = bit / 8;
+  uint8_t s = bit % 8;
+  uint8_t v = o < len ? ud[o] >> s : 0;
+  if (s > 1 && o + 1 < len) v |= ud[o + 1] << (8 - s);
+  return v & 0x7F;
+}
+
+static void decodeGsm7(const uint8_t* ud, size_t len, uint16_t from, uint16_t to,
+                       char* dst, size_t cap) {
+  size_t n = 0;
+  dst[0] = '\0';
+  bool esc = false;
+  for (uint16_t k = from; k < to; ++k) {
+    uint8_t c = unpackSeptet(ud, len, 7 * k);
+    uint32_t cp;
+    if (esc) {
+      esc = false;
+      cp = ' ';
+      for (const Gsm7Ext& e : GSM7_EXT) {
+        if (e.code == c) { cp = e.cp; break; }
+      }
+    } else if (c == GSM7_ESC) {
+      esc = true;
+      continue;
+    } else {
+      cp = GSM7_BASIC[c];
+    }
+    if (!appendUtf8(dst, n, cap, cp)) return;
+  }
+}
+
+static void bcdSwapped(const uint8_t* b, size_t n, char* dst, size_t cap) {
+  size_t k = 0;
+  for (size_t i = 0; i < n && k + 1 < cap; ++i) {
+    uint8_t lo = b[i] & 0x0F, hi = b[i] >> 4;
+    if (lo <= 9) dst[k++] = '0' + lo;
+    if (hi <= 9 && k + 1 < cap) dst[k++] = '0' + hi;
+  }
+  dst[k] = '\0';
+}
+
+bool smsDecodeDeliver(const char* hex, SmsDeliver& out) {
+  uint8_t buf[180];
+  size_t  len = 0;
+  for (; hex[0] && hex[1]; hex += 2) {
+    int hi = hexNibble(hex[0]), lo = hexNibble(hex[1]);
+    if (hi < 0 || lo < 0 || len >= sizeof(buf)) return false;
+    buf[len++] = (hi << 4) | lo;
+  }
+
+  size_t i = 1 + (len ? buf[0] : 0);             // přeskočit SCA
+  if (i + 2 > len) return false;
+  uint8_t fo = buf[i++];
+  if ((fo & 0x03) != 0x00) return false;         // jen SMS-DELIVER
+  bool udhi = fo & 0x40;
+
+  // TP-OA
+  uint8_t oaDigits = buf[i++];
+  uint8_t toa      = buf[i++];
+  size_t  oaOct    = (oaDigits + 1) / 2;
+  if (i + oaOct + 10 > len) return false;
+  if ((toa & 0x70) == 0x50) {                    // alfanumerický odesílatel
+    decodeGsm7(buf + i, oaOct, 0, oaDigits * 4 / 7, out.from, sizeof(out.from));
+  } else {
+    size_t k = 0;
+    if ((toa & 0x70) == 0x10) out.from[k++] = '+';
+    bcdSwapped(buf + i, oaOct, out.from + k, sizeof(out.from) - k);
+  }
+  i += oaOct;
+
+  i++;                                           // TP-PID
+  uint8_t dcs = buf[i++];
+
+  // TP-SCTS: yy MM dd hh mm ss tz (BCD prohozené), tz ve čtvrthodinách
+  const uint8_t* ts = buf + i;
+  auto bcd = [](uint8_t b) { return (b & 0x0F) * 10 + (b >> 4); };
+  int tz = ((ts[6] & 0x07) * 10 + (ts[6] >> 4)) * ((ts[6] & 0x08) ? -1 : 1);
+  snprintf(out.scts, sizeof(out.scts), "%02d/%02d/%02d,%02d:%02d:%02d%+03d",
+           bcd(ts[0]), bcd(ts[1]), bcd(ts[2]), bcd(ts[3]), bcd(ts[4]), bcd(ts[5]), tz);
+  i += 7;
+
+  uint8_t udl = buf[i++];
+  const uint8_t* ud = buf + i;
+  size_t udBytes = len - i;
+
+  // abeceda dle TP-DCS (TS 23.038 kap. 4)
+  uint8_t alphabet = 0;                          // 0 GSM-7, 1 8bit, 2 UCS-2
+  if ((dcs & 0xC0) == 0x00 || (dcs & 0xC0) == 0x40) alphabet = (dcs >> 2) & 0x03;
+  else if ((dcs & 0xF0) == 0xE0)                    alphabet = 2;
+  else if ((dcs & 0xF0) == 0xF0)                    alphabet = (dcs & 0x04) ? 1 : 0;
+
+  out.ref = 0; out.part = 1; out.parts = 1;
+  size_t udhBytes = 0;
+  if (udhi && udBytes) {
+    uint8_t udhl = ud[0];
+    udhBytes = udhl + 1;
+    for (size_t k = 1; k + 1 < udhBytes && k + 1 < udBytes; ) {
+      uint8_t iei = ud[k], iel = ud[k + 1];
+      const uint8_t* v = ud + k + 2;
+      if (iei == 0x00 && iel == 3 && k + 5 <= udBytes) { out.ref = v[0]; out.parts = v[1]; out.part = v[2]; }
+      if (iei == 0x08 && iel == 4 && k + 6 <= udBytes) { out.ref = v[1]; out.parts = v[2]; out.part = v[3]; }
+      k += 2 + iel;
+    }
+  }
+
+  if (alphabet == 0) {
+    uint16_t skip = udhi ? (udhBytes * 8 + 6) / 7 : 0;
+    decodeGsm7(ud, udBytes, skip, udl, out.text, sizeof(out.text));
+  } else if (alphabet == 2) {
+    size_t n = 0;
+    out.text[0] = '\0';
+    size_t end = min((size_t)udl, udBytes);
+    for (size_t k = udhBytes; k + 1 < end; k += 2) {
+      uint32_t cp = (ud[k] << 8) | ud[k + 1];
+      if (cp >= 0xD800 && cp < 0xDC00 && k + 3 < end) {
+        uint32_t lo = (ud[k + 2] << 8) | ud[k + 3];
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+        k += 2;
+      }
+      if (!appendUtf8(out.text, n, sizeof(out.text), cp)) break;
+    }
+  } else {
+    // 8bit data: hex, ať je zápis do logu/MQTT čistý text
+    size_t n = 0, end = min((size_t)udl, udBytes);
+    for (size_t k = udhBytes; k < end && n + 2 < sizeof(out.text); ++k) {
+      out.text[n++] = HEX[ud[k] >> 4];
+      out.text[n++] = HEX[ud[k] & 0x0F];
+    }
+    out.text[n] = '\0';
+  }
+  return true;
+}
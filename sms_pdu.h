@@ -0,0 +1,49 @@
+// sms_pdu.h – PDU kodek SMS (GSM-7, UCS-2, dělené zprávy)
+//
+// Plánovač spočítá pro text (UTF-8) počet segmentů v GSM-7 i UCS-2 a
+// vybere kódování s menším počtem segmentů; GSM-7 jen pokud jsou všechny
+// znaky v základní nebo rozšířené tabulce (česká diakritika mimo "é"
+// tam není, takže české texty jdou v UCS-2 místo rozsypaných znaků).
+// Delší text se dělí s UDH (8bit reference) – 153 septetů / 67 znaků
+// UCS-2 na segment, ESC sekvence ani surrogate páry se nedělí.
+
+#pragma once
+#include <Arduino.h>
+
+#ifndef SMS_MAX_SEGMENTS
+  #define SMS_MAX_SEGMENTS  8
+#endif
+
+// TPDU SMS-SUBMIT: max. 1+1+12 (DA) +1+1+1+1+1 + 140 B UD, hex + "00" SCA
+#define SMS_PDU_HEX_MAX   ((2 + 12 + 5 + 1 + 140) * 2 + 2 + 1)
+#define SMS_PDU_TEXT_MAX  321     // dekódovaný text jednoho segmentu (UTF-8)
+
+enum SmsEncoding : uint8_t {
+  SMS_ENC_GSM7,
+  SMS_ENC_UCS2
+};
+
+struct SmsPlan {
+  SmsEncoding encoding;
+  uint16_t    units;         // septety (GSM-7) nebo UTF-16 jednotky (UCS-2)
+  uint8_t     segments;      // 0 = nelze odeslat (neplatné UTF-8, příliš dlouhé)
+};
+
+// ======= Odesílání =======
+bool   smsPlan(const char* utf8, SmsPlan& out);
+// Segment `part` (od 0) jako hex PDU pro AT+CMGS v PDU módu ("00" = SCA
+// ze SIM). Vrací délku TPDU v oktetech (parametr AT+CMGS), 0 = chyba.
+size_t smsEncodeSubmit(const char* number, const char* utf8, const SmsPlan& plan,
+                       uint8_t part, uint8_t ref, char* hex, size_t cap);
+
+// ======= Příjem =======
+struct SmsDeliver {
+  char    from[24];
+  char    scts[24];          // "yy/MM/dd,hh:mm:ss+zz" jako v textovém módu
+  char    text[SMS_PDU_TEXT_MAX];
+  uint8_t ref;               // reference dělené zprávy
+  uint8_t part;              // 1..parts, nedělená zpráva = 1/1
+  uint8_t parts;
+};
+
+bool smsDecodeDeliver(const char* hex, SmsDeliver& out);
@@ -0,0 +1,360 @@
+// sms_queue.cpp – fronta SMS úloh nad předalokovanou tabulkou
+#include "sms_queue.h"
+#include "rt_queue.h"
+#include <utility>
+
+static_assert((SMS_JOB_CAPACITY & (SMS_JOB_CAPACITY - 1)) == 0, "SMS_JOB_CAPACITY musí být mocnina 2");
+static_assert(SMS_JOB_CAPACITY <= 4096, "SMS_JOB_CAPACITY max. 4096");
+static_assert(SMS_TEXT_BLOCKS < 0xFFFF, "SMS_TEXT_BLOCKS max. 65534");
+static_assert(SMS_TEXT_BLOCKS * SMS_TEXT_BLOCK >= SMS_TEXT_MAX, "pool nepojme ani jeden dlouhý text");
+
+static constexpr uint32_t slotBits(uint32_t n) { return n <= 1 ? 0 : 1 + slotBits(n >> 1); }
+static constexpr uint32_t SLOT_BITS = slotBits(SMS_JOB_CAPACITY);
+static constexpr uint32_t SLOT_MASK = SMS_JOB_CAPACITY - 1;
+static constexpr uint16_t TEXT_NONE = 0xFFFF;
+
+// ====== Záznamy ======
+struct SmsJob {
+  uint32_t    id;
+  SmsJobState state;
+  SmsSource   source;
+  uint8_t     attempts;
+  uint16_t    text;          // první blok v textPool, TEXT_NONE = uvolněn
+  int16_t     msgRef;
+  int16_t     lastError;
+  uint32_t    createdAt;
+  uint32_t    updatedAt;
+  uint32_t    notBefore;
+  char        recipient[SMS_NUMBER_MAX];
+};
+
+// Text = řetěz bloků; refs platí jen v prvním bloku. Volné bloky tvoří
+// zásobník přes `next`, dosud nepoužité se berou od `freshBlock`.
+struct TextBlock {
+  uint16_t next;
+  uint16_t refs;
+  char     data[SMS_TEXT_BLOCK];
+};
+
+static SmsJob     jobs[SMS_JOB_CAPACITY];
+static TextBlock  textPool[SMS_TEXT_BLOCKS];
+static RtSpinLock lock;                    // chrání jobs[].stav/metadata, refs a volné bloky
+static uint32_t   seq         = 0;
+static uint16_t   allocCursor = 0;
+static uint16_t   lastText    = TEXT_NONE; // naposledy založený text (hromadné SMS)
+static uint16_t   activeJobs  = 0;
+static uint16_t   freeList    = TEXT_NONE;
+static uint16_t   freshBlock  = 0;
+static uint16_t   freeBlocks  = SMS_TEXT_BLOCKS;
+
+// ====== Předání do modemové úlohy ======
+// Kapacita front = kapacita tabulky, push tedy nikdy neselže.
+static SpscRing<uint16_t, SMS_JOB_CAPACITY> fromHttp;
+static SpscRing<uint16_t, SMS_JOB_CAPACITY> fromMqtt;
+static uint16_t pending[SMS_JOB_CAPACITY];  // FIFO jen pro modemovou úlohu
+static uint32_t pendHead = 0, pendTail = 0; // volně běžící čítače
+static uint16_t retrying[SMS_JOB_CAPACITY]; // odložená opakování (neseřazená)
+static uint16_t retryCount = 0;
+
+static void pendingPush(uint16_t slot) {
+  pending[pendTail++ & SLOT_MASK] = slot;
+}
+
+static bool isFinal(SmsJobState st) {
+  return st == SMS_JOB_FREE || st == SMS_JOB_SENT || st == SMS_JOB_FAILED;
+}
+
+const char* smsJobStateToString(SmsJobState st) {
+  switch (st) {
+    case SMS_JOB_FREE:     return "free";
+    case SMS_JOB_QUEUED:   return "queued";
+    case SMS_JOB_SENDING:  return "sending";
+    case SMS_JOB_SENT:     return "sent";
+    case SMS_JOB_FAILED:   return "failed";
+    case SMS_JOB_RETRYING: return "retrying";
+  }
+  return "unknown";
+}
+
+// ====== Pool textů ======
+// Poslední reference vrací celý řetěz na zásobník volných bloků
+static void releaseText(uint16_t t) {
+  if (t == TEXT_NONE) return;
+  RtLockGuard g(lock);
+  if (!textPool[t].refs || --textPool[t].refs) return;
+  if (t == lastText) lastText = TEXT_NONE;
+  uint16_t tail = t;
+  freeBlocks++;
+  while (textPool[tail].next != TEXT_NONE) {
+    tail = textPool[tail].next;
+    freeBlocks++;
+  }
+  textPool[tail].next = freeList;
+  freeList = t;
+}
+
+// Řetěz je neměnný, dokud drží referenci – čte se bez zámku
+static bool textEquals(uint16_t t, const char* text, size_t len) {
+  for (size_t off = 0; t != TEXT_NONE; t = textPool[t].next, off += SMS_TEXT_BLOCK) {
+    size_t n = min((size_t)SMS_TEXT_BLOCK, len + 1 - off);
+    if (memcmp(textPool[t].data, text + off, n) != 0) return false;
+  }
+  return true;
+}
+
+static size_t textCopy(uint16_t t, char* out, size_t cap) {
+  size_t n = 0;
+  for (; t != TEXT_NONE && n + 1 < cap; t = textPool[t].next) {
+    size_t k = min((size_t)SMS_TEXT_BLOCK, cap - 1 - n);
+    memcpy(out + n, textPool[t].data, k);
+    n += k;
+  }
+  out[n] = '\0';
+  return n;
+}
+
+// Hromadná SMS = stejný text po sobě: zkusíme sdílet poslední text.
+// Porovnání i kopie běží mimo kritickou sekci – řetěz drží naše reference.
+static uint16_t acquireText(const char* text, size_t len) {
+  uint16_t cand = TEXT_NONE;
+  {
+    RtLockGuard g(lock);
+    if (lastText != TEXT_NONE && textPool[lastText].refs) {
+      cand = lastText;
+      textPool[cand].refs++;
+    }
+  }
+  if (cand != TEXT_NONE) {
+    if (textEquals(cand, text, len)) return cand;
+    releaseText(cand);
+  }
+
+  uint16_t need = (len + SMS_TEXT_BLOCK) / SMS_TEXT_BLOCK;   // včetně '\0'
+  uint16_t t = TEXT_NONE;
+  {
+    RtLockGuard g(lock);
+    if (freeBlocks < need) return TEXT_NONE;
+    freeBlocks -= need;
+    // bloky se řetězí od konce, první blok nese refs
+    for (uint16_t i = 0; i < need; ++i) {
+      uint16_t b;
+      if (freeList != TEXT_NONE) {
+        b = freeList;
+        freeList = textPool[b].next;
+      } else {
+        b = freshBlock++;
+      }
+      textPool[b].next = t;
+      textPool[b].refs = 0;
+      t = b;
+    }
+    textPool[t].refs = 1;
+  }
+  for (uint16_t b = t, off = 0; b != TEXT_NONE; b = textPool[b].next, off += SMS_TEXT_BLOCK) {
+    memcpy(textPool[b].data, text + off, min((size_t)SMS_TEXT_BLOCK, len + 1 - off));
+  }
+  {
+    RtLockGuard g(lock);
+    lastText = t;
+  }
+  return t;
+}
+
+// ====== Producenti ======
+uint32_t smsJobSubmit(const char* recipient, const char* text, SmsSource src) {
+  size_t rlen = strlen(recipient);
+  size_t tlen = strlen(text);
+  if (rlen == 0 || rlen >= SMS_NUMBER_MAX || tlen >= SMS_TEXT_MAX) return 0;
+
+  uint16_t t = acquireText(text, tlen);
+  if (t == TEXT_NONE) return 0;
+
+  uint16_t slot = SMS_SLOT_NONE;
+  uint32_t id   = 0;
+  {
+    RtLockGuard g(lock);
+    // round-robin od kurzoru: přepisují se nejstarší dokončené úlohy
+    for (uint32_t n = 0; n < SMS_JOB_CAPACITY; ++n) {
+      uint16_t s = (allocCursor + n) & SLOT_MASK;
+      if (isFinal(jobs[s].state)) { slot = s; break; }
+    }
+    if (slot != SMS_SLOT_NONE) {
+      allocCursor = (slot + 1) & SLOT_MASK;
+      id = (++seq << SLOT_BITS) | slot;
+      SmsJob& j   = jobs[slot];
+      j.id        = id;
+      j.state     = SMS_JOB_QUEUED;
+      j.source    = src;
+      j.attempts  = 0;
+      j.text      = t;
+      j.msgRef    = -1;
+      j.lastError = -1;
+      j.createdAt = j.updatedAt = millis();
+      j.notBefore = 0;
+      memcpy(j.recipient, recipient, rlen + 1);
+      activeJobs++;
+    }
+  }
+  if (slot == SMS_SLOT_NONE) {
+    releaseText(t);
+    return 0;
+  }
+
+  switch (src) {
+    case SMS_SRC_HTTP: fromHttp.push(slot); break;
+    case SMS_SRC_MQTT: fromMqtt.push(slot); break;
+    case SMS_SRC_LOCAL: pendingPush(slot); break;
+  }
+  return id;
+}
+
+// ====== Dotazy ======
+static void copyInfo(const SmsJob& j, SmsJobInfo& out) {
+  out.id        = j.id;
+  out.state     = j.state;
+  out.source    = j.source;
+  out.attempts  = j.attempts;
+  out.msgRef    = j.msgRef;
+  out.lastError = j.lastError;
+  out.createdAt = j.createdAt;
+  out.updatedAt = j.updatedAt;
+  out.notBefore = j.notBefore;
+  memcpy(out.recipient, j.recipient, sizeof(out.recipient));
+}
+
+bool smsJobGet(uint32_t id, SmsJobInfo& out) {
+  const SmsJob& j = jobs[id & SLOT_MASK];
+  RtLockGuard g(lock);
+  if (id == 0 || j.id != id || j.state == SMS_JOB_FREE) return false;
+  copyInfo(j, out);
+  return true;
+}
+
+size_t smsJobActiveCount() {
+  RtLockGuard g(lock);
+  return activeJobs;
+}
+
+size_t smsJobList(SmsJobInfo* out, char (*preview)[161], size_t max, size_t skip) {
+  size_t n = 0;
+  uint16_t cursor;
+  {
+    RtLockGuard g(lock);
+    cursor = allocCursor;
+  }
+  // od kurzoru pozpátku = od nejnovějších; přeskočené aktivní sloty
+  // mohou být starší, proto malý výsledek nakonec seřadíme podle ID
+  for (uint32_t k = 1; k <= SMS_JOB_CAPACITY && n < max; ++k) {
+    const SmsJob& j = jobs[(cursor - k) & SLOT_MASK];
+    RtLockGuard g(lock);
+    if (j.state == SMS_JOB_FREE) continue;
+    if (skip) { skip--; continue; }
+    copyInfo(j, out[n]);
+    if (preview) {
+      if (j.text != TEXT_NONE) {
+        textCopy(j.text, preview[n], sizeof(preview[n]));
+      } else {
+        preview[n][0] = '\0';           // text už uvolněn (dokončená úloha)
+      }
+    }
+    n++;
+  }
+  for (size_t i = 1; i < n; ++i) {
+    for (size_t k = i; k > 0 && out[k - 1].id < out[k].id; --k) {
+      std::swap(out[k - 1], out[k]);
+      if (preview) {
+        char tmp[161];
+        memcpy(tmp, preview[k - 1], sizeof(tmp));
+        memcpy(preview[k - 1], preview[k], sizeof(tmp));
+        memcpy(preview[k], tmp, sizeof(tmp));
+      }
+    }
+  }
+  return n;
+}
+
+// ====== Spotřebitel (modemová úloha) ======
+static void drainRing(SpscRing<uint16_t, SMS_JOB_CAPACITY>& ring) {
+  uint16_t slot;
+  while (ring.pop(slot)) pendingPush(slot);
+}
+
+uint16_t smsJobNext() {
+  drainRing(fromHttp);
+  drainRing(fromMqtt);
+  if (retryCount) {
+    uint32_t now = millis();
+    for (uint16_t i = 0; i < retryCount; ++i) {
+      uint16_t slot = retrying[i];
+      if ((int32_t)(now - jobs[slot].notBefore) >= 0) {
+        retrying[i] = retrying[--retryCount];
+        return slot;
+      }
+    }
+  }
+  if (pendHead == pendTail) return SMS_SLOT_NONE;
+  return pending[pendHead++ & SLOT_MASK];
+}
+
+uint32_t smsJobId(uint16_t slot) {
+  return jobs[slot].id;
+}
+
+const char* smsJobRecipient(uint16_t slot) {
+  return jobs[slot].recipient;
+}
+
+const char* smsJobText(uint16_t slot) {
+  static char buf[SMS_TEXT_MAX];
+  uint16_t t = jobs[slot].text;
+  if (t == TEXT_NONE) return "";
+  textCopy(t, buf, sizeof(buf));
+  return buf;
+}
+
+uint8_t smsJobAttempts(uint16_t slot) {
+  return jobs[slot].attempts;
+}
+
+void smsJobMarkSending(uint16_t slot) {
+  RtLockGuard g(lock);
+  jobs[slot].state = SMS_JOB_SENDING;
+  jobs[slot].attempts++;
+  jobs[slot].updatedAt = millis();
+}
+
+static void finishJob(uint16_t slot, SmsJobState st, int msgRef, int errorCode) {
+  uint16_t t;
+  {
+    RtLockGuard g(lock);
+    SmsJob& j   = jobs[slot];
+    j.state     = st;
+    j.msgRef    = msgRef;
+    j.lastError = errorCode;
+    j.updatedAt = millis();
+    t = j.text;
+    j.text = TEXT_NONE;
+    activeJobs--;
+  }
+  releaseText(t);
+}
+
+void smsJobMarkSent(uint16_t slot, int msgRef) {
+  finishJob(slot, SMS_JOB_SENT, msgRef, -1);
+}
+
+void smsJobMarkFailed(uint16_t slot, int errorCode) {
+  finishJob(slot, SMS_JOB_FAILED, -1, errorCode);
+}
+
+void smsJobMarkRetry(uint16_t slot, int errorCode, uint32_t delayMs) {
+  {
+    RtLockGuard g(lock);
+    SmsJob& j   = jobs[slot];
+    j.state     = SMS_JOB_RETRYING;
+    j.lastError = errorCode;
+    j.updatedAt = millis();
+    j.notBefore = j.updatedAt + delayMs;
+  }
+  retrying[retryCount++] = slot;
+}
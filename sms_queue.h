@@ -0,0 +1,90 @@
+// sms_queue.h – fronta SMS úloh nad předalokovanou tabulkou (slab)
+//
+// Každá úloha = jeden záznam pevné velikosti v tabulce SMS_JOB_CAPACITY
+// slotů; texty jsou ve zvláštním poolu bloků s počítáním referencí,
+// takže hromadná SMS na stovky čísel drží text jen jednou. Text zabírá
+// tolik bloků SMS_TEXT_BLOCK, kolik potřebuje; výchozí pool stačí na
+// plnou tabulku úloh, každou s vlastním textem do 160 bajtů (~43 kB).
+// Za běhu se nic nealokuje na heapu.
+//
+// ID úlohy roste monotónně a v nejnižších bitech nese číslo slotu, takže
+// dotaz podle ID je O(1). Dokončené úlohy zůstávají v tabulce (stav,
+// časy, reference modemu), dokud jejich slot nepřepíše novější úloha.
+
+#pragma once
+#include <Arduino.h>
+
+// ======= Kapacity (lze přepsat přes -D) =======
+#ifndef SMS_JOB_CAPACITY
+  #define SMS_JOB_CAPACITY  256   // mocnina 2, max. 4096
+#endif
+#ifndef SMS_TEXT_BLOCK
+  #define SMS_TEXT_BLOCK    80    // bajtů textu v jednom bloku poolu
+#endif
+#ifndef SMS_TEXT_BLOCKS
+  #define SMS_TEXT_BLOCKS   (2 * SMS_JOB_CAPACITY)   // max. 65534
+#endif
+
+#define SMS_NUMBER_MAX  24    // včetně '\0'
+#define SMS_TEXT_MAX    640   // UTF-8 bajty včetně '\0'
+
+// Odkud úloha přichází – každý zdroj má vlastní SPSC frontu do modemové
+// úlohy. SMS_SRC_LOCAL smí použít jen kód běžící v modemové úloze.
+enum SmsSource : uint8_t {
+  SMS_SRC_LOCAL,
+  SMS_SRC_HTTP,
+  SMS_SRC_MQTT
+};
+
+enum SmsJobState : uint8_t {
+  SMS_JOB_FREE,
+  SMS_JOB_QUEUED,
+  SMS_JOB_SENDING,
+  SMS_JOB_SENT,
+  SMS_JOB_FAILED,
+  SMS_JOB_RETRYING
+};
+
+// Kopie záznamu pro čtenáře z jiných úloh
+struct SmsJobInfo {
+  uint32_t    id;
+  SmsJobState state;
+  SmsSource   source;
+  uint8_t     attempts;
+  int16_t     msgRef;        // <mr> z +CMGS, -1 = zatím není
+  int16_t     lastError;     // kód +CMS ERROR, -1 = žádný/neznámý
+  uint32_t    createdAt;     // millis()
+  uint32_t    updatedAt;     // millis() poslední změny stavu
+  uint32_t    notBefore;     // millis() dalšího pokusu (SMS_JOB_RETRYING)
+  char        recipient[SMS_NUMBER_MAX];
+};
+
+const char* smsJobStateToString(SmsJobState st);
+
+// ======= Producenti (HTTP / MQTT / modem) =======
+// Vrací ID nové úlohy, 0 = plná tabulka, plný pool textů nebo dlouhý vstup.
+uint32_t smsJobSubmit(const char* recipient, const char* text, SmsSource src);
+
+// ======= Dotazy (libovolná úloha) =======
+bool   smsJobGet(uint32_t id, SmsJobInfo& out);
+size_t smsJobActiveCount();                        // fronta + odesílaná
+// Nejnovější úlohy (od nejvyššího ID), volitelně s náhledem textu;
+// `skip` přeskočí tolik obsazených slotů (stránkování výpisu)
+size_t smsJobList(SmsJobInfo* out, char (*preview)[161], size_t max, size_t skip = 0);
+
+// ======= Spotřebitel (jen modemová úloha) =======
+static constexpr uint16_t SMS_SLOT_NONE = 0xFFFF;
+
+// Další k odeslání: nejdřív opakování, jejichž prodleva uplynula, pak
+// nové úlohy v pořadí příchodu. Úlohu tím převezme.
+uint16_t    smsJobNext();
+uint32_t    smsJobId(uint16_t slot);
+const char* smsJobRecipient(uint16_t slot);
+// Text složený z bloků do vnitřního bufferu, platí do dalšího volání
+const char* smsJobText(uint16_t slot);
+void        smsJobMarkSending(uint16_t slot);
+void        smsJobMarkSent(uint16_t slot, int msgRef);
+void        smsJobMarkFailed(uint16_t slot, int errorCode);
+// Přechodná chyba: text zůstává, úloha se vrátí ze smsJobNext() po delayMs
+void        smsJobMarkRetry(uint16_t slot, int errorCode, uint32_t delayMs);
+uint8_t     smsJobAttempts(uint16_t slot);
@@ -0,0 +1,145 @@
+// sms_retry.cpp – opakování neúspěšných SMS a dead-letter seznam
+#include "sms_retry.h"
+#include "settings.h"
+#include "mqtt_module.h"
+#include "jsonl_file.h"
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <atomic>
+#include <time.h>
+
+#define LOG_TAG "RETRY"
+#include "log.h"
+
+static const char* DEADLETTER_PATH = "/sms_deadletter.jsonl";
+static const char* DEADLETTER_TMP  = "/sms_deadletter.tmp";
+
+static std::atomic<uint16_t> deadCount{0};
+static std::atomic<bool>     clearRequested{false};
+static std::atomic<bool>     requeueRequested{false};
+
+// ====== Politika ======
+// 3GPP TS 24.011 (RP cause) a TS 27.005 (+CMS ERROR) – chyby, které se
+// opakováním nespraví. Ostatní (38 síť mimo provoz, 41 dočasná porucha,
+// 42 zahlcení, 47 nedostatek prostředků, 331/332 bez sítě / timeout,
+// 500 neznámá) bereme jako přechodné.
+static const uint16_t PERMANENT_CMS[] = {
+  1,    // Unassigned (unallocated) number
+  8,    // Operator determined barring
+  10,   // Call barred
+  21,   // Short message transfer rejected
+  28,   // Unidentified subscriber
+  29,   // Facility rejected
+  30,   // Unknown subscriber
+  50,   // Requested facility not subscribed
+  69,   // Requested facility not implemented
+  96,   // Invalid mandatory information
+  301,  // SMS service of ME reserved
+  302,  // Operation not allowed
+  303,  // Operation not supported
+  304,  // Invalid PDU mode parameter
+  305,  // Invalid text mode parameter
+  330,  // SMSC address unknown
+};
+
+bool smsErrorIsPermanent(int cmsError) {
+  if (cmsError < 0) return false;               // timeout / text bez kódu
+  for (uint16_t c : PERMANENT_CMS) {
+    if (c == cmsError) return true;
+  }
+  // TP-FCS 0x80–0x8F (TP-PID/DCS chyby) a 0xC0–0xCF (neplatná data)
+  if ((cmsError >= 0x80 && cmsError <= 0x8F) || (cmsError >= 0xC0 && cmsError <= 0xCF)) return true;
+  return false;
+}
+
+// "Equal jitter": polovina prodlevy pevně, druhá polovina náhodně
+uint32_t smsRetryDelay(uint8_t attempts) {
+  uint32_t base  = settings.smsRetryBaseMs ? settings.smsRetryBaseMs : 1000;
+  uint8_t  shift = attempts > 0 ? attempts - 1 : 0;
+  uint32_t d     = (shift >= 16 || (base << shift) > SMS_RETRY_MAX_DELAY)
+                 ? SMS_RETRY_MAX_DELAY : base << shift;
+  return d / 2 + (uint32_t)random((long)(d / 2) + 1);
+}
+
+// ====== Dead-letter seznam ======
+// Jeden JSON objekt na řádek: přidání je append, bez načítání celého pole.
+void smsDeadLetterInit() {
+  deadCount = jsonlCountLines(DEADLETTER_PATH);
+}
+
+void smsDeadLetterAdd(const SmsJobInfo& job, const char* text) {
+  if (deadCount >= SMS_DEADLETTER_MAX) {
+    jsonlKeepLast(DEADLETTER_PATH, DEADLETTER_TMP, deadCount, SMS_DEADLETTER_MAX - 1);
+    deadCount = SMS_DEADLETTER_MAX - 1;
+  }
+
+  StaticJsonDocument<256> doc;
+  doc["id"]         = job.id;
+  doc["timestamp"]  = time(nullptr);
+  doc["recipients"] = job.recipient;
+  doc["message"]    = text;               // odkaz, ne kopie
+  doc["attempts"]   = job.attempts;
+  doc["error"]      = job.lastError;
+  doc["permanent"]  = smsErrorIsPermanent(job.lastError);
+
+  if (!jsonlAppend(DEADLETTER_PATH, doc)) return;
+  deadCount++;
+
+  mqttPublishSmsFailed(job.id, job.recipient, job.lastError, job.attempts);
+}
+
+size_t smsDeadLetterCount() {
+  return deadCount;
+}
+
+void smsDeadLetterRequestClear()   { clearRequested = true; }
+void smsDeadLetterRequestRequeue() { requeueRequested = true; }
+
+// Odmítnuté záznamy se přepíšou do dočasného souboru, který pak
+// nahradí původní – nic se neztratí, když je fronta zrovna plná.
+static void requeueDeadLetters() {
+  File in = LittleFS.open(DEADLETTER_PATH, "r");
+  if (!in) return;
+  File out = LittleFS.open(DEADLETTER_TMP, "w");
+  if (!out) {
+    in.close();
+    LOG_E("zápis %s selhal, znovuzařazení zrušeno", DEADLETTER_TMP);
+    return;
+  }
+  StaticJsonDocument<1536> doc;
+  uint16_t requeued = 0, kept = 0;
+  while (in.available()) {
+    String line = in.readStringUntil('\n');
+    if (!line.length()) continue;
+    if (!deserializeJson(doc, line) &&
+        smsJobSubmit(doc["recipients"] | "", doc["message"] | "", SMS_SRC_LOCAL)) {
+      requeued++;
+      continue;
+    }
+    out.print(line);
+    out.print('\n');
+    kept++;
+  }
+  in.close();
+  out.close();
+  LittleFS.remove(DEADLETTER_PATH);
+  if (kept) LittleFS.rename(DEADLETTER_TMP, DEADLETTER_PATH);
+  else      LittleFS.remove(DEADLETTER_TMP);
+  deadCount = kept;
+  if (kept) LOG_W("dead-letter: znovu zařazeno %u, ve frontě nebylo místo pro %u",
+                  (unsigned)requeued, (unsigned)kept);
+  else      LOG_I("dead-letter: znovu zařazeno %u", (unsigned)requeued);
+}
+
+// Modemová úloha: vyřídí požadavky z HTTP
+void smsDeadLetterLoop() {
+  if (requeueRequested.exchange(false)) requeueDeadLetters();
+  if (clearRequested.exchange(false)) {
+    LittleFS.remove(DEADLETTER_PATH);
+    deadCount = 0;
+  }
+}
+
+void smsDeadLetterPrintJson(Print& out) {
+  jsonlPrintArray(out, DEADLETTER_PATH);
+}
@@ -0,0 +1,40 @@
+// sms_retry.h – opakování neúspěšných SMS a dead-letter seznam
+//
+// Politika: přechodné chyby (síť obsazená, timeout, bez signálu) se
+// opakují s exponenciálně rostoucí prodlevou a náhodným rozptylem, aby
+// se po výpadku buňky všechny SMS nevrhly na modem naráz. Trvalé chyby
+// (+CMS ERROR typu neplatné číslo, zákaz služby) se neopakují vůbec.
+// Úloha, která selže definitivně, skončí v /sms_deadletter.jsonl.
+
+#pragma once
+#include <Arduino.h>
+#include "sms_queue.h"
+
+// ======= Výchozí hodnoty (přepisuje settings.json) =======
+#ifndef SMS_RETRY_MAX_DELAY
+  #define SMS_RETRY_MAX_DELAY   600000UL   // strop prodlevy [ms]
+#endif
+#ifndef SMS_DEADLETTER_MAX
+  #define SMS_DEADLETTER_MAX    32         // počet uchovaných záznamů
+#endif
+
+// ======= Politika =======
+// Kód z +CMS ERROR (-1 = timeout / neznámý) → nemá smysl opakovat?
+bool     smsErrorIsPermanent(int cmsError);
+// Prodleva před pokusem attempts+1 (attempts = počet dosavadních pokusů)
+uint32_t smsRetryDelay(uint8_t attempts);
+
+// ======= Dead-letter seznam =======
+// Zápisy dělá jen modemová úloha; HTTP úloha čte soubor a mazání /
+// znovuzařazení jen vyžádá příznakem (vyřídí smsDeadLetterLoop()).
+void   smsDeadLetterInit();
+void   smsDeadLetterAdd(const SmsJobInfo& job, const char* text);
+void   smsDeadLetterLoop();
+size_t smsDeadLetterCount();
+void   smsDeadLetterRequestClear();
+// Vše znovu do fronty; v souboru zůstanou jen záznamy, které fronta
+// nepřijala (plná tabulka / pool textů)
+void   smsDeadLetterRequestRequeue();
+
+// Vypíše seznam jako JSON pole (čte soubor po řádcích)
+void   smsDeadLetterPrintJson(Print& out);
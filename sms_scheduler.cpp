@@ -0,0 +1,356 @@
+// sms_scheduler.cpp – plánované SMS (min-halda + log ve flash)
+#include "sms_scheduler.h"
+#include "sms_queue.h"
+#include "jsonl_file.h"
+#include <LittleFS.h>
+#include <time.h>
+
+#define LOG_TAG "SCHED"
+#include "log.h"
+
+static const char* SCHED_PATH = "/scheduled_sms.json";
+static const char* SCHED_TMP  = "/scheduled_sms.tmp";
+
+static constexpr uint16_t NONE       = 0xFFFF;
+static constexpr uint32_t TIME_VALID = 1672531200;   // 2023-01-01: čas z NTP/modemu už je nastaven
+
+// ====== Tabulka úloh + halda ======
+struct SchedEntry {
+  uint32_t id;           // 0 = volný slot
+  uint32_t due;
+  uint32_t repeat;
+  uint32_t offset;       // začátek záznamu v SCHED_PATH
+  uint32_t newOffset;    // v SCHED_TMP během kompakce
+  uint16_t heapPos;
+  bool     copied;       // kompakce: záznam už je v SCHED_TMP
+};
+
+static SchedEntry entries[SMS_SCHED_CAPACITY];
+static uint16_t   heap[SMS_SCHED_CAPACITY];
+static uint16_t   heapSize  = 0;
+static uint32_t   nextId    = 1;
+static uint32_t   deadLines = 0;     // řádky v logu, které už nic nenesou
+
+static bool before(uint16_t a, uint16_t b) {
+  return entries[heap[a]].due < entries[heap[b]].due;
+}
+
+static void heapSwap(uint16_t a, uint16_t b) {
+  uint16_t t = heap[a]; heap[a] = heap[b]; heap[b] = t;
+  entries[heap[a]].heapPos = a;
+  entries[heap[b]].heapPos = b;
+}
+
+static void siftUp(uint16_t i) {
+  while (i > 0) {
+    uint16_t p = (i - 1) / 2;
+    if (!before(i, p)) break;
+    heapSwap(i, p);
+    i = p;
+  }
+}
+
+static void siftDown(uint16_t i) {
+  for (;;) {
+    uint16_t l = 2 * i + 1, r = l + 1, m = i;
+    if (l < heapSize && before(l, m)) m = l;
+    if (r < heapSize && before(r, m)) m = r;
+    if (m == i) break;
+    heapSwap(i, m);
+    i = m;
+  }
+}
+
+static void heapPush(uint16_t slot) {
+  heap[heapSize] = slot;
+  entries[slot].heapPos = heapSize;
+  siftUp(heapSize++);
+}
+
+static void heapRemove(uint16_t pos) {
+  uint16_t last = --heapSize;
+  if (pos != last) {
+    heapSwap(pos, last);
+    siftDown(pos);
+    siftUp(pos);
+  }
+  entries[heap[last]].heapPos = NONE;
+}
+
+static uint16_t allocSlot() {
+  for (uint16_t i = 0; i < SMS_SCHED_CAPACITY; ++i) {
+    if (entries[i].id == 0) return i;
+  }
+  return NONE;
+}
+
+static uint16_t findSlot(uint32_t id) {
+  for (uint16_t i = 0; i < heapSize; ++i) {
+    if (entries[heap[i]].id == id) return heap[i];
+  }
+  return NONE;
+}
+
+// ====== Kompakce ======
+// Přepis živých záznamů do SCHED_TMP po COMPACT_STEP slotech na průchod.
+// Změny během kompakce (nové úlohy, přeplánování, zrušení) se zapisují
+// do obou souborů, takže přepnutí na konci nic neztratí.
+static constexpr uint16_t COMPACT_STEP = 4;
+static bool     compacting    = false;
+static uint16_t compactCursor = 0;
+
+static bool appendLine(const char* path, const JsonDocument& doc, uint32_t* offset) {
+  File f = LittleFS.open(path, "a");
+  if (!f) return false;
+  if (offset) *offset = f.size();
+  bool ok = serializeJson(doc, f) > 0;
+  f.print('\n');
+  f.close();
+  return ok;
+}
+
+static void logLine(const JsonDocument& doc) {
+  appendLine(SCHED_PATH, doc, nullptr);
+  if (compacting) appendLine(SCHED_TMP, doc, nullptr);
+  deadLines++;
+}
+
+static bool readRecord(const SchedEntry& e, JsonDocument& doc) {
+  File f = LittleFS.open(SCHED_PATH, "r");
+  if (!f) return false;
+  f.seek(e.offset);
+  String line = f.readStringUntil('\n');
+  f.close();
+  return deserializeJson(doc, line) == DeserializationError::Ok;
+}
+
+static StaticJsonDocument<2048> recDoc;   // jeden záznam (text + příjemci)
+
+static void compactStep() {
+  if (!compacting) {
+    if (deadLines < 32 || deadLines < heapSize) return;
+    LittleFS.remove(SCHED_TMP);
+    for (uint16_t i = 0; i < SMS_SCHED_CAPACITY; ++i) entries[i].copied = false;
+    compacting    = true;
+    compactCursor = 0;
+  }
+  for (uint16_t n = 0; n < COMPACT_STEP && compactCursor < SMS_SCHED_CAPACITY; ++compactCursor) {
+    SchedEntry& e = entries[compactCursor];
+    if (e.id == 0 || e.copied) continue;
+    if (readRecord(e, recDoc)) {
+      // aktuální stav bez historie; záznam ze starší verze (bez id,
+      // se sendTime) dostane id, pod kterým běží, jinak by se po startu
+      // odvodilo znovu podle pozice v přepsaném souboru
+      recDoc["id"]  = e.id;
+      recDoc["due"] = e.due;
+      recDoc.remove("sendTime");
+      e.copied = appendLine(SCHED_TMP, recDoc, &e.newOffset);
+    }
+    n++;
+  }
+  if (compactCursor < SMS_SCHED_CAPACITY) return;
+
+  // nečitelné záznamy by po přepnutí ukazovaly do smazaného souboru
+  for (uint16_t i = 0; i < SMS_SCHED_CAPACITY; ++i) {
+    if (entries[i].id && !entries[i].copied) {
+      LOG_W("#%u: poškozený záznam, vyřazen", (unsigned)entries[i].id);
+      heapRemove(entries[i].heapPos);
+      entries[i].id = 0;
+    }
+  }
+
+  LittleFS.remove(SCHED_PATH);
+  LittleFS.rename(SCHED_TMP, SCHED_PATH);
+  for (uint16_t i = 0; i < SMS_SCHED_CAPACITY; ++i) {
+    if (entries[i].id && entries[i].copied) entries[i].offset = entries[i].newOffset;
+  }
+  compacting = false;
+  deadLines  = 0;
+}
+
+// ====== Načtení logu ======
+// Jen pole potřebná pro haldu; text se při startu vůbec nečte.
+void smsSchedulerInit() {
+  heapSize = 0;
+  memset(entries, 0, sizeof(entries));
+  File f = LittleFS.open(SCHED_PATH, "r");
+  if (!f) return;
+
+  StaticJsonDocument<96> filter;
+  filter["id"] = true; filter["due"] = true; filter["repeat"] = true;
+  filter["upd"] = true; filter["done"] = true; filter["sendTime"] = true;
+  StaticJsonDocument<192> doc;
+
+  uint16_t used = 0;
+  while (f.available()) {
+    uint32_t offset = f.position();
+    String line = f.readStringUntil('\n');
+    if (deserializeJson(doc, line, DeserializationOption::Filter(filter))) continue;
+
+    uint32_t id = doc["id"] | 0;
+    if (id == 0 && doc.containsKey("sendTime")) {
+      id = nextId;                                // záznam z dřívější verze (bez id)
+    }
+    if (id >= nextId) nextId = id + 1;
+
+    if (doc.containsKey("upd") || doc.containsKey("done")) {   // přeplánování / zrušení
+      deadLines++;
+      for (uint16_t i = 0; i < used; ++i) {
+        if (entries[i].id != id) continue;
+        if (doc.containsKey("done")) entries[i].id = 0;
+        else                         entries[i].due = doc["due"];
+        break;
+      }
+      continue;
+    }
+    if (used >= SMS_SCHED_CAPACITY) { deadLines++; continue; }
+
+    SchedEntry& e = entries[used++];
+    e.id      = id;
+    e.due     = doc["due"] | smsParseSendTime(doc["sendTime"] | "");
+    e.repeat  = doc["repeat"] | 0;
+    e.offset  = offset;
+    e.heapPos = NONE;
+    if (!doc.containsKey("id")) deadLines++;      // kompakce doplní id (compactStep)
+  }
+  f.close();
+
+  for (uint16_t i = 0; i < used; ++i) {
+    if (entries[i].id) heapPush(i);
+    else deadLines++;
+  }
+  LOG_I("%u naplánovaných SMS, %u mrtvých řádků",
+        (unsigned)heapSize, (unsigned)deadLines);
+}
+
+// ====== Přidání / zrušení ======
+uint32_t smsSchedulerAdd(JsonArrayConst numbers, const char* message, uint32_t due, uint32_t repeat) {
+  if (!due || numbers.isNull() || numbers.size() == 0 || numbers.size() > SMS_SCHED_MAX_NUMBERS) return 0;
+  if (strlen(message) >= SMS_TEXT_MAX) return 0;
+  uint16_t slot = allocSlot();
+  if (slot == NONE) return 0;
+
+  recDoc.clear();
+  recDoc["id"]      = nextId;
+  recDoc["numbers"] = numbers;
+  recDoc["message"] = message;
+  recDoc["due"]     = due;
+  if (repeat) recDoc["repeat"] = repeat;
+
+  SchedEntry& e = entries[slot];
+  if (!appendLine(SCHED_PATH, recDoc, &e.offset)) return 0;
+  // během kompakce i do nového souboru (slot už kurzor možná přešel)
+  e.copied = compacting && appendLine(SCHED_TMP, recDoc, &e.newOffset);
+  e.id     = nextId++;
+  e.due    = due;
+  e.repeat = repeat;
+  heapPush(slot);
+  return e.id;
+}
+
+static void markDone(SchedEntry& e) {
+  StaticJsonDocument<64> d;
+  d["id"]   = e.id;
+  d["done"] = true;
+  logLine(d);
+  deadLines++;                                    // i původní záznam je teď mrtvý
+  e.id = 0;
+}
+
+bool smsSchedulerCancel(uint32_t id) {
+  uint16_t slot = findSlot(id);
+  if (slot == NONE) return false;
+  heapRemove(entries[slot].heapPos);
+  markDone(entries[slot]);
+  return true;
+}
+
+size_t smsSchedulerCount() {
+  return heapSize;
+}
+
+// ====== Odeslání ======
+static void fire(uint16_t slot) {
+  SchedEntry& e = entries[slot];
+  if (readRecord(e, recDoc)) {
+    const char* msg = recDoc["message"] | "";
+    for (JsonVariantConst n : recDoc["numbers"].as<JsonArrayConst>()) {
+      if (!smsJobSubmit(n | "", msg, SMS_SRC_HTTP)) {
+        LOG_W("#%u: fronta SMS plná, %s vynecháno", (unsigned)e.id, n | "");
+      }
+    }
+  }
+
+  if (e.repeat) {
+    // zmeškané periody (zařízení bylo vypnuté) se neodesílají hromadně
+    uint32_t now = time(nullptr);
+    do { e.due += e.repeat; } while (e.due <= now);
+    siftDown(e.heapPos);
+    StaticJsonDocument<64> d;
+    d["id"]  = e.id;
+    d["due"] = e.due;
+    d["upd"] = 1;
+    logLine(d);
+  } else {
+    heapRemove(e.heapPos);
+    markDone(e);
+  }
+}
+
+void smsSchedulerLoop() {
+  if (compacting || deadLines >= 32) compactStep();
+  if (!heapSize) return;
+  uint32_t now = time(nullptr);
+  if (now < TIME_VALID) return;                   // bez platného času nic neodesíláme
+  // jen vrchol haldy – O(1), dokud nic nedozrálo
+  for (uint8_t n = 0; n < 4 && heapSize && entries[heap[0]].due <= now; ++n) {
+    fire(heap[0]);
+  }
+}
+
+void smsSchedulerPrintJson(Print& out) {
+  out.print('[');
+  for (uint16_t i = 0; i < heapSize; ++i) {
+    const SchedEntry& e = entries[heap[i]];
+    if (i) out.print(',');
+    if (!readRecord(e, recDoc)) {
+      out.printf("{\"id\":%u,\"due\":%u}", (unsigned)e.id, (unsigned)e.due);
+      continue;
+    }
+    recDoc["id"]  = e.id;
+    recDoc["due"] = e.due;
+    serializeJson(recDoc, out);
+  }
+  out.print(']');
+}
+
+// ====== Parsování vstupu ======
+uint32_t smsParseSendTime(const char* s) {
+  if (!s || !*s) return 0;
+  int Y, M, D, h = 0, m = 0, sec = 0;
+  if (sscanf(s, "%d-%d-%dT%d:%d:%d", &Y, &M, &D, &h, &m, &sec) >= 5 ||
+      sscanf(s, "%d-%d-%d %d:%d:%d", &Y, &M, &D, &h, &m, &sec) >= 5) {
+    struct tm t = {};
+    t.tm_year  = Y - 1900;
+    t.tm_mon   = M - 1;
+    t.tm_mday  = D;
+    t.tm_hour  = h;
+    t.tm_min   = m;
+    t.tm_sec   = sec;
+    t.tm_isdst = -1;                               // podle TZ pravidel
+    time_t v = mktime(&t);
+    return v > 0 ? (uint32_t)v : 0;
+  }
+  char* end;
+  unsigned long v = strtoul(s, &end, 10);
+  return (*end == '\0') ? v : 0;
+}
+
+uint32_t smsParseRepeat(JsonVariantConst v) {
+  if (v.is<uint32_t>()) return v.as<uint32_t>();
+  const char* s = v | "";
+  if (!strcmp(s, "hourly")) return 3600;
+  if (!strcmp(s, "daily"))  return 86400;
+  if (!strcmp(s, "weekly")) return 7 * 86400;
+  return 0;
+}
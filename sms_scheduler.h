@@ -0,0 +1,42 @@
+// sms_scheduler.h – plánované SMS nad /scheduled_sms.json
+//
+// Soubor je log (JSON objekt na řádek): záznam úlohy, přeplánování
+// {"id":N,"due":T,"upd":1} a zrušení {"id":N,"done":true}. Při startu se z něj
+// sestaví tabulka úloh a min-halda podle času odeslání; smyčka pak jen
+// porovná vrchol haldy s aktuálním časem, takže její cena nezávisí na
+// počtu naplánovaných SMS. Text zprávy zůstává ve flash a čte se (seek)
+// až při odeslání. Mrtvé řádky odstraňuje kompakce po několika
+// záznamech na průchod, bez dlouhého blokování.
+//
+// Vše jen ze síťové nebo MQTT úlohy (obě drží ethLock); odeslání jde
+// do fronty SMS jako SMS_SRC_HTTP, jejímž producentem je síťová úloha.
+
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#ifndef SMS_SCHED_CAPACITY
+  #define SMS_SCHED_CAPACITY   1024   // naplánovaných úloh (24 B RAM každá)
+#endif
+#define SMS_SCHED_MAX_NUMBERS  20     // příjemců na jednu úlohu
+
+struct SmsScheduleInfo {
+  uint32_t id;
+  uint32_t due;          // epoch [s]
+  uint32_t repeat;       // perioda [s], 0 = jednorázově
+};
+
+void     smsSchedulerInit();
+void     smsSchedulerLoop();
+
+// Vrací ID (0 = plno / chyba zápisu / neplatné parametry)
+uint32_t smsSchedulerAdd(JsonArrayConst numbers, const char* message, uint32_t due, uint32_t repeat);
+bool     smsSchedulerCancel(uint32_t id);
+size_t   smsSchedulerCount();
+// Vypíše naplánované úlohy (včetně příjemců a textu) jako JSON pole
+void     smsSchedulerPrintJson(Print& out);
+
+// "2024-05-09T12:30" (datetime-local, místní čas dle TZ) nebo epoch → epoch, 0 = chyba
+uint32_t smsParseSendTime(const char* s);
+// "hourly"/"daily"/"weekly" nebo počet sekund → sekundy
+uint32_t smsParseRepeat(JsonVariantConst v);
@@ -0,0 +1,57 @@
+// bench_sms_pdu.cpp – doba smsPlan() + smsEncodeSubmit() pro typické texty
+//
+// Na hostiteli jde o relativní srovnání (před/po změně kodeku); ESP32
+// na 240 MHz je zhruba o řád pomalejší.
+#include "sms_pdu.h"
+#include <chrono>
+#include <string>
+
+struct Case {
+  const char* name;
+  std::string text;
+};
+
+static volatile size_t sink;   // ať překladač smyčku nevypustí
+
+static void run(const Case& c, int iters) {
+  SmsPlan plan;
+  char hex[SMS_PDU_HEX_MAX];
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iters; ++i) {
+    smsPlan(c.text.c_str(), plan);
+    for (uint8_t part = 0; part < plan.segments; ++part) {
+      sink = smsEncodeSubmit("+420777123456", c.text.c_str(), plan, part, (uint8_t)i, hex, sizeof(hex));
+    }
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  printf("%-14s %-5s %u seg  %8.0f ns/zpráva\n", c.name,
+         plan.encoding == SMS_ENC_GSM7 ? "GSM-7" : "UCS-2", (unsigned)plan.segments, ns / iters);
+}
+
+static void runDecode(int iters) {
+  SmsDeliver d;
+  const char* pdu = "07917283010010F5040BC87238880900F10000993092516195800AE8329BFD4697D9EC37";
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iters; ++i) {
+    smsDecodeDeliver(pdu, d);
+    sink = d.text[0];
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  printf("%-14s %-5s %u seg  %8.0f ns/zpráva\n", "deliver", "GSM-7", 1u, ns / iters);
+}
+
+int main() {
+  std::string czech;
+  for (int i = 0; i < 10; ++i) czech += "Příliš žluťoučký kůň ";
+  const Case cases[] = {
+    { "ascii-short",  "Vase overovaci kod je 123456" },
+    { "ascii-160",    std::string(160, 'x') },
+    { "gsm7-ext-300", std::string(150, 'a') + "{€}" + std::string(147, 'b') },
+    { "ucs2-czech",   czech },
+    { "ucs2-emoji",   "Ahoj 😀 světe 🚀!" },
+  };
+  const int iters = 20000;
+  for (const Case& c : cases) run(c, iters);
+  runDecode(iters);
+  return 0;
+}
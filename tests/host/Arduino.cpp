@@ -0,0 +1,42 @@
+// Arduino.cpp – hostitelská náhrada: čas od startu procesu, Serial, printf
+#include "Arduino.h"
+#include <chrono>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+
+static const auto start = std::chrono::steady_clock::now();
+static std::mt19937 rng(12345);     // opakovatelné běhy
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+long random(long max) {
+  return max > 0 ? (long)(rng() % (unsigned long)max) : 0;
+}
+
+long random(long min, long max) {
+  return max > min ? min + random(max - min) : min;
+}
+
+size_t Print::printf(const char* fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n <= 0) return 0;
+  return write((const uint8_t*)buf, min((size_t)n, sizeof(buf) - 1));
+}
@@ -0,0 +1,159 @@
+// Arduino.h – hostitelská náhrada jádra Arduino-ESP32 pro testy (tests/Makefile)
+//
+// Jen to, co moduly pod testem opravdu volají (úlohy modemu, sítě a
+// MQTT, soubory na LittleFS, JSON); chybějící funkce se má projevit
+// chybou překladu, ne tichou atrapou. Serial píše na stdout, čas běží
+// od startu procesu (host/Arduino.cpp). Stream na hostiteli nečeká na data (setTimeout
+// se ignoruje) – čte se ze souborů a z neblokujícího pty.
+
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <math.h>
+#include <sys/time.h>
+#include <time.h>
+#include "WString.h"
+
+using std::max;
+using std::min;
+
+#define F(s) (s)
+
+unsigned long millis();
+unsigned long micros();
+void          delay(unsigned long ms);
+inline void   yield() {}
+long          random(long max);
+long          random(long min, long max);
+
+// GPIO hostitel nemá (DTR modemu, reset W5500)
+#define INPUT   0
+#define OUTPUT  1
+#define LOW     0
+#define HIGH    1
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+// newlib ji má, glibc až od 2.38
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+inline size_t strlcpy(char* dst, const char* src, size_t cap) {
+  size_t n = strlen(src);
+  if (cap) {
+    size_t k = n < cap - 1 ? n : cap - 1;
+    memcpy(dst, src, k);
+    dst[k] = '\0';
+  }
+  return n;
+}
+#endif
+
+// Halda procesu (host/heap.cpp): obsazené bajty a špička od startu
+// nebo od posledního hostHeapResetPeak(); zahrnuje všechna vlákna
+size_t hostHeapUsed();
+size_t hostHeapPeak();
+void   hostHeapResetPeak();
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+// ESP.getFreeHeap(): halda modulu ESP32 mínus to, co proces právě drží
+#ifndef HOST_HEAP_SIZE
+  #define HOST_HEAP_SIZE (320u * 1024u)
+#endif
+class EspClass {
+public:
+  uint32_t getFreeHeap() {
+    size_t used = hostHeapUsed();
+    return used < HOST_HEAP_SIZE ? (uint32_t)(HOST_HEAP_SIZE - used) : 0;
+  }
+};
+inline EspClass ESP;
+
+class Print {
+public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t* p, size_t n) {
+    size_t k = 0;
+    while (k < n && write(p[k])) k++;
+    return k;
+  }
+  virtual int    availableForWrite() { return 0; }
+  virtual void   flush() {}
+
+  size_t write(const char* s)          { return write((const uint8_t*)s, strlen(s)); }
+  size_t write(const char* s, size_t n) { return write((const uint8_t*)s, n); }
+  size_t print(const char* s)          { return write(s); }
+  size_t print(const String& s)        { return write(s.c_str(), s.length()); }
+  size_t print(char c)                 { return write((uint8_t)c); }
+  size_t print(long v)                 { return printf("%ld", v); }
+  size_t print(int v)                  { return print((long)v); }
+  size_t print(unsigned long v)        { return printf("%lu", v); }
+  size_t print(unsigned v)             { return print((unsigned long)v); }
+  size_t println()                     { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T& v)           { return print(v) + println(); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void   setTimeout(unsigned long) {}
+  size_t readBytes(uint8_t* buf, size_t n) {
+    size_t k = 0;
+    for (int c; k < n && (c = read()) >= 0; ) buf[k++] = (uint8_t)c;
+    return k;
+  }
+  size_t readBytes(char* buf, size_t n) { return readBytes((uint8_t*)buf, n); }
+  size_t readBytesUntil(char end, char* buf, size_t n) {
+    size_t k = 0;
+    for (int c; k < n && (c = read()) >= 0 && c != end; ) buf[k++] = (char)c;
+    return k;
+  }
+  String readStringUntil(char end) {
+    String s;
+    for (int c; (c = read()) >= 0 && c != end; ) s += (char)c;
+    return s;
+  }
+  String readString() {
+    String s;
+    for (int c; (c = read()) >= 0; ) s += (char)c;
+    return s;
+  }
+  // Přečte vše až za první výskyt `target`
+  bool find(const char* target) {
+    size_t len = strlen(target), k = 0;
+    if (!len) return true;
+    for (int c; (c = read()) >= 0; ) {
+      if (c == target[k]) {
+        if (++k == len) return true;
+      } else {
+        k = c == target[0];
+      }
+    }
+    return false;
+  }
+  long parseInt() {
+    int c;
+    while ((c = peek()) >= 0 && c != '-' && !isdigit(c)) read();
+    bool neg = c == '-';
+    if (neg) read();
+    long v = 0;
+    while ((c = peek()) >= 0 && isdigit(c)) {
+      v = v * 10 + (c - '0');
+      read();
+    }
+    return neg ? -v : v;
+  }
+};
+
+#include "HardwareSerial.h"
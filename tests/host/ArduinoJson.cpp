@@ -0,0 +1,541 @@
+// ArduinoJson.cpp – pool, serializace a parser hostitelské náhrady
+#include "ArduinoJson.h"
+#include <cerrno>
+#include <new>
+
+namespace ajson {
+
+// ====== Pool ======
+Slot* Pool::allocSlot() {
+  if (slots_ < str_ + sizeof(Slot)) {
+    overflowed_ = true;
+    return nullptr;
+  }
+  slots_ -= sizeof(Slot);
+  return new (buf_ + slots_) Slot();
+}
+
+const char* Pool::saveString(const char* s, size_t n) {
+  if (str_ + n + 1 > slots_) {
+    overflowed_ = true;
+    return nullptr;
+  }
+  char* d = buf_ + str_;
+  memcpy(d, s, n);
+  d[n] = '\0';
+  str_ += n + 1;
+  return d;
+}
+
+void Pool::strAppend(char c) {
+  if (str_ + strLen_ + 1 >= slots_) {
+    overflowed_ = true;
+    return;
+  }
+  buf_[str_ + strLen_++] = c;
+}
+
+const char* Pool::strCommit() {
+  if (overflowed_) return nullptr;
+  char* d = buf_ + str_;
+  d[strLen_] = '\0';
+  str_ += strLen_ + 1;
+  return d;
+}
+
+// ====== Stromy ======
+Slot* findMember(const Data* obj, const char* key) {
+  if (!obj || obj->type != T_OBJECT || !key) return nullptr;
+  for (Slot* s = obj->head; s; s = s->next) {
+    if (strcmp(s->key, key) == 0) return s;
+  }
+  return nullptr;
+}
+
+static Slot* append(Data* d, Pool* pool) {
+  Slot* n = pool->allocSlot();
+  if (!n) return nullptr;
+  Slot** p = &d->head;
+  while (*p) p = &(*p)->next;
+  *p = n;
+  return n;
+}
+
+Slot* addMember(Data* obj, Pool* pool, const char* key, bool copyKey) {
+  if (!obj || !pool || !key) return nullptr;
+  if (obj->type == T_NULL) {
+    obj->type = T_OBJECT;
+    obj->head = nullptr;
+  }
+  if (obj->type != T_OBJECT) return nullptr;
+  if (Slot* s = findMember(obj, key)) return s;
+  if (copyKey && !(key = pool->saveString(key, strlen(key)))) return nullptr;
+  Slot* s = append(obj, pool);
+  if (s) s->key = key;
+  return s;
+}
+
+Slot* addElement(Data* arr, Pool* pool) {
+  if (!arr || !pool || arr->type != T_ARRAY) return nullptr;
+  return append(arr, pool);
+}
+
+size_t childCount(const Data* d) {
+  if (!d || (d->type != T_ARRAY && d->type != T_OBJECT)) return 0;
+  size_t n = 0;
+  for (const Slot* s = d->head; s; s = s->next) n++;
+  return n;
+}
+
+void setString(Data* d, Pool* pool, const char* s, size_t n, bool copy) {
+  *d = Data();
+  if (!s) return;
+  if (copy) {
+    if (!pool || !(s = pool->saveString(s, n))) return;
+    d->type = T_OWNED_STR;
+  } else {
+    d->type = T_LINKED_STR;
+  }
+  d->s = s;
+}
+
+// Hluboká kopie; řetězce z poolu zdroje se kopírují, odkazy zůstávají
+bool copyData(Data* dst, Pool* pool, const Data* src) {
+  *dst = Data();
+  if (!src) return true;
+  switch (src->type) {
+    case T_OWNED_STR:
+      setString(dst, pool, src->s, strlen(src->s), true);
+      return dst->type != T_NULL;
+    case T_ARRAY:
+    case T_OBJECT:
+      dst->type = src->type;
+      dst->head = nullptr;
+      for (const Slot* s = src->head; s; s = s->next) {
+        Slot* n = src->type == T_ARRAY ? addElement(dst, pool) : addMember(dst, pool, s->key, true);
+        if (!n || !copyData(&n->data, pool, &s->data)) return false;
+      }
+      return true;
+    default:
+      *dst = *src;
+      return true;
+  }
+}
+
+// ====== Serializace ======
+static size_t writeString(const char* s, Print& out) {
+  size_t n = out.print('"');
+  for (; *s; ++s) {
+    unsigned char c = *s;
+    const char* esc = nullptr;
+    switch (c) {
+      case '"':  esc = "\\\""; break;
+      case '\\': esc = "\\\\"; break;
+      case '\b': esc = "\\b";  break;
+      case '\f': esc = "\\f";  break;
+      case '\n': esc = "\\n";  break;
+      case '\r': esc = "\\r";  break;
+      case '\t': esc = "\\t";  break;
+    }
+    if (esc)          n += out.print(esc);
+    else if (c < 0x20) n += out.printf("\\u%04x", c);
+    else              n += out.write(c);
+  }
+  return n + out.print('"');
+}
+
+size_t serialize(const Data* d, Print& out) {
+  if (!d) return out.print("null");
+  switch (d->type) {
+    case T_BOOL:  return out.print(d->b ? "true" : "false");
+    case T_INT:   return out.printf("%lld", (long long)d->i);
+    case T_UINT:  return out.printf("%llu", (unsigned long long)d->u);
+    case T_FLOAT: return out.printf("%.9g", d->f);
+    case T_LINKED_STR:
+    case T_OWNED_STR:
+      return writeString(d->s, out);
+    case T_ARRAY:
+    case T_OBJECT: {
+      bool obj = d->type == T_OBJECT;
+      size_t n = out.print(obj ? '{' : '[');
+      for (const Slot* s = d->head; s; s = s->next) {
+        if (s != d->head) n += out.print(',');
+        if (obj) {
+          n += writeString(s->key, out);
+          n += out.print(':');
+        }
+        n += serialize(&s->data, out);
+      }
+      return n + out.print(obj ? '}' : ']');
+    }
+    default:
+      return out.print("null");
+  }
+}
+
+}  // namespace ajson
+
+namespace {
+
+// Počítá bajty, do bufferu zapíše, co se vejde (vždy s '\0')
+class BufferPrint : public Print {
+public:
+  BufferPrint(char* buf, size_t cap) : buf_(buf), cap_(cap) {}
+  size_t write(uint8_t b) override {
+    if (len_ + 1 >= cap_) return 0;
+    buf_[len_++] = (char)b;
+    return 1;
+  }
+  size_t length() const { return len_; }
+
+private:
+  char*  buf_;
+  size_t cap_;
+  size_t len_ = 0;
+};
+
+class CountPrint : public Print {
+public:
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t*, size_t n) override { return n; }
+};
+
+}  // namespace
+
+size_t serializeJson(JsonVariantConst v, char* buf, size_t cap) {
+  if (!cap) return 0;
+  BufferPrint out(buf, cap);
+  ajson::serialize(v.data(), out);
+  buf[out.length()] = '\0';
+  return out.length();
+}
+
+size_t measureJson(JsonVariantConst v) {
+  CountPrint out;
+  return ajson::serialize(v.data(), out);
+}
+
+void JsonDocument::remove(const char* key) {
+  if (root_.type != ajson::T_OBJECT) return;
+  for (ajson::Slot** p = &root_.head; *p; p = &(*p)->next) {
+    if (strcmp((*p)->key, key) == 0) {
+      *p = (*p)->next;               // místo v poolu se neuvolní (jako v knihovně)
+      return;
+    }
+  }
+}
+
+const char* DeserializationError::c_str() const {
+  static const char* const names[] = {
+    "Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"
+  };
+  return names[code_];
+}
+
+// ====== Parser ======
+namespace {
+
+using ajson::Data;
+using ajson::Pool;
+using ajson::Slot;
+typedef DeserializationError::Code Err;
+
+class StringReader {
+public:
+  explicit StringReader(const char* s) : p_(s ? s : "") {}
+  int  current() const { return *p_ ? (unsigned char)*p_ : -1; }
+  void move()          { if (*p_) ++p_; }
+
+private:
+  const char* p_;
+};
+
+// Znak se ze Streamu přečte až když je potřeba, nic dopředu
+class StreamReader {
+public:
+  explicit StreamReader(Stream& s) : s_(s) {}
+  int current() {
+    if (!loaded_) {
+      c_      = s_.read();
+      loaded_ = true;
+    }
+    return c_;
+  }
+  void move() { loaded_ = false; }
+
+private:
+  Stream& s_;
+  int     c_      = -1;
+  bool    loaded_ = false;
+};
+
+// Filtr pro podstrom: neaktivní = vše, jinak true / objekt klíčů
+struct Filter {
+  bool             all;
+  JsonVariantConst f;
+
+  bool allowValue() const  { return all || (f.is<bool>() && f.as<bool>()); }
+  bool allowArray() const  { return allowValue() || f.is<JsonArrayConst>(); }
+  bool allowObject() const { return allowValue() || f.is<JsonObject>(); }
+  bool allowAny() const    { return allowArray() || allowObject(); }
+  Filter member(const char* key) const {
+    if (allowValue()) return { true, JsonVariantConst() };
+    JsonVariantConst m = f[key];
+    return { false, m.isNull() ? f["*"] : m };
+  }
+  Filter element() const {
+    if (allowValue()) return { true, JsonVariantConst() };
+    return { false, f[(size_t)0] };
+  }
+};
+
+template <typename Reader>
+class Parser {
+public:
+  Parser(Reader& r, Pool& pool) : r_(r), pool_(pool) {}
+
+  Err parse(Data* out, Filter filter) {
+    int c = skipSpace();
+    if (c < 0) return DeserializationError::EmptyInput;
+    return value(out, filter, ARDUINOJSON_DEFAULT_NESTING_LIMIT);
+  }
+
+private:
+  int skipSpace() {
+    int c;
+    while ((c = r_.current()) == ' ' || c == '\t' || c == '\r' || c == '\n') r_.move();
+    return c;
+  }
+
+  bool eat(char expected) {
+    if (r_.current() != expected) return false;
+    r_.move();
+    return true;
+  }
+
+  // out == nullptr: hodnotu jen přeskočit
+  Err value(Data* out, const Filter& filter, int depth) {
+    switch (skipSpace()) {
+      case -1:  return DeserializationError::IncompleteInput;
+      case '{': return object(filter.allowObject() ? out : nullptr, filter, depth);
+      case '[': return array(filter.allowArray() ? out : nullptr, filter, depth);
+      case '"':
+      case '\'': {
+        bool keep = out && filter.allowValue();
+        const char* s = nullptr;
+        Err e = string(keep, s);
+        if (e == DeserializationError::Ok && keep) {
+          out->type = ajson::T_OWNED_STR;
+          out->s    = s;
+        }
+        return e;
+      }
+      default:
+        return literal(out && filter.allowValue() ? out : nullptr);
+    }
+  }
+
+  Err object(Data* out, const Filter& filter, int depth) {
+    if (depth <= 0) return DeserializationError::TooDeep;
+    r_.move();                               // '{'
+    if (out) {
+      out->type = ajson::T_OBJECT;
+      out->head = nullptr;
+    }
+    if (skipSpace() == '}') { r_.move(); return DeserializationError::Ok; }
+    for (;;) {
+      if (skipSpace() != '"' && r_.current() != '\'') {
+        return r_.current() < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+      }
+      const char* key = nullptr;
+      Err e = string(true, key);
+      if (e != DeserializationError::Ok) return e;
+      if (skipSpace() != ':') return r_.current() < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+      r_.move();
+      Filter mf = filter.member(key);
+      Data* target = nullptr;
+      if (out && mf.allowAny()) {
+        Slot* s = ajson::findMember(out, key);
+        if (!s) {
+          s = pool_.allocSlot();
+          if (!s) return DeserializationError::NoMemory;
+          Slot** p = &out->head;
+          while (*p) p = &(*p)->next;
+          *p = s;
+          s->key = key;
+        }
+        target = &s->data;
+      }
+      e = value(target, mf, depth - 1);
+      if (e != DeserializationError::Ok) return e;
+      int c = skipSpace();
+      r_.move();
+      if (c == '}') return DeserializationError::Ok;
+      if (c != ',') return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+    }
+  }
+
+  Err array(Data* out, const Filter& filter, int depth) {
+    if (depth <= 0) return DeserializationError::TooDeep;
+    r_.move();                               // '['
+    if (out) {
+      out->type = ajson::T_ARRAY;
+      out->head = nullptr;
+    }
+    if (skipSpace() == ']') { r_.move(); return DeserializationError::Ok; }
+    Filter ef = filter.element();
+    for (;;) {
+      Data* target = nullptr;
+      if (out) {
+        Slot* s = ajson::addElement(out, &pool_);
+        if (!s) return DeserializationError::NoMemory;
+        target = &s->data;
+      }
+      Err e = value(target, ef, depth - 1);
+      if (e != DeserializationError::Ok) return e;
+      int c = skipSpace();
+      r_.move();
+      if (c == ']') return DeserializationError::Ok;
+      if (c != ',') return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+    }
+  }
+
+  void appendUtf8(uint32_t cp, bool keep) {
+    if (!keep) return;
+    if (cp < 0x80) {
+      pool_.strAppend((char)cp);
+    } else if (cp < 0x800) {
+      pool_.strAppend((char)(0xC0 | (cp >> 6)));
+      pool_.strAppend((char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      pool_.strAppend((char)(0xE0 | (cp >> 12)));
+      pool_.strAppend((char)(0x80 | ((cp >> 6) & 0x3F)));
+      pool_.strAppend((char)(0x80 | (cp & 0x3F)));
+    } else {
+      pool_.strAppend((char)(0xF0 | (cp >> 18)));
+      pool_.strAppend((char)(0x80 | ((cp >> 12) & 0x3F)));
+      pool_.strAppend((char)(0x80 | ((cp >> 6) & 0x3F)));
+      pool_.strAppend((char)(0x80 | (cp & 0x3F)));
+    }
+  }
+
+  bool hex4(uint32_t& v) {
+    v = 0;
+    for (int i = 0; i < 4; ++i) {
+      int c = r_.current();
+      int d = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+              c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+      if (d < 0) return false;
+      v = v * 16 + d;
+      r_.move();
+    }
+    return true;
+  }
+
+  Err string(bool keep, const char*& out) {
+    int quote = r_.current();
+    r_.move();
+    if (keep) pool_.strStart();
+    for (;;) {
+      int c = r_.current();
+      if (c < 0) return DeserializationError::IncompleteInput;
+      r_.move();
+      if (c == quote) break;
+      if (c != '\\') {
+        if (keep) pool_.strAppend((char)c);
+        continue;
+      }
+      c = r_.current();
+      if (c < 0) return DeserializationError::IncompleteInput;
+      r_.move();
+      switch (c) {
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u': {
+          uint32_t cp, lo;
+          if (!hex4(cp)) return DeserializationError::InvalidInput;
+          if (cp >= 0xD800 && cp < 0xDC00) {
+            if (!eat('\\') || !eat('u') || !hex4(lo)) return DeserializationError::InvalidInput;
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+          }
+          appendUtf8(cp, keep);
+          continue;
+        }
+      }
+      if (keep) pool_.strAppend((char)c);
+    }
+    if (!keep) return DeserializationError::Ok;
+    out = pool_.strCommit();
+    return out ? DeserializationError::Ok : DeserializationError::NoMemory;
+  }
+
+  // Číslo nebo true/false/null; čte se až po první znak, který k nim nepatří
+  Err literal(Data* out) {
+    char buf[64];
+    size_t n = 0;
+    for (int c; (c = r_.current()) >= 0 && (isalnum(c) || c == '+' || c == '-' || c == '.'); r_.move()) {
+      if (n + 1 >= sizeof(buf)) return DeserializationError::InvalidInput;
+      buf[n++] = (char)c;
+    }
+    buf[n] = '\0';
+    if (!n) return r_.current() < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+    Data d;
+    if (!strcmp(buf, "true") || !strcmp(buf, "false")) {
+      d.type = ajson::T_BOOL;
+      d.b    = buf[0] == 't';
+    } else if (!strcmp(buf, "null")) {
+      // zůstává T_NULL
+    } else {
+      char* end;
+      errno = 0;
+      if (buf[0] == '-') {
+        long long v = strtoll(buf, &end, 10);
+        if (!*end && !errno) { d.type = ajson::T_INT; d.i = v; }
+      } else {
+        unsigned long long v = strtoull(buf, &end, 10);
+        if (!*end && !errno) { d.type = ajson::T_UINT; d.u = v; }
+      }
+      if (d.type == ajson::T_NULL) {
+        d.f = strtod(buf, &end);
+        if (*end) return DeserializationError::InvalidInput;
+        d.type = ajson::T_FLOAT;
+      }
+    }
+    if (out) *out = d;
+    return DeserializationError::Ok;
+  }
+
+  Reader& r_;
+  Pool&   pool_;
+};
+
+template <typename Reader>
+DeserializationError run(JsonDocument& doc, Reader& r, DeserializationOption::Filter filter) {
+  doc.clear();
+  Data root;
+  Parser<Reader> p(r, doc.pool());
+  Err e = p.parse(&root, Filter{ !filter.active(), filter.filter() });
+  if (e != DeserializationError::Ok) {
+    doc.clear();
+    return e;
+  }
+  *doc.getVariant().data() = root;
+  return DeserializationError::Ok;
+}
+
+}  // namespace
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input,
+                                     DeserializationOption::Filter filter) {
+  StringReader r(input);
+  return run(doc, r, filter);
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input,
+                                     DeserializationOption::Filter filter) {
+  StreamReader r(input);
+  return run(doc, r, filter);
+}
@@ -0,0 +1,546 @@
+// ArduinoJson.h – hostitelská náhrada ArduinoJson 6 (podmnožina API)
+//
+// Jen to, co moduly přeložené v tests/ volají: StaticJsonDocument s pevným
+// poolem uvnitř dokumentu (na haldě se nic nealokuje), proxy doc["k"],
+// operátor |, serializeJson/measureJson a deserializeJson z řetězce nebo
+// ze Streamu včetně DeserializationOption::Filter. Sémantika jako
+// v knihovně: const char* se ukládá odkazem, String, char* a vše
+// z deserializace se kopíruje do poolu; ze Streamu se čte po znacích
+// a nic za hodnotou (objekty v souboru jdou číst za sebou). Slot má na
+// 64bit hostiteli 32 B jako knihovna, tedy dvakrát víc než na ESP32.
+
+#pragma once
+#include <Arduino.h>
+#include <limits>
+#include <type_traits>
+
+#ifndef ARDUINOJSON_DEFAULT_NESTING_LIMIT
+  #define ARDUINOJSON_DEFAULT_NESTING_LIMIT 10
+#endif
+
+namespace ajson {
+
+enum Type : uint8_t {
+  T_NULL, T_BOOL, T_INT, T_UINT, T_FLOAT,
+  T_LINKED_STR,   // const char* mimo pool
+  T_OWNED_STR,    // kopie v poolu
+  T_ARRAY, T_OBJECT
+};
+
+struct Slot;
+
+struct Data {
+  union {
+    bool        b;
+    int64_t     i;
+    uint64_t    u;
+    double      f;
+    const char* s;
+    Slot*       head;    // první prvek / člen
+  };
+  Type type = T_NULL;
+
+  Data() : u(0) {}
+  bool isString() const { return type == T_LINKED_STR || type == T_OWNED_STR; }
+};
+
+struct Slot {
+  Data        data;
+  const char* key  = nullptr;   // jen členy objektu
+  Slot*       next = nullptr;
+};
+
+// Řetězce rostou od začátku bufferu, sloty od konce
+class Pool {
+public:
+  Pool(char* buf, size_t cap) : buf_(buf), cap_(cap) { clear(); }
+  void   clear() { str_ = 0; slots_ = cap_ & ~(size_t)(alignof(Slot) - 1); overflowed_ = false; }
+  Slot*  allocSlot();
+  const char* saveString(const char* s, size_t n);
+  // Postupné skládání řetězce (parser): start, append…, commit
+  void   strStart()        { strLen_ = 0; }
+  void   strAppend(char c);
+  const char* strCommit();
+  size_t used() const      { return str_ + (cap_ - slots_); }
+  size_t capacity() const  { return cap_; }
+  bool   overflowed() const { return overflowed_; }
+
+private:
+  char*  buf_;
+  size_t cap_;
+  size_t str_;
+  size_t slots_;
+  size_t strLen_ = 0;
+  bool   overflowed_;
+};
+
+Slot*       findMember(const Data* obj, const char* key);
+Slot*       addMember(Data* obj, Pool* pool, const char* key, bool copyKey);
+Slot*       addElement(Data* arr, Pool* pool);
+size_t      childCount(const Data* d);
+bool        copyData(Data* dst, Pool* pool, const Data* src);
+void        setString(Data* d, Pool* pool, const char* s, size_t n, bool copy);
+
+size_t      serialize(const Data* d, Print& out);
+
+// createNestedObject/Array: člen `key` (existující se přepíše) jako prázdný kontejner
+inline Data* addNested(Data* obj, Pool* pool, const char* key, Type t) {
+  Slot* s = addMember(obj, pool, key, false);
+  if (!s) return nullptr;
+  s->data.type = t;
+  s->data.head = nullptr;
+  return &s->data;
+}
+
+template <typename T>
+struct IsInt : std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, bool>::value> {};
+
+// Přečte hodnotu typu T z `d` (stejné převody jako ArduinoJson 6)
+template <typename T>
+bool dataIs(const Data* d) {
+  if (!d) return false;
+  if constexpr (std::is_same<T, bool>::value) {
+    return d->type == T_BOOL;
+  } else if constexpr (IsInt<T>::value) {
+    if (d->type == T_INT) {
+      return d->i >= (int64_t)std::numeric_limits<T>::min() &&
+             (std::is_signed<T>::value || d->i >= 0) &&
+             (d->i < 0 || (uint64_t)d->i <= (uint64_t)std::numeric_limits<T>::max());
+    }
+    return d->type == T_UINT && d->u <= (uint64_t)std::numeric_limits<T>::max();
+  } else if constexpr (std::is_floating_point<T>::value) {
+    return d->type == T_INT || d->type == T_UINT || d->type == T_FLOAT;
+  } else if constexpr (std::is_same<T, const char*>::value || std::is_same<T, String>::value) {
+    return d->isString();
+  } else {
+    return false;
+  }
+}
+
+// as<String>(): ostatní hodnoty jako JSON, chybějící jako "null"
+class StringPrint : public Print {
+public:
+  size_t write(uint8_t b) override { str += (char)b; return 1; }
+  String str;
+};
+
+template <typename T>
+T dataAs(const Data* d) {
+  if constexpr (std::is_same<T, String>::value) {
+    if (d && d->isString()) return String(d->s);
+    StringPrint out;
+    if (d) serialize(d, out);
+    else   out.print("null");
+    return out.str;
+  } else if (!d) {
+    return T();
+  } else if constexpr (std::is_same<T, bool>::value) {
+    switch (d->type) {
+      case T_BOOL:  return d->b;
+      case T_INT:   return d->i != 0;
+      case T_UINT:  return d->u != 0;
+      case T_FLOAT: return d->f != 0;
+      default:      return d->type != T_NULL;
+    }
+  } else if constexpr (IsInt<T>::value) {
+    if (d->type == T_FLOAT) return (T)d->f;
+    if (d->type == T_BOOL)  return (T)d->b;
+    return dataIs<T>(d) ? (d->type == T_INT ? (T)d->i : (T)d->u) : T();
+  } else if constexpr (std::is_floating_point<T>::value) {
+    return d->type == T_INT ? (T)d->i : d->type == T_UINT ? (T)d->u : d->type == T_FLOAT ? (T)d->f : T();
+  } else if constexpr (std::is_same<T, const char*>::value) {
+    return d->isString() ? d->s : nullptr;
+  } else {
+    static_assert(sizeof(T) == 0, "ArduinoJson (host): nepodporovaný typ");
+  }
+}
+
+template <typename T>
+using EnableScalar = typename std::enable_if<std::is_arithmetic<T>::value>::type;
+
+}  // namespace ajson
+
+class JsonArray;
+class JsonArrayConst;
+class JsonObject;
+class JsonObjectConst;
+class JsonDocument;
+class MemberProxy;
+
+// ====== Jen pro čtení ======
+class JsonVariantConst {
+public:
+  JsonVariantConst(const ajson::Data* d = nullptr) : d_(d) {}
+
+  bool   isNull() const { return !d_ || d_->type == ajson::T_NULL; }
+  size_t size() const   { return ajson::childCount(d_); }
+  bool   containsKey(const char* key) const { return ajson::findMember(d_, key) != nullptr; }
+
+  template <typename T> bool is() const;
+  template <typename T> T    as() const;
+  template <typename T> operator T() const { return as<T>(); }
+
+  JsonVariantConst operator[](const char* key) const;
+  JsonVariantConst operator[](size_t index) const;
+
+  const char* operator|(const char* def) const {
+    const char* s = ajson::dataAs<const char*>(d_);
+    return s ? s : def;
+  }
+  template <typename T, typename = ajson::EnableScalar<T>>
+  T operator|(T def) const { return ajson::dataIs<T>(d_) ? ajson::dataAs<T>(d_) : def; }
+
+  const ajson::Data* data() const { return d_; }
+
+private:
+  const ajson::Data* d_;
+};
+
+// ====== Zapisovatelná hodnota v dokumentu ======
+class JsonVariant {
+public:
+  JsonVariant(ajson::Data* d = nullptr, ajson::Pool* p = nullptr) : d_(d), pool_(p) {}
+
+  bool   isNull() const { return !d_ || d_->type == ajson::T_NULL; }
+  size_t size() const   { return ajson::childCount(d_); }
+  bool   containsKey(const char* key) const { return ajson::findMember(d_, key) != nullptr; }
+
+  template <typename T> bool is() const { return JsonVariantConst(d_).is<T>(); }
+  template <typename T> T    as() const;
+  template <typename T> operator T() const { return as<T>(); }
+  operator JsonVariantConst() const { return JsonVariantConst(d_); }
+
+  bool set(const char* s)              { return store(s, s ? strlen(s) : 0, false); }
+  bool set(char* s)                    { return store(s, s ? strlen(s) : 0, true); }
+  bool set(const String& s)            { return store(s.c_str(), s.length(), true); }
+  bool set(JsonVariantConst v)         { return d_ && ajson::copyData(d_, pool_, v.data()); }
+  bool set(JsonArrayConst a);
+  template <typename T, typename = ajson::EnableScalar<T>>
+  bool set(T v) {
+    if (!d_) return false;
+    if constexpr (std::is_same<T, bool>::value) {
+      d_->type = ajson::T_BOOL; d_->b = v;
+    } else if constexpr (std::is_floating_point<T>::value) {
+      d_->type = ajson::T_FLOAT; d_->f = v;
+    } else if constexpr (std::is_signed<T>::value) {
+      d_->type = v < 0 ? ajson::T_INT : ajson::T_UINT;
+      if (v < 0) d_->i = v; else d_->u = (uint64_t)v;
+    } else {
+      d_->type = ajson::T_UINT; d_->u = v;
+    }
+    return true;
+  }
+
+  MemberProxy operator[](const char* key) const;
+  MemberProxy operator[](char* key) const;
+  JsonVariant operator[](size_t index) const;
+
+  const char* operator|(const char* def) const { return JsonVariantConst(d_) | def; }
+  template <typename T, typename = ajson::EnableScalar<T>>
+  T operator|(T def) const { return JsonVariantConst(d_) | def; }
+
+  ajson::Data* data() const { return d_; }
+  ajson::Pool* pool() const { return pool_; }
+
+private:
+  bool store(const char* s, size_t n, bool copy) {
+    if (!d_) return false;
+    ajson::setString(d_, pool_, s, n, copy);
+    return d_->type != ajson::T_NULL || !s;
+  }
+  ajson::Data* d_;
+  ajson::Pool* pool_;
+};
+
+// doc["k"] – člen se založí až zápisem
+class MemberProxy {
+public:
+  MemberProxy(ajson::Data* obj, ajson::Pool* pool, const char* key, bool copyKey)
+    : obj_(obj), pool_(pool), key_(key), copyKey_(copyKey) {}
+
+  template <typename T>
+  MemberProxy& operator=(const T& v) { getOrAdd().set(v); return *this; }
+  MemberProxy& operator=(const char* v) { getOrAdd().set(v); return *this; }
+  MemberProxy& operator=(char* v)       { getOrAdd().set(v); return *this; }
+  MemberProxy& operator=(const MemberProxy& v) { getOrAdd().set(JsonVariantConst(v.get())); return *this; }
+
+  bool   isNull() const { return JsonVariantConst(get()).isNull(); }
+  size_t size() const   { return JsonVariantConst(get()).size(); }
+  bool   containsKey(const char* key) const { return JsonVariantConst(get()).containsKey(key); }
+  template <typename T> bool is() const { return JsonVariantConst(get()).is<T>(); }
+  template <typename T> T    as() const { return JsonVariant(get(), pool_).as<T>(); }
+  template <typename T> operator T() const { return as<T>(); }
+  operator JsonVariantConst() const { return JsonVariantConst(get()); }
+
+  MemberProxy operator[](const char* key) const { return MemberProxy(getOrAdd().data(), pool_, key, false); }
+  MemberProxy operator[](char* key) const       { return MemberProxy(getOrAdd().data(), pool_, key, true); }
+
+  const char* operator|(const char* def) const { return JsonVariantConst(get()) | def; }
+  template <typename T, typename = ajson::EnableScalar<T>>
+  T operator|(T def) const { return JsonVariantConst(get()) | def; }
+
+private:
+  ajson::Data* get() const {
+    ajson::Slot* s = ajson::findMember(obj_, key_);
+    return s ? &s->data : nullptr;
+  }
+  JsonVariant getOrAdd() const {
+    ajson::Slot* s = ajson::addMember(obj_, pool_, key_, copyKey_);
+    return JsonVariant(s ? &s->data : nullptr, pool_);
+  }
+  ajson::Data* obj_;
+  ajson::Pool* pool_;
+  const char*  key_;
+  bool         copyKey_;
+};
+
+// ====== Pole a objekty ======
+class JsonArrayConst {
+public:
+  class iterator {
+  public:
+    explicit iterator(const ajson::Slot* s) : s_(s) {}
+    JsonVariantConst operator*() const { return JsonVariantConst(&s_->data); }
+    iterator& operator++() { s_ = s_->next; return *this; }
+    bool operator!=(const iterator& o) const { return s_ != o.s_; }
+  private:
+    const ajson::Slot* s_;
+  };
+
+  JsonArrayConst(const ajson::Data* d = nullptr) : d_(d && d->type == ajson::T_ARRAY ? d : nullptr) {}
+  bool     isNull() const { return !d_; }
+  size_t   size() const   { return ajson::childCount(d_); }
+  iterator begin() const  { return iterator(d_ ? d_->head : nullptr); }
+  iterator end() const    { return iterator(nullptr); }
+  JsonVariantConst operator[](size_t i) const { return JsonVariantConst(d_)[i]; }
+  const ajson::Data* data() const { return d_; }
+
+private:
+  const ajson::Data* d_;
+};
+
+class JsonArray {
+public:
+  JsonArray(ajson::Data* d = nullptr, ajson::Pool* p = nullptr)
+    : d_(d && d->type == ajson::T_ARRAY ? d : nullptr), pool_(p) {}
+  bool   isNull() const { return !d_; }
+  size_t size() const   { return ajson::childCount(d_); }
+  JsonVariant operator[](size_t i) const { return JsonVariant(d_, pool_)[i]; }
+  template <typename T>
+  bool add(const T& v) {
+    ajson::Slot* s = d_ ? ajson::addElement(d_, pool_) : nullptr;
+    return s && JsonVariant(&s->data, pool_).set(v);
+  }
+  operator JsonArrayConst() const { return JsonArrayConst(d_); }
+
+private:
+  ajson::Data* d_;
+  ajson::Pool* pool_;
+};
+
+class JsonObjectConst {
+public:
+  JsonObjectConst(const ajson::Data* d = nullptr) : d_(d && d->type == ajson::T_OBJECT ? d : nullptr) {}
+  bool   isNull() const { return !d_; }
+  size_t size() const   { return ajson::childCount(d_); }
+  bool   containsKey(const char* key) const { return ajson::findMember(d_, key) != nullptr; }
+  JsonVariantConst operator[](const char* key) const { return JsonVariantConst(d_)[key]; }
+
+private:
+  const ajson::Data* d_;
+};
+
+class JsonObject {
+public:
+  JsonObject(ajson::Data* d = nullptr, ajson::Pool* p = nullptr)
+    : d_(d && d->type == ajson::T_OBJECT ? d : nullptr), pool_(p) {}
+  bool   isNull() const { return !d_; }
+  size_t size() const   { return ajson::childCount(d_); }
+  bool   containsKey(const char* key) const { return ajson::findMember(d_, key) != nullptr; }
+  MemberProxy operator[](const char* key) const { return MemberProxy(d_, pool_, key, false); }
+  MemberProxy operator[](char* key) const       { return MemberProxy(d_, pool_, key, true); }
+  JsonObject  createNestedObject(const char* key) const;
+  JsonArray   createNestedArray(const char* key) const;
+  operator JsonObjectConst() const { return JsonObjectConst(d_); }
+
+private:
+  ajson::Data* d_;
+  ajson::Pool* pool_;
+};
+
+// ====== Převody ======
+template <typename T>
+bool JsonVariantConst::is() const {
+  if constexpr (std::is_same<T, JsonObject>::value || std::is_same<T, JsonObjectConst>::value) {
+    return d_ && d_->type == ajson::T_OBJECT;
+  } else if constexpr (std::is_same<T, JsonArray>::value || std::is_same<T, JsonArrayConst>::value) {
+    return d_ && d_->type == ajson::T_ARRAY;
+  } else {
+    return ajson::dataIs<T>(d_);
+  }
+}
+
+template <typename T>
+T JsonVariantConst::as() const {
+  if constexpr (std::is_same<T, JsonArrayConst>::value || std::is_same<T, JsonObjectConst>::value ||
+                std::is_same<T, JsonVariantConst>::value) {
+    return T(d_);
+  } else {
+    return ajson::dataAs<T>(d_);
+  }
+}
+
+template <typename T>
+T JsonVariant::as() const {
+  if constexpr (std::is_same<T, JsonArray>::value || std::is_same<T, JsonObject>::value ||
+                std::is_same<T, JsonVariant>::value) {
+    return T(d_, pool_);
+  } else {
+    return JsonVariantConst(d_).as<T>();
+  }
+}
+
+inline JsonObject JsonObject::createNestedObject(const char* key) const {
+  return JsonObject(d_ ? ajson::addNested(d_, pool_, key, ajson::T_OBJECT) : nullptr, pool_);
+}
+
+inline JsonArray JsonObject::createNestedArray(const char* key) const {
+  return JsonArray(d_ ? ajson::addNested(d_, pool_, key, ajson::T_ARRAY) : nullptr, pool_);
+}
+
+inline bool JsonVariant::set(JsonArrayConst a) {
+  return d_ && ajson::copyData(d_, pool_, a.data());
+}
+
+inline JsonVariantConst JsonVariantConst::operator[](const char* key) const {
+  ajson::Slot* s = ajson::findMember(d_, key);
+  return JsonVariantConst(s ? &s->data : nullptr);
+}
+
+inline JsonVariantConst JsonVariantConst::operator[](size_t index) const {
+  if (!d_ || d_->type != ajson::T_ARRAY) return JsonVariantConst();
+  const ajson::Slot* s = d_->head;
+  while (s && index--) s = s->next;
+  return JsonVariantConst(s ? &s->data : nullptr);
+}
+
+inline MemberProxy JsonVariant::operator[](const char* key) const { return MemberProxy(d_, pool_, key, false); }
+inline MemberProxy JsonVariant::operator[](char* key) const       { return MemberProxy(d_, pool_, key, true); }
+
+inline JsonVariant JsonVariant::operator[](size_t index) const {
+  if (!d_ || d_->type != ajson::T_ARRAY) return JsonVariant();
+  ajson::Slot* s = d_->head;
+  while (s && index--) s = s->next;
+  return JsonVariant(s ? &s->data : nullptr, pool_);
+}
+
+// ====== Dokument ======
+class JsonDocument {
+public:
+  JsonDocument(const JsonDocument&) = delete;
+  JsonDocument& operator=(const JsonDocument&) = delete;
+
+  void   clear()            { pool_.clear(); root_ = ajson::Data(); }
+  bool   isNull() const     { return root_.type == ajson::T_NULL; }
+  size_t size() const       { return ajson::childCount(&root_); }
+  size_t capacity() const   { return pool_.capacity(); }
+  size_t memoryUsage() const { return pool_.used(); }
+  bool   overflowed() const { return pool_.overflowed(); }
+
+  bool containsKey(const char* key) const { return ajson::findMember(&root_, key) != nullptr; }
+  void remove(const char* key);
+
+  template <typename T> bool is() const { return JsonVariantConst(&root_).is<T>(); }
+  template <typename T> T    as()       { return JsonVariant(&root_, &pool_).as<T>(); }
+  template <typename T> T    as() const { return JsonVariantConst(&root_).as<T>(); }
+
+  bool set(JsonVariantConst v) { clear(); return ajson::copyData(&root_, &pool_, v.data()); }
+  template <typename T>
+  bool add(const T& v) {
+    if (root_.type == ajson::T_NULL) {
+      root_.type = ajson::T_ARRAY;
+      root_.head = nullptr;
+    }
+    return JsonArray(&root_, &pool_).add(v);
+  }
+
+  MemberProxy      operator[](const char* key)       { return MemberProxy(&root_, &pool_, key, false); }
+  MemberProxy      operator[](char* key)             { return MemberProxy(&root_, &pool_, key, true); }
+  JsonObject createNestedObject(const char* key) {
+    return JsonObject(ajson::addNested(&root_, &pool_, key, ajson::T_OBJECT), &pool_);
+  }
+  JsonArray createNestedArray(const char* key) {
+    return JsonArray(ajson::addNested(&root_, &pool_, key, ajson::T_ARRAY), &pool_);
+  }
+  JsonVariantConst operator[](const char* key) const { return JsonVariantConst(&root_)[key]; }
+
+  operator JsonVariantConst() const { return JsonVariantConst(&root_); }
+  JsonVariant      getVariant()     { return JsonVariant(&root_, &pool_); }
+  ajson::Pool&     pool()           { return pool_; }
+
+protected:
+  JsonDocument(char* buf, size_t cap) : pool_(buf, cap) {}
+
+private:
+  ajson::Pool pool_;
+  ajson::Data root_;
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument {
+public:
+  StaticJsonDocument() : JsonDocument(buf_, N) {}
+
+private:
+  alignas(ajson::Slot) char buf_[N];
+};
+
+// ====== Serializace ======
+inline size_t serializeJson(JsonVariantConst v, Print& out) {
+  return ajson::serialize(v.data(), out);
+}
+size_t serializeJson(JsonVariantConst v, char* buf, size_t cap);
+template <size_t N>
+size_t serializeJson(JsonVariantConst v, char (&buf)[N]) {
+  return serializeJson(v, buf, N);
+}
+size_t measureJson(JsonVariantConst v);
+
+// ====== Deserializace ======
+class DeserializationError {
+public:
+  enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+  DeserializationError(Code c = Ok) : code_(c) {}
+  explicit operator bool() const { return code_ != Ok; }
+  bool operator==(Code c) const  { return code_ == c; }
+  bool operator!=(Code c) const  { return code_ != c; }
+  Code code() const              { return code_; }
+  const char* c_str() const;
+
+private:
+  Code code_;
+};
+
+namespace DeserializationOption {
+  // Filtr: true = hodnotu ponechat, objekt = jen uvedené klíče ("*" = všechny)
+  class Filter {
+  public:
+    Filter() = default;                      // bez filtru: vše
+    explicit Filter(JsonVariantConst f) : f_(f), active_(true) {}
+    bool             active() const { return active_; }
+    JsonVariantConst filter() const { return f_; }
+  private:
+    JsonVariantConst f_;
+    bool             active_ = false;
+  };
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input,
+                                     DeserializationOption::Filter filter = {});
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input,
+                                     DeserializationOption::Filter filter = {});
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& input,
+                                            DeserializationOption::Filter filter = {}) {
+  return deserializeJson(doc, input.c_str(), filter);
+}
@@ -0,0 +1,37 @@
+// Ethernet.h – hostitelská náhrada knihovny Ethernet (W5500)
+//
+// Síť na hostiteli není: EthernetServer nikoho nepřijme a klient je
+// vždy odpojený. Stačí to, aby se přeložil HTTP server (http_server.cpp)
+// a handlery v mqtt_module.cpp; požadavky HTTP zakládá tests/host_modem.cpp.
+
+#pragma once
+#include <Arduino.h>
+
+#ifndef MAX_SOCK_NUM
+  #define MAX_SOCK_NUM 8      // W5500
+#endif
+
+class EthernetClient : public Stream {
+public:
+  int     available() override { return 0; }
+  int     read() override      { return -1; }
+  int     peek() override      { return -1; }
+  int     read(uint8_t*, size_t) { return -1; }
+  size_t  write(uint8_t) override { return 0; }
+  size_t  write(const uint8_t*, size_t) override { return 0; }
+  using Print::write;
+  uint8_t connected() { return 0; }
+  void    stop() {}
+  void    setConnectionTimeout(uint16_t) {}
+  explicit operator bool() { return false; }
+};
+
+class EthernetServer {
+public:
+  explicit EthernetServer(uint16_t port) : port_(port) {}
+  void           begin() {}
+  EthernetClient accept() { return EthernetClient(); }
+
+private:
+  uint16_t port_;
+};
@@ -0,0 +1,23 @@
+// HardwareSerial.h – hostitelská náhrada: Serial = stdout
+//
+// UART modemu na hostiteli není HardwareSerial, ale ModemUart nad
+// pseudoterminálem (host/modem_uart_pty.cpp).
+
+#pragma once
+#include <cstdio>
+
+// místo v TX bufferu je vždy (host nemá pomalý UART)
+class HardwareSerial : public Stream {
+public:
+  void   begin(unsigned long) {}
+  int    available() override { return 0; }
+  int    read() override      { return -1; }
+  int    peek() override      { return -1; }
+  size_t write(uint8_t b) override { return fwrite(&b, 1, 1, stdout); }
+  size_t write(const uint8_t* p, size_t n) override { return fwrite(p, 1, n, stdout); }
+  int    availableForWrite() override { return 4096; }
+  void   flush() override { fflush(stdout); }
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
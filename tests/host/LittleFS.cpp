@@ -0,0 +1,110 @@
+// LittleFS.cpp – soubory brány v dočasném adresáři hostitele
+#include "LittleFS.h"
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LittleFSFS LittleFS;
+
+// ====== File ======
+File::Handle::~Handle() {
+  if (f) fclose(f);
+}
+
+File::File(FILE* f) : h_(std::make_shared<Handle>()) {
+  h_->f = f;
+}
+
+size_t File::size() const {
+  if (!*this) return 0;
+  struct stat st;
+  fflush(h_->f);
+  return fstat(fileno(h_->f), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+bool File::seek(uint32_t pos) {
+  return *this && fseek(h_->f, pos, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+  long p = *this ? ftell(h_->f) : -1;
+  return p > 0 ? (size_t)p : 0;
+}
+
+void File::close() {
+  if (!h_ || !h_->f) return;
+  fclose(h_->f);
+  h_->f = nullptr;
+}
+
+int File::available() {
+  size_t s = size(), p = position();
+  return s > p ? (int)(s - p) : 0;
+}
+
+int File::read() {
+  return *this ? fgetc(h_->f) : -1;
+}
+
+int File::peek() {
+  if (!*this) return -1;
+  int c = fgetc(h_->f);
+  if (c >= 0) ungetc(c, h_->f);
+  return c;
+}
+
+size_t File::read(uint8_t* buf, size_t n) {
+  return *this ? fread(buf, 1, n, h_->f) : 0;
+}
+
+size_t File::write(const uint8_t* buf, size_t n) {
+  return *this ? fwrite(buf, 1, n, h_->f) : 0;
+}
+
+void File::flush() {
+  if (*this) fflush(h_->f);
+}
+
+// ====== Souborový systém ======
+bool LittleFSFS::begin(bool) {
+  if (!root_.empty()) return true;
+  const char* tmp = getenv("TMPDIR");
+  std::string tpl = std::string(tmp && *tmp ? tmp : "/tmp") + "/littlefs.XXXXXX";
+  if (!mkdtemp(&tpl[0])) return false;
+  root_ = tpl;
+  return true;
+}
+
+static int removeEntry(const char* p, const struct stat*, int, struct FTW*) {
+  return ::remove(p);
+}
+
+void LittleFSFS::end() {
+  if (root_.empty()) return;
+  nftw(root_.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+  root_.clear();
+}
+
+std::string LittleFSFS::path(const char* p) const {
+  return root_ + (*p == '/' ? "" : "/") + p;
+}
+
+File LittleFSFS::open(const char* p, const char* mode) {
+  if (root_.empty()) return File();
+  // "r"/"w"/"a" jako LittleFS; binárně, čte se i ze zapisovaných
+  const char* m = mode[0] == 'w' ? "w+b" : mode[0] == 'a' ? "a+b" : "rb";
+  FILE* f = fopen(path(p).c_str(), m);
+  return f ? File(f) : File();
+}
+
+bool LittleFSFS::exists(const char* p) {
+  return !root_.empty() && access(path(p).c_str(), F_OK) == 0;
+}
+
+bool LittleFSFS::remove(const char* p) {
+  return !root_.empty() && ::remove(path(p).c_str()) == 0;
+}
+
+bool LittleFSFS::rename(const char* from, const char* to) {
+  return !root_.empty() && ::rename(path(from).c_str(), path(to).c_str()) == 0;
+}
@@ -0,0 +1,61 @@
+// LittleFS.h – hostitelská náhrada LittleFS nad dočasným adresářem
+//
+// begin() založí adresář (mkdtemp v $TMPDIR), cesty "/x" se mapují pod
+// něj, end() ho i s obsahem smaže. File je sdílený handle nad FILE*
+// jako fs::File v Arduino-ESP32: kopie ukazují na týž soubor a close()
+// ho zavře pro všechny.
+
+#pragma once
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+class File : public Stream {
+public:
+  File() = default;
+
+  explicit operator bool() const { return h_ && h_->f; }
+
+  size_t size() const;
+  bool   seek(uint32_t pos);
+  size_t position() const;
+  bool   isDirectory() const { return false; }   // open() otevírá jen soubory
+  void   close();
+
+  int    available() override;
+  int    read() override;
+  int    peek() override;
+  size_t read(uint8_t* buf, size_t n);
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  void   flush() override;
+  using Print::write;
+
+private:
+  friend class LittleFSFS;
+  struct Handle {
+    FILE* f = nullptr;
+    ~Handle();
+  };
+  explicit File(FILE* f);
+  std::shared_ptr<Handle> h_;
+};
+
+class LittleFSFS {
+public:
+  bool begin(bool formatOnFail = false);
+  void end();
+
+  File open(const char* path, const char* mode = "r");
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+
+  const char* root() const { return root_.c_str(); }
+
+private:
+  std::string path(const char* p) const;
+  std::string root_;
+};
+
+extern LittleFSFS LittleFS;
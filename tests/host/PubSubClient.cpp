@@ -0,0 +1,95 @@
+// PubSubClient.cpp – broker v procesu pro hostitelský build
+#include "PubSubClient.h"
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+
+void (*mqttHostOnPublish)(const char*, const uint8_t*, size_t) = nullptr;
+
+struct HostMessage {
+  std::string topic, payload;
+};
+
+// Broker je jeden na proces, stejně jako mqttClient ve firmwaru
+static std::mutex              brokerMutex;
+static std::deque<HostMessage> inbound;
+static std::set<std::string>   subscriptions;
+
+void mqttHostDeliver(const char* topic, const char* payload) {
+  std::lock_guard<std::mutex> g(brokerMutex);
+  inbound.push_back({ topic, payload });
+}
+
+size_t mqttHostPending() {
+  std::lock_guard<std::mutex> g(brokerMutex);
+  return inbound.size();
+}
+
+PubSubClient& PubSubClient::setServer(const char* host, uint16_t) {
+  hasServer_ = host && *host;
+  return *this;
+}
+
+bool PubSubClient::connect(const char* id) {
+  connected_ = hasServer_ && id;
+  return connected_;
+}
+
+bool PubSubClient::connect(const char* id, const char*, const char*) {
+  return connect(id);
+}
+
+bool PubSubClient::connect(const char* id, const char*, const char*, const char*,
+                           uint8_t, bool, const char*, bool) {
+  return connect(id);
+}
+
+void PubSubClient::disconnect() {
+  connected_ = false;
+  std::lock_guard<std::mutex> g(brokerMutex);
+  subscriptions.clear();
+}
+
+bool PubSubClient::subscribe(const char* topic) {
+  if (!connected_) return false;
+  std::lock_guard<std::mutex> g(brokerMutex);
+  subscriptions.insert(topic);
+  return true;
+}
+
+// Jako knihovna: nejvýš jedna zpráva na volání, delší než buffer se zahodí
+bool PubSubClient::loop() {
+  if (!connected_) return false;
+  HostMessage m;
+  {
+    std::lock_guard<std::mutex> g(brokerMutex);
+    if (inbound.empty()) return true;
+    m = std::move(inbound.front());
+    inbound.pop_front();
+    if (!subscriptions.count(m.topic)) return true;
+  }
+  if (cb_ && m.topic.size() + m.payload.size() + 7 <= bufferSize_) {
+    cb_(&m.topic[0], (uint8_t*)&m.payload[0], m.payload.size());
+  }
+  return true;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+  return publish(topic, (const uint8_t*)payload, strlen(payload), false);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+  return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length) {
+  return publish(topic, payload, length, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length, bool) {
+  if (!connected_) return false;
+  if (strlen(topic) + length + 7 > bufferSize_) return false;
+  if (mqttHostOnPublish) mqttHostOnPublish(topic, payload, length);
+  return true;
+}
@@ -0,0 +1,61 @@
+// PubSubClient.h – hostitelská náhrada MQTT klienta s brokerem v procesu
+//
+// connect() uspěje, jakmile je nastaven server. Zprávy "z brokeru"
+// vkládá test přes mqttHostDeliver() (z libovolného vlákna) a loop()
+// je doručí callbacku, pokud je topic odebírán. Publikace firmwaru
+// dostává mqttHostOnPublish. Signatury publish() odpovídají knihovně,
+// včetně publish(topic, char*, size_t) → přetížení s `retained`.
+
+#pragma once
+#include <Arduino.h>
+#include <Ethernet.h>
+
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+#define MQTT_CONNECT_BAD_PROTOCOL    1
+#define MQTT_CONNECT_BAD_CLIENT_ID   2
+#define MQTT_CONNECT_UNAVAILABLE     3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED    5
+
+class PubSubClient {
+public:
+  typedef void (*Callback)(char* topic, uint8_t* payload, unsigned int length);
+
+  explicit PubSubClient(EthernetClient&) {}
+
+  PubSubClient& setServer(const char* host, uint16_t port);
+  PubSubClient& setCallback(Callback cb) { cb_ = cb; return *this; }
+  PubSubClient& setKeepAlive(uint16_t)   { return *this; }
+  bool          setBufferSize(uint16_t size) { bufferSize_ = size; return true; }
+
+  bool connect(const char* id);
+  bool connect(const char* id, const char* user, const char* pass);
+  bool connect(const char* id, const char* user, const char* pass, const char* willTopic,
+               uint8_t willQos, bool willRetain, const char* willMessage, bool cleanSession);
+  void disconnect();
+  bool connected() { return connected_; }
+  int  state()     { return connected_ ? MQTT_CONNECTED : MQTT_DISCONNECTED; }
+
+  bool subscribe(const char* topic);
+  bool loop();
+
+  bool publish(const char* topic, const char* payload);
+  bool publish(const char* topic, const char* payload, bool retained);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int length);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained);
+
+private:
+  Callback cb_         = nullptr;
+  bool     hasServer_  = false;
+  bool     connected_  = false;
+  uint16_t bufferSize_ = 256;
+};
+
+// ====== Strana brokeru (jen testy) ======
+void mqttHostDeliver(const char* topic, const char* payload);
+size_t mqttHostPending();          // doručení čekající na loop()
+extern void (*mqttHostOnPublish)(const char* topic, const uint8_t* payload, size_t length);
@@ -0,0 +1,84 @@
+// WString.h – hostitelská náhrada Arduino String (nad std::string)
+//
+// Jen metody, které moduly ve firmwaru volají; alokuje na haldě stejně
+// jako originál, takže se počítá do špičky haldy (host/heap.cpp).
+
+#pragma once
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+class String {
+public:
+  String() = default;
+  String(const char* s) : s_(s ? s : "") {}
+  String(const char* s, size_t n) : s_(s, n) {}
+  String(const std::string& s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(int v)           : s_(std::to_string(v)) {}
+  explicit String(unsigned v)      : s_(std::to_string(v)) {}
+  explicit String(long v)          : s_(std::to_string(v)) {}
+  explicit String(unsigned long v) : s_(std::to_string(v)) {}
+
+  const char* c_str() const  { return s_.c_str(); }
+  unsigned    length() const { return s_.size(); }
+  bool        isEmpty() const { return s_.empty(); }
+  bool        reserve(unsigned n) { s_.reserve(n); return true; }
+  char        charAt(unsigned i) const { return i < s_.size() ? s_[i] : 0; }
+  char        operator[](unsigned i) const { return charAt(i); }
+  char&       operator[](unsigned i) { return s_[i]; }
+
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  String& operator+=(const char* o)   { s_ += o ? o : ""; return *this; }
+  String& operator+=(char c)          { s_ += c; return *this; }
+  bool    concat(const String& o)     { s_ += o.s_; return true; }
+  bool    concat(const char* o)       { s_ += o ? o : ""; return true; }
+  bool    concat(char c)              { s_ += c; return true; }
+
+  friend String operator+(String a, const String& b) { return a += b; }
+  friend String operator+(String a, const char* b)   { return a += b; }
+  friend String operator+(const char* a, const String& b) { return String(a) += b; }
+
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator==(const char* o) const   { return s_ == (o ? o : ""); }
+  bool operator!=(const String& o) const { return !(*this == o); }
+  bool operator!=(const char* o) const   { return !(*this == o); }
+  bool operator<(const String& o) const  { return s_ < o.s_; }
+  bool equals(const String& o) const     { return s_ == o.s_; }
+
+  bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  bool endsWith(const String& p) const {
+    return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+  }
+  int indexOf(char c, unsigned from = 0) const        { return pos(s_.find(c, from)); }
+  int indexOf(const String& p, unsigned from = 0) const { return pos(s_.find(p.s_, from)); }
+  int lastIndexOf(char c) const                        { return pos(s_.rfind(c)); }
+  String substring(unsigned from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned from, unsigned to) const {
+    if (from > to) std::swap(from, to);
+    return from < s_.size() ? String(s_.substr(from, to - from)) : String();
+  }
+
+  void trim() {
+    size_t b = s_.find_first_not_of(" \t\r\n");
+    size_t e = s_.find_last_not_of(" \t\r\n");
+    s_ = b == std::string::npos ? std::string() : s_.substr(b, e - b + 1);
+  }
+  void remove(unsigned from)               { if (from < s_.size()) s_.erase(from); }
+  void remove(unsigned from, unsigned n)   { if (from < s_.size()) s_.erase(from, n); }
+  void replace(const String& a, const String& b) {
+    if (a.s_.empty()) return;
+    for (size_t p = 0; (p = s_.find(a.s_, p)) != std::string::npos; p += b.s_.size()) {
+      s_.replace(p, a.s_.size(), b.s_);
+    }
+  }
+  void toLowerCase() { for (char& c : s_) c = (char)tolower((unsigned char)c); }
+  void toUpperCase() { for (char& c : s_) c = (char)toupper((unsigned char)c); }
+  long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+
+private:
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  std::string s_;
+};
@@ -0,0 +1,6 @@
+// WiFiClient.h – hostitelská náhrada (mqtt_module.cpp ji jen includuje)
+
+#pragma once
+#include <Arduino.h>
+
+class WiFiClient {};
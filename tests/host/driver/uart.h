@@ -0,0 +1,18 @@
+// driver/uart.h – hostitelská náhrada ovladače UART z ESP-IDF
+//
+// Jen typy, které potřebuje modem_uart.h. ModemUart je na hostiteli
+// implementovaný nad pseudoterminálem (host/modem_uart_pty.cpp); port
+// se před ModemUart::begin() připojí k cestě pty přes uartHostAttach().
+
+#pragma once
+
+typedef int   uart_port_t;
+typedef void* QueueHandle_t;
+
+#define UART_NUM_0  0
+#define UART_NUM_1  1
+#define UART_NUM_2  2
+#define UART_NUM_MAX 3
+
+// Otevře `path` (pty simulátoru modemu) jako port `port`
+bool uartHostAttach(uart_port_t port, const char* path);
@@ -0,0 +1,70 @@
+// heap.cpp – obsazená halda procesu pro benchmarky (hostHeapUsed …)
+//
+// malloc/free a spol. se předají glibc (__libc_*) a počítá se
+// malloc_usable_size() každého bloku. mallinfo2() se na to nehodí:
+// bloky ve vyrovnávací paměti tcache vykazuje jako obsazené a vidí jen
+// hlavní arénu, ne haldy vláken.
+#include <Arduino.h>
+#include <malloc.h>
+#include <atomic>
+#include <cerrno>
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void  __libc_free(void*);
+}
+
+static std::atomic<long> heapUsed{0};
+static std::atomic<long> heapPeak{0};
+
+static void* track(void* p) {
+  if (p) {
+    long now = heapUsed += (long)malloc_usable_size(p);
+    long peak = heapPeak.load(std::memory_order_relaxed);
+    while (now > peak && !heapPeak.compare_exchange_weak(peak, now)) {}
+  }
+  return p;
+}
+
+static void untrack(void* p) {
+  if (p) heapUsed -= (long)malloc_usable_size(p);
+}
+
+extern "C" {
+
+void* malloc(size_t n)           { return track(__libc_malloc(n)); }
+void* calloc(size_t n, size_t s) { return track(__libc_calloc(n, s)); }
+void* memalign(size_t a, size_t n) { return track(__libc_memalign(a, n)); }
+void* aligned_alloc(size_t a, size_t n) { return track(__libc_memalign(a, n)); }
+
+void free(void* p) {
+  untrack(p);
+  __libc_free(p);
+}
+
+void* realloc(void* p, size_t n) {
+  untrack(p);
+  void* q = __libc_realloc(p, n);
+  if (!q && n) {
+    // původní blok zůstal platný
+    track(p);
+    return nullptr;
+  }
+  return track(q);
+}
+
+int posix_memalign(void** out, size_t a, size_t n) {
+  void* p = track(__libc_memalign(a, n));
+  if (!p) return ENOMEM;
+  *out = p;
+  return 0;
+}
+
+}  // extern "C"
+
+size_t hostHeapUsed()      { long n = heapUsed; return n > 0 ? (size_t)n : 0; }
+size_t hostHeapPeak()      { long n = heapPeak; return n > 0 ? (size_t)n : 0; }
+void   hostHeapResetPeak() { heapPeak = heapUsed.load(); }
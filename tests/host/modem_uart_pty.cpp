@@ -0,0 +1,81 @@
+// modem_uart_pty.cpp – ModemUart na hostiteli: pseudoterminál simulátoru
+//
+// Místo fronty událostí ovladače čeká waitEvent() v poll() na data z pty,
+// zbytek odpovídá modem_uart.cpp (neblokující čtení, peek o jeden znak).
+#include "modem_uart.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+static int portFd[UART_NUM_MAX] = { -1, -1, -1 };
+
+bool uartHostAttach(uart_port_t port, const char* path) {
+  if (port < 0 || port >= UART_NUM_MAX) return false;
+  int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0) return false;
+  termios t;
+  if (tcgetattr(fd, &t) == 0) {
+    cfmakeraw(&t);
+    tcsetattr(fd, TCSANOW, &t);
+  }
+  portFd[port] = fd;
+  return true;
+}
+
+// Rychlost a piny určuje simulátor, port jen musí být připojený
+bool ModemUart::begin(uint32_t, int, int) {
+  return portFd[port_] >= 0;
+}
+
+bool ModemUart::waitEvent(uint32_t ms) {
+  pollfd pf = { portFd[port_], POLLIN, 0 };
+  return poll(&pf, 1, (int)ms) > 0;
+}
+
+int ModemUart::available() {
+  int n = 0;
+  return ioctl(portFd[port_], FIONREAD, &n) == 0 ? n + (peeked_ >= 0) : (peeked_ >= 0);
+}
+
+int ModemUart::read() {
+  uint8_t b;
+  return readBytes(&b, 1) ? b : -1;
+}
+
+int ModemUart::peek() {
+  if (peeked_ < 0) {
+    uint8_t b;
+    if (::read(portFd[port_], &b, 1) == 1) peeked_ = b;
+  }
+  return peeked_;
+}
+
+size_t ModemUart::readBytes(uint8_t* buf, size_t len) {
+  size_t n = 0;
+  if (len && peeked_ >= 0) {
+    buf[n++] = (uint8_t)peeked_;
+    peeked_  = -1;
+  }
+  ssize_t r = n < len ? ::read(portFd[port_], buf + n, len - n) : 0;
+  return n + (r > 0 ? r : 0);
+}
+
+// Plný buffer pty: počkat, až simulátor odebere (jako TX ring ovladače)
+size_t ModemUart::write(const uint8_t* buf, size_t len) {
+  size_t k = 0;
+  while (k < len) {
+    ssize_t w = ::write(portFd[port_], buf + k, len - k);
+    if (w > 0) { k += w; continue; }
+    if (w < 0 && errno != EAGAIN) break;
+    pollfd pf = { portFd[port_], POLLOUT, 0 };
+    poll(&pf, 1, 10);
+  }
+  return k;
+}
+
+void ModemUart::flush() {
+  tcdrain(portFd[port_]);
+}
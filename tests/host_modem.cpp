@@ -0,0 +1,316 @@
+// host_modem.cpp – úlohy brány na hostiteli proti tools/fake_modem.py
+//
+// Běží stejně jako firmware s GSM_USE_TASKS: tasksStart() z rt_tasks.cpp
+// spustí modemovou, síťovou, MQTT a logovací úlohu jako pthready a data
+// mezi nimi tečou jen frontami rt_queue.h. Přeloží se skutečné moduly
+// (gsm_modem, sms_inbox, sms_retry, sms_history, call_log, sms_bulk,
+// mqtt_module, http_events, http_server …); Arduino, LittleFS (dočasný
+// adresář), ArduinoJson, UART (pty simulátoru), Ethernet a MQTT broker
+// nahrazuje tests/host/.
+//
+// Úlohy SMS zakládají dva producenti, polovinu každý:
+//  - síťová úloha: networkLoop() níže místo webserver.cpp, jako
+//    POST /api/sms volá enqueueSms(…, SMS_SRC_HTTP);
+//  - MQTT: hlavní vlákno posílá brokeru zprávy na smsTopic a MQTT úloha
+//    je předá mqttCallback → modemScheduleSMS(…, SMS_SRC_MQTT).
+// Publikace firmwaru (Caller ID, přijaté SMS, dead-letter, ACK) se
+// počítají na straně brokeru. Hlavní vlákno jen sleduje getSmsStatus().
+//
+//   build/host_modem [--jobs N] [--window N] [--text T] [--timeout S]
+//                    [--retry-ms MS] [--port /dev/pts/N | -- <argumenty fake_modem.py>]
+//
+// Výsledek: SMS/min, p50/p99 průchodů úloh (koše metrics.h), příjem,
+// hovory, MQTT a špička haldy všech vláken nad stavem po inicializaci
+// (host/heap.cpp) – zahrnuje buffery právě otevřených souborů (LittleFS
+// na ESP32 je alokuje také).
+#include "gsm_modem.h"
+#include "mqtt_module.h"
+#include "http_events.h"
+#include "http_server.h"
+#include "webserver.h"
+#include "ntp_sync.h"
+#include "settings.h"
+#include "sms_inbox.h"
+#include "sms_retry.h"
+#include "sms_history.h"
+#include "sms_scheduler.h"
+#include "call_log.h"
+#include "contact_store.h"
+#include "jsonl_file.h"
+#include "metrics.h"
+#include "rt_tasks.h"
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <driver/uart.h>      // uartHostAttach (host/modem_uart_pty.cpp)
+
+#define LOG_TAG "HOST"
+#include "log.h"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#ifndef FAKE_MODEM
+  #define FAKE_MODEM "../tools/fake_modem.py"
+#endif
+
+Settings settings;
+
+// ====== Zadání (nastaví main() před tasksStart()) ======
+static uint32_t    httpJobs = 0, mqttJobs = 0;
+static uint32_t    window   = 32;
+static std::atomic<bool> producing{false};   // až po připojení k brokeru
+static std::string text     = "Testovaci zprava z hostitelskeho buildu brany";
+
+// ====== Síťová úloha ======
+bool ntpIsSynced() { return true; }
+
+static std::atomic<uint32_t> httpQueued{0};
+
+// Místo webserver.cpp: HTTP server bez spojení, producent POST /api/sms
+// (jedna úloha na požadavek, čísla sudá) a události pro /api/events
+void networkLoop() {
+  httpServerLoop();
+  while (producing && httpQueued < httpJobs && smsJobActiveCount() < window) {
+    char number[SMS_NUMBER_MAX];
+    snprintf(number, sizeof(number), "+420777%06u", (unsigned)(2 * httpQueued));
+    if (!enqueueSms(number, text.c_str(), SMS_SRC_HTTP)) break;
+    httpQueued++;
+  }
+  httpEventsLoop();
+}
+
+// ====== Broker ======
+static const char* const SMS_TOPIC    = "gsm/sms";
+static const char* const CALLER_TOPIC = "gsm/caller";
+static const char* const PUB_TOPIC    = "gsm/out";
+static const char* const INBOX_TOPIC  = "gsm/inbox";
+
+static std::atomic<uint32_t> mqttCalls{0}, mqttHangups{0}, mqttKnown{0};
+static std::atomic<uint32_t> mqttInbox{0}, mqttDeadLetters{0};
+static std::atomic<uint32_t> mqttAcks{0}, mqttRejected{0};
+
+// Volá MQTT úloha (mqttClient.publish)
+static void onPublish(const char* topic, const uint8_t* payload, size_t length) {
+  std::string t(topic), p((const char*)payload, length);
+  if (t == CALLER_TOPIC) {
+    (p.empty() ? mqttHangups : mqttCalls)++;
+  } else if (t == std::string(CALLER_TOPIC) + "/contact") {
+    if (p.find("\"name\":\"") != std::string::npos) mqttKnown++;
+  } else if (t == INBOX_TOPIC) {
+    mqttInbox++;
+  } else if (t == PUB_TOPIC) {
+    if (p.find("\"status\":\"failed\"") != std::string::npos)      mqttDeadLetters++;
+    else if (p.find("\"status\":\"queued\"") != std::string::npos) mqttAcks++;
+    else if (p.find("\"status\":\"error\"") != std::string::npos)  mqttRejected++;
+  }
+}
+
+static void writeMqttConfig() {
+  StaticJsonDocument<256> doc;
+  doc["clientId"]    = "host";
+  doc["broker"]      = "broker.host";
+  doc["port"]        = 1883;
+  doc["keepalive"]   = 60;
+  doc["smsTopic"]    = SMS_TOPIC;
+  doc["callerTopic"] = CALLER_TOPIC;
+  doc["pubTopic"]    = PUB_TOPIC;
+  doc["inboxTopic"]  = INBOX_TOPIC;
+  File f = LittleFS.open("/mqtt_config.json", "w");
+  serializeJson(doc, f);
+  f.close();
+}
+
+// Úloha přes MQTT (čísla lichá); další až po doručení předchozí
+static uint32_t mqttQueued = 0;
+
+static void mqttProduce() {
+  if (mqttQueued >= mqttJobs || mqttHostPending() || smsJobActiveCount() >= window) return;
+  char number[SMS_NUMBER_MAX], msg[MQTT_BUFFER_SIZE];
+  snprintf(number, sizeof(number), "+420777%06u", (unsigned)(2 * mqttQueued + 1));
+  StaticJsonDocument<256> doc;
+  doc["recipients"] = (const char*)number;
+  doc["message"]    = text.c_str();
+  serializeJson(doc, msg, sizeof(msg));
+  mqttHostDeliver(SMS_TOPIC, msg);
+  mqttQueued++;
+}
+
+// Adresář pro contactLookup() v onClip (index se sestaví při startu)
+static void writeContacts() {
+  File f = LittleFS.open(CONTACTS_JSON_PATH, "w");
+  f.print("[");
+  for (int i = 0; i < 200; ++i) {
+    f.printf("%s{\"name\":\"Kontakt %d\",\"phone\":\"+420%09d\",\"group\":\"%s\"}",
+             i ? "," : "", i, 600000000 + i * 997, i % 2 ? "servis" : "obchod");
+  }
+  f.print("]");
+  f.close();
+}
+
+// ====== Simulátor modemu ======
+static pid_t modemPid  = -1;
+static FILE* modemOut  = nullptr;
+
+// Spustí fake_modem.py a z prvního řádku vezme cestu k pty
+static std::string spawnModem(const std::vector<std::string>& args) {
+  int fds[2];
+  if (pipe(fds)) return "";
+  modemPid = fork();
+  if (modemPid == 0) {
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[0]);
+    std::vector<char*> argv = { (char*)"python3", (char*)FAKE_MODEM };
+    for (const auto& a : args) argv.push_back((char*)a.c_str());
+    argv.push_back(nullptr);
+    execvp("python3", argv.data());
+    _exit(127);
+  }
+  close(fds[1]);
+  modemOut = fdopen(fds[0], "r");
+  char line[256];
+  if (!modemOut || !fgets(line, sizeof(line), modemOut)) return "";
+  const char* p = strstr(line, "/dev/");
+  if (!p) return "";
+  return std::string(p, strcspn(p, " \r\n"));
+}
+
+// Ctrl+C simulátoru → vypíše závěrečnou statistiku své strany
+static void stopModem() {
+  if (modemPid <= 0) return;
+  kill(modemPid, SIGINT);
+  char line[512];
+  while (modemOut && fgets(line, sizeof(line), modemOut)) printf("  modem: %s", line);
+  waitpid(modemPid, nullptr, 0);
+}
+
+// ====== Měření ======
+static void printPercentiles(const char* name, MetricTimer t) {
+  const MetricHistogram& h = metricsTimer(t);
+  printf("  %-10s p50 <= %u us, p99 <= %u us (%u průchodů)\n", name,
+         (unsigned)h.percentileUs(50), (unsigned)h.percentileUs(99), (unsigned)h.count());
+}
+
+int main(int argc, char** argv) {
+  uint32_t    jobs    = 100;
+  uint32_t    timeout = 120;
+  uint32_t    retryMs = 200;
+  std::string port;
+  std::vector<std::string> modemArgs;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    bool more = i + 1 < argc;
+    if (a == "--jobs" && more)          jobs    = strtoul(argv[++i], nullptr, 10);
+    else if (a == "--window" && more)   window  = strtoul(argv[++i], nullptr, 10);
+    else if (a == "--timeout" && more)  timeout = strtoul(argv[++i], nullptr, 10);
+    else if (a == "--retry-ms" && more) retryMs = strtoul(argv[++i], nullptr, 10);
+    else if (a == "--text" && more)     text    = argv[++i];
+    else if (a == "--port" && more)     port    = argv[++i];
+    else if (a == "--") { modemArgs.assign(argv + i + 1, argv + argc); break; }
+    else {
+      fprintf(stderr, "neznámý argument %s\n", argv[i]);
+      return 2;
+    }
+  }
+  mqttJobs = jobs / 2;
+  httpJobs = jobs - mqttJobs;
+
+  if (port.empty()) {
+    modemArgs.push_back("--report");
+    modemArgs.push_back("3600");      // průběžné výpisy simulátoru nepotřebujeme
+    port = spawnModem(modemArgs);
+  }
+  if (port.empty() || !uartHostAttach(UART_NUM_2, port.c_str())) {
+    fprintf(stderr, "pty modemu nelze otevřít (%s)\n", port.c_str());
+    stopModem();
+    return 1;
+  }
+
+  // Stejné pořadí jako setup() + networkInit() (bez Ethernetu a HTTP rout)
+  settings.atclip         = true;
+  settings.smsRetryBaseMs = retryMs;  // výchozích 10 s by benchmark jen čekal
+  if (!LittleFS.begin(true)) {
+    fprintf(stderr, "LittleFS: dočasný adresář nelze založit\n");
+    stopModem();
+    return 1;
+  }
+  writeContacts();
+  writeMqttConfig();
+  contactStoreBegin();
+  smsHistoryInit();
+  callLogBegin();
+  smsSchedulerInit();
+  modemInit();
+  setupDTR();
+  mqttModuleInit();
+  mqttHostOnPublish = onPublish;
+  printf("Modem na %s, FS v %s, %u SMS (%u HTTP, %u MQTT), okno fronty %u, %u kontaktů\n",
+         port.c_str(), LittleFS.root(), (unsigned)jobs, (unsigned)httpJobs, (unsigned)mqttJobs,
+         (unsigned)window, (unsigned)contactStoreCount());
+  fflush(stdout);                     // buffer stdout (log) alokuje glibc až při prvním výpisu
+
+  size_t heapBase = hostHeapUsed();
+  hostHeapResetPeak();
+  unsigned long deadline = millis() + timeout * 1000UL;
+  tasksStart();
+
+  // mqttModuleLoop() se poprvé připojí až RECONNECT_INTERVAL od startu;
+  // co do té doby přijde z modemu, se nepublikuje a do výsledku nepočítá
+  while (!metricsCounter(MC_MQTT_CONNECTS) && millis() < deadline) delay(10);
+  SmsInboxStats in0    = smsInboxGetStats();
+  uint32_t      calls0 = jsonlCountLines("/call_log.jsonl");
+  mqttCalls = mqttHangups = mqttKnown = mqttInbox = 0;
+  unsigned long start = millis();
+  producing = true;
+
+  SmsStatusSnapshot st = getSmsStatus();
+  while (st.stats.sent + st.stats.failed < jobs && millis() < deadline) {
+    mqttProduce();
+    delay(1);
+    st = getSmsStatus();
+  }
+  unsigned long elapsed = millis() - start;
+  delay(2 * LOG_TASK_PERIOD_MS);      // poslední události a log doteče úlohami
+  size_t heapAfter = hostHeapUsed(), heapPeak = hostHeapPeak();
+
+  SmsInboxStats in = smsInboxGetStats();
+  ModemStatus   ms = getModemStatus();
+  printf("\nSMS: %u odesláno, %u selhalo (dead-letter %u), %u opakování z %u za %.1f s (%.1f SMS/min)\n",
+         (unsigned)st.stats.sent, (unsigned)st.stats.failed, (unsigned)smsDeadLetterCount(),
+         (unsigned)st.stats.retried, (unsigned)jobs, elapsed / 1000.0,
+         elapsed ? st.stats.sent * 60000.0 / elapsed : 0.0);
+  printf("  processSmsQueue: %u segmentů, průměr %u ms/SMS, poslední dávka %u SMS/min\n",
+         (unsigned)st.stats.segments, (unsigned)st.stats.avgJobMs, (unsigned)st.stats.perMinute);
+  printf("  producenti: HTTP %u, MQTT %u (ACK %u, odmítnuto %u)\n", (unsigned)httpQueued,
+         (unsigned)mqttQueued, (unsigned)mqttAcks, (unsigned)mqttRejected);
+  printf("Příjem: %u SMS (%u zapsáno, %u zahozeno, %u vadných PDU), MQTT %u\n",
+         (unsigned)(in.received - in0.received), (unsigned)(in.stored - in0.stored),
+         (unsigned)(in.dropped - in0.dropped), (unsigned)(in.invalid - in0.invalid),
+         (unsigned)mqttInbox);
+  printf("Hovory: %u CLIP na MQTT (%u z adresáře), %u zavěšení, %u v /call_log.jsonl\n",
+         (unsigned)mqttCalls, (unsigned)mqttKnown, (unsigned)mqttHangups,
+         (unsigned)(jsonlCountLines("/call_log.jsonl") - calls0));
+  printf("MQTT: dead-letter %u, připojení %u; modem: CSQ %u, %s, CREG %u\n",
+         (unsigned)mqttDeadLetters, (unsigned)metricsCounter(MC_MQTT_CONNECTS),
+         (unsigned)ms.signal, ms.operatorName, (unsigned)ms.regStatus);
+  printf("Průchody úloh:\n");
+  printPercentiles("modem_urc", MT_MODEM_URC);
+  printPercentiles("sms_queue", MT_SMS_QUEUE);
+  printPercentiles("network", MT_NETWORK_LOOP);
+  printPercentiles("mqtt", MT_MQTT_LOOP);
+  printf("Halda: po inicializaci %zu B, špička %zu B (+%zu B s úlohami), na konci %+ld B\n",
+         heapBase, heapPeak, heapPeak - heapBase, (long)heapAfter - (long)heapBase);
+  printf("UART: rx %u B, tx %u B, %u AT příkazů, %u řádků URC (%u zkrácených)\n",
+         (unsigned)metricsCounter(MC_UART_RX_BYTES), (unsigned)metricsCounter(MC_UART_TX_BYTES),
+         (unsigned)metricsCounter(MC_AT_COMMANDS), (unsigned)metricsCounter(MC_URC_LINES),
+         (unsigned)metricsCounter(MC_URC_OVERFLOWS));
+  fflush(stdout);
+  stopModem();
+  LittleFS.end();
+  fflush(stdout);
+  // úlohy běží dál (jako na ESP32 se neukončují) – bez globálních destruktorů
+  _exit(st.stats.sent + st.stats.failed == jobs ? 0 : 1);
+}
@@ -0,0 +1,165 @@
+// test_sms_pdu.cpp – PDU kodek: plán segmentů, SMS-SUBMIT, SMS-DELIVER
+//
+// Kódování se ověřuje zpětně dekodérem: SMS-SUBMIT z smsEncodeSubmit()
+// se přepíše na SMS-DELIVER (stejné TP-UD) a musí dát původní text.
+#include "sms_pdu.h"
+#include <string>
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("%s:%d: CHECK(%s) selhal\n", __FILE__, __LINE__, #cond); failures++; } \
+  } while (0)
+#define CHECK_STR(a, b) do { \
+    std::string a_ = (a), b_ = (b); \
+    if (a_ != b_) { printf("%s:%d: \"%s\" != \"%s\"\n", __FILE__, __LINE__, a_.c_str(), b_.c_str()); failures++; } \
+  } while (0)
+
+// ====== SMS-SUBMIT → SMS-DELIVER ======
+static int nibble(char c) { return c <= '9' ? c - '0' : c - 'A' + 10; }
+
+static std::string hexByte(uint8_t b) {
+  static const char H[] = "0123456789ABCDEF";
+  return std::string(1, H[b >> 4]) + H[b & 0x0F];
+}
+
+// hex z smsEncodeSubmit(): "00" SCA, FO, MR, DA, PID, DCS, VP, UDL, UD
+static std::string submitToDeliver(const char* submit) {
+  std::string in(submit + 2);                   // bez SCA
+  auto at = [&](size_t i) { return (uint8_t)(nibble(in[2 * i]) << 4 | nibble(in[2 * i + 1])); };
+  uint8_t fo = at(0);
+  size_t  i  = 2;                               // FO, MR
+  size_t  daLen = 2 + (at(i) + 1) / 2;          // délka, typ, BCD
+  std::string out = "00";
+  out += hexByte(0x04 | (fo & 0x40));           // SMS-DELIVER, UDHI
+  out += in.substr(2 * i, 2 * daLen);           // TP-OA = TP-DA
+  i += daLen;
+  out += in.substr(2 * i, 4);                   // PID, DCS
+  i += 3;                                       // + VP
+  out += "52107021430080";                      // SCTS 25/01/07,12:34:00+08
+  out += in.substr(2 * i);                      // UDL, UD
+  return out;
+}
+
+// Všechny segmenty přes dekodér; vrací složený text
+static std::string roundTrip(const char* text, SmsPlan& plan, std::string* first = nullptr) {
+  std::string joined;
+  if (!smsPlan(text, plan)) return "<plan>";
+  for (uint8_t part = 0; part < plan.segments; ++part) {
+    char hex[SMS_PDU_HEX_MAX];
+    if (!smsEncodeSubmit("+420777123456", text, plan, part, 0x5A, hex, sizeof(hex))) return "<encode>";
+    SmsDeliver d;
+    if (!smsDecodeDeliver(submitToDeliver(hex).c_str(), d)) return "<decode>";
+    CHECK_STR(d.from, "+420777123456");
+    CHECK_STR(d.scts, "25/01/07,12:34:00+08");
+    CHECK(d.parts == plan.segments);
+    CHECK(d.part == part + 1);
+    if (plan.segments > 1) CHECK(d.ref == 0x5A);
+    if (part == 0 && first) *first = d.text;
+    joined += d.text;
+  }
+  return joined;
+}
+
+// ====== Testy ======
+static void testGsm7Extension() {
+  const char* text = "Cena 12€ {a} [b] ~x| ^\\";
+  SmsPlan plan;
+  CHECK_STR(roundTrip(text, plan), text);
+  CHECK(plan.encoding == SMS_ENC_GSM7);
+  CHECK(plan.segments == 1);
+  CHECK(plan.units == 23 + 9);                  // 23 znaků, 9 přes ESC
+}
+
+static void testGsm7ExtensionLimit() {
+  // 80 × '€' = 160 septetů: ještě jedna SMS, o znak víc už dvě
+  std::string text;
+  for (int i = 0; i < 80; ++i) text += "€";
+  SmsPlan plan;
+  CHECK_STR(roundTrip(text.c_str(), plan), text);
+  CHECK(plan.encoding == SMS_ENC_GSM7 && plan.segments == 1 && plan.units == 160);
+  text += "a";
+  CHECK(smsPlan(text.c_str(), plan) && plan.segments == 2);
+}
+
+static void testUcs2Surrogates() {
+  const char* text = "Ahoj 😀 světe 🚀!";
+  SmsPlan plan;
+  CHECK_STR(roundTrip(text, plan), text);
+  CHECK(plan.encoding == SMS_ENC_UCS2);
+  CHECK(plan.units == 13 + 2 * 2);              // emoji = 2 UTF-16 jednotky
+}
+
+static void testGsm7Concat() {
+  // ESC sekvence na hranici se nedělí: 152 + '€' (2) > 153
+  std::string text(152, 'a');
+  text += "€";
+  text += std::string(40, 'b');
+  SmsPlan plan;
+  std::string first;
+  CHECK_STR(roundTrip(text.c_str(), plan, &first), text);
+  CHECK(plan.encoding == SMS_ENC_GSM7);
+  CHECK(plan.segments == 2);
+  CHECK_STR(first, std::string(152, 'a'));
+}
+
+static void testUcs2Concat() {
+  // surrogate pár na hranici se nedělí: 66 + 😀 (2) > 67
+  std::string text;
+  for (int i = 0; i < 66; ++i) text += "č";
+  text += "😀";
+  for (int i = 0; i < 20; ++i) text += "ř";
+  SmsPlan plan;
+  std::string first;
+  CHECK_STR(roundTrip(text.c_str(), plan, &first), text);
+  CHECK(plan.encoding == SMS_ENC_UCS2);
+  CHECK(plan.segments == 2);
+  CHECK(first.size() == 66 * 2);                // jen 'č', emoji ve 2. části
+}
+
+static void testEncodeHeader() {
+  SmsPlan plan;
+  char hex[SMS_PDU_HEX_MAX];
+  CHECK(smsPlan("Test", plan));
+  size_t n = smsEncodeSubmit("+420777123456", "Test", plan, 0, 0, hex, sizeof(hex));
+  CHECK(n == 18);
+  // SCA 00, FO 11, MR 00, DA 12 čísl. mezinárodní, PID, DCS, VP AA, UDL 4
+  CHECK_STR(hex, "0011000C912470772143650000AA04D4F29C0E");
+}
+
+static void testDecodeReference() {
+  // Příklad SMS-DELIVER z TS 23.040 tutoriálů: SMSC +27381000015,
+  // odesílatel 27838890001 (národní), "hellohello" v GSM-7
+  SmsDeliver d;
+  CHECK(smsDecodeDeliver("07917283010010F5040BC87238880900F10000993092516195800AE8329BFD4697D9EC37", d));
+  CHECK_STR(d.from, "27838890001");
+  CHECK_STR(d.scts, "99/03/29,15:16:59+08");
+  CHECK_STR(d.text, "hellohello");
+  CHECK(d.part == 1 && d.parts == 1);
+}
+
+static void testRejects() {
+  SmsPlan plan;
+  CHECK(!smsPlan("\xC3\x28", plan));            // neplatné UTF-8
+  std::string huge(153 * SMS_MAX_SEGMENTS + 1, 'x');
+  CHECK(!smsPlan(huge.c_str(), plan));
+  char hex[SMS_PDU_HEX_MAX];
+  CHECK(smsPlan("x", plan));
+  CHECK(!smsEncodeSubmit("+42077712345a", "x", plan, 0, 0, hex, sizeof(hex)));
+  CHECK(!smsEncodeSubmit("+420777123456", "x", plan, 1, 0, hex, sizeof(hex)));
+  SmsDeliver d;
+  CHECK(!smsDecodeDeliver("0791", d));          // useknuté PDU
+}
+
+int main() {
+  testGsm7Extension();
+  testGsm7ExtensionLimit();
+  testUcs2Surrogates();
+  testGsm7Concat();
+  testUcs2Concat();
+  testEncodeHeader();
+  testDecodeReference();
+  testRejects();
+  printf("test_sms_pdu: %s (%d chyb)\n", failures ? "FAIL" : "OK", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""build_assets.py – připraví statické soubory webu v Data/ pro LittleFS
+
+Spustit před nahráním FS image. Pro index.html, css/*.css a js/*.js:
+
+  * zapíše vedle originálu <soubor>.gz (gzip -9, bez času → deterministický)
+  * v index.html.gz doplní k odkazům na css/js verzi "?v=<hash>", takže
+    server je může poslat s dlouhou platností v cache prohlížeče
+  * do Data/assets.etag zapíše "<url> <etag> <velikost .gz>" – server
+    podle něj posílá .gz s ETagem a odpovídá 304 Not Modified
+
+Originály zůstávají pro klienty bez gzip.
+"""
+import gzip
+import hashlib
+import pathlib
+import re
+import sys
+
+ROOT = pathlib.Path(__file__).resolve().parent.parent / "Data"
+MANIFEST = "assets.etag"
+
+
+def gz(data: bytes) -> bytes:
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def digest(data: bytes, n: int) -> str:
+    return hashlib.sha256(data).hexdigest()[:n]
+
+
+def main(root: pathlib.Path) -> int:
+    assets = sorted(p for pat in ("css/*.css", "js/*.js") for p in root.glob(pat))
+    versions = {}
+    out = {}
+    for p in assets:
+        rel = p.relative_to(root).as_posix()
+        data = p.read_bytes()
+        versions[rel] = digest(data, 8)
+        out[rel] = gz(data)
+
+    index = root / "index.html"
+    if index.exists():
+        html = index.read_text(encoding="utf-8")
+        for rel, ver in versions.items():
+            html = re.sub(r'(["\'])(/?%s)\1' % re.escape(rel),
+                          lambda m: "%s%s?v=%s%s" % (m.group(1), m.group(2), ver, m.group(1)), html)
+        out["index.html"] = gz(html.encode("utf-8"))
+
+    lines = []
+    for rel, data in sorted(out.items()):
+        (root / (rel + ".gz")).write_bytes(data)
+        lines.append('/%s "%s" %d' % (rel, digest(data, 16), len(data)))
+        print("%-20s %6d → %6d B" % (rel, (root / rel).stat().st_size, len(data)))
+    (root / MANIFEST).write_text("\n".join(lines) + "\n", encoding="ascii")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(pathlib.Path(sys.argv[1]) if len(sys.argv) > 1 else ROOT))
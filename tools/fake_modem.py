@@ -0,0 +1,386 @@
+#!/usr/bin/env python3
+"""fake_modem.py – simulace modemu SIM800 pro zkoušky brány bez SIM karty
+
+Odpovídá na AT příkazy, které posílá firmware (AT engine, stav modemu,
+SMS v PDU módu, příjem SMS, CLIP), a na zvolený port pouští zátěž:
+
+  * zpoždění odpovědí (--latency, --sms-latency) jako u skutečné sítě
+  * +CMS ERROR s danou pravděpodobností (--cms-error-rate, --cms-errors)
+  * bouře RING/+CLIP (--ring-storm) a příchozí SMS (--cmt-every)
+  * náhodné URC vložené mezi řádky odpovědí (--urc-rate)
+  * scénář po řádcích (--script), např.:
+
+        # čas [s]  akce      argumenty
+        2.0        clip      +420777123456 3     # 3× RING s CLIP
+        5.0        cmt       +420608111222 Test zpravy
+        6.0        urc       +CPIN: NOT READY
+        8.0        set       cms_error_rate 0.5
+
+Spojení: bez --port vytvoří pseudoterminál a vypíše jeho cestu (pro
+hostitelský build nebo socat); s --port /dev/ttyUSB0 jde přes převodník
+USB-UART přímo na piny modemu desky (GSM_RX_PIN / GSM_TX_PIN).
+
+Benchmark: každých --report s a na konci (Ctrl+C, --duration) vypíše
+propustnost SMS/min, podíl chyb, dobu od '>' do přijetí PDU (jak rychle
+smyčka modemové úlohy reaguje na prompt) a mezeru mezi OK a dalším
+příkazem – obojí jako p50/p99 v ms. S --metrics http://<ip>/api/metrics
+přidá z brány p50/p99 smyček (modem, fronta SMS, síť) a volnou haldu.
+"""
+import argparse
+import heapq
+import os
+import random
+import re
+import select
+import sys
+import termios
+import time
+import tty
+import urllib.request
+
+CTRL_Z = 0x1A
+ESC = 0x1B
+GSM7 = ("@£$¥èéùìòÇ\nØø\rÅåΔ_ΦΓΛΩΠΨΣΘΞ\x1bÆæßÉ !\"#¤%&'()*+,-./0123456789:;<=>?"
+        "¡ABCDEFGHIJKLMNOPQRSTUVWXYZÄÖÑÜ§¿abcdefghijklmnopqrstuvwxyzäöñüà")
+
+
+# ====== PDU pro příchozí SMS (SMS-DELIVER, GSM 7bit) ======
+def bcd(number: str) -> str:
+    digits = number.lstrip("+")
+    if len(digits) % 2:
+        digits += "F"
+    return "".join(digits[i + 1] + digits[i] for i in range(0, len(digits), 2))
+
+
+def pack7(text: str) -> bytes:
+    septets = [GSM7.index(c) if c in GSM7 else GSM7.index("?") for c in text]
+    out, acc, bits = bytearray(), 0, 0
+    for s in septets:
+        acc |= s << bits
+        bits += 7
+        while bits >= 8:
+            out.append(acc & 0xFF)
+            acc >>= 8
+            bits -= 8
+    if bits:
+        out.append(acc & 0xFF)
+    return bytes(out)
+
+
+def deliver_pdu(sender: str, text: str) -> tuple:
+    text = text[:160]
+    t = time.localtime()
+    scts = "".join("%02d" % v for v in (t.tm_year % 100, t.tm_mon, t.tm_mday,
+                                         t.tm_hour, t.tm_min, t.tm_sec))
+    scts = bcd(scts) + "00"
+    addr_type = "91" if sender.startswith("+") else "81"
+    tpdu = ("04" + "%02X" % len(sender.lstrip("+")) + addr_type + bcd(sender) +
+            "00" + "00" + scts + "%02X" % len(text) + pack7(text).hex().upper())
+    return "00" + tpdu, len(tpdu) // 2
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    s = sorted(values)
+    return s[min(len(s) - 1, int(round(p / 100.0 * (len(s) - 1))))]
+
+
+def scrape(url: str) -> str:
+    """p50/p99 smyček a halda z Prometheus textu /api/metrics."""
+    try:
+        text = urllib.request.urlopen(url, timeout=2).read().decode()
+    except OSError as e:
+        return "metriky nedostupné (%s)" % e
+    buckets, values = {}, {}
+    for line in text.splitlines():
+        m = re.match(r'smsgw_loop_seconds_bucket\{loop="(\w+)",le="([^"]+)"\} (\d+)', line)
+        if m:
+            buckets.setdefault(m.group(1), []).append((float(m.group(2)), int(m.group(3))))
+            continue
+        m = re.match(r"(smsgw_heap_\w+) (\d+)", line)
+        if m:
+            values[m.group(1)] = int(m.group(2))
+
+    def q(cum, pct):
+        total = cum[-1][1]
+        le = next((le for le, c in cum if c > total * pct / 100.0), float("inf")) if total else 0
+        return "%.0f" % (le * 1e6) if le != float("inf") else ">32768"
+    parts = ["%s p50 %s p99 %s µs" % (loop, q(cum, 50), q(cum, 99)) for loop, cum in buckets.items()]
+    parts.append("halda %d B (min %d B)" % (values.get("smsgw_heap_free_bytes", 0),
+                                           values.get("smsgw_heap_min_free_bytes", 0)))
+    return " | ".join(parts)
+
+
+# ====== Modem ======
+class FakeModem:
+    def __init__(self, fd, args):
+        self.fd = fd
+        self.args = args
+        self.rng = random.Random(args.seed)
+        self.timers = []            # (čas, pořadí, funkce)
+        self.seq = 0
+        self.rx = bytearray()
+        self.echo = True
+        self.creg_n = 0
+        self.pdu_len = None         # čeká se na PDU po '>'
+        self.prompt_at = 0.0
+        self.busy_until = 0.0       # odpovědi jdou po sobě, ne přes sebe
+        self.last_final = None
+        self.mr = 0
+        self.start = time.monotonic()
+        self.stats = dict(cmgs=0, sent=0, errors=0, bad_pdu=0, cmt=0, clip=0, commands=0)
+        self.prompt_ms = []
+        self.gap_ms = []
+
+    # ---- časovač a výstup
+    def at(self, delay, fn):
+        self.seq += 1
+        heapq.heappush(self.timers, (time.monotonic() + delay, self.seq, fn))
+
+    def write(self, data: str):
+        os.write(self.fd, data.encode("latin-1", "replace"))
+
+    def urc(self, line: str):
+        self.write("\r\n%s\r\n" % line)
+
+    def respond(self, lines, delay=None, final=True, on_sent=None):
+        """Odpověď po zpoždění; mezi řádky občas vloží náhodné URC."""
+        delay = self.args.latency / 1000.0 if delay is None else delay
+        when = max(time.monotonic() + delay, self.busy_until)
+        self.busy_until = when
+
+        def send():
+            for line in lines:
+                if self.rng.random() < self.args.urc_rate:
+                    self.urc(self.random_urc())
+                self.write("\r\n%s\r\n" % line if line != ">" else "\r\n> ")
+            if final:
+                self.last_final = time.monotonic()
+            if on_sent:
+                on_sent()
+        self.at(when - time.monotonic(), send)
+
+    def random_urc(self) -> str:
+        return self.rng.choice([
+            "+CREG: 1",
+            "+CSQ: %d,0" % self.rng.randint(5, 31),
+            "*PSUTTZ: 24/06/01,12:00:00\",\"+08\",1",
+            "+CTZV: +08,1",
+            "+CFUN: 1",
+            "Call Ready",
+            "SMS Ready",
+        ])
+
+    # ---- příkazy
+    def on_command(self, cmd: str):
+        if not cmd:
+            return
+        if self.echo:
+            self.write(cmd + "\r")
+        self.stats["commands"] += 1
+        if self.last_final is not None:
+            self.gap_ms.append((time.monotonic() - self.last_final) * 1000.0)
+            self.last_final = None
+        up = cmd.upper()
+
+        if up.startswith("AT+CMGS="):
+            self.stats["cmgs"] += 1
+            self.pdu_len = int(up[8:] or 0)
+            self.respond([">"], final=False,
+                         on_sent=lambda: setattr(self, "prompt_at", time.monotonic()))
+        elif up in ("ATE0", "ATE1"):
+            self.echo = up == "ATE1"
+            self.respond(["OK"])
+        elif up == "AT+CSQ":
+            self.respond(["+CSQ: %d,0" % self.rng.randint(10, 31), "OK"])
+        elif up == "AT+COPS?":
+            self.respond(['+COPS: 0,0,"FAKE-NET"', "OK"])
+        elif up.startswith("AT+CREG=") and up[8:] in ("0", "1", "2"):
+            self.creg_n = int(up[8:])
+            self.respond(["OK"])
+        elif up == "AT+CREG?":
+            self.respond(["+CREG: %d,1" % self.creg_n, "OK"])
+        elif up == "AT+CGATT?":
+            self.respond(["+CGATT: 1", "OK"])
+        elif up == "AT+CCLK?":
+            self.respond([time.strftime('+CCLK: "%y/%m/%d,%H:%M:%S+08"'), "OK"])
+        elif up.startswith("AT+CMGR=") or up.startswith("AT+CMGD="):
+            self.respond(["OK"])
+        elif up.startswith("AT") or up == "A/":
+            self.respond(["OK"])            # ATH, ATA, CMEE, CLIP, CNMI, CMGF …
+        else:
+            self.respond(["ERROR"])
+
+    def on_pdu(self, hexdata: bytes, cancelled: bool):
+        self.pdu_len, expected = None, self.pdu_len
+        if self.prompt_at:
+            self.prompt_ms.append((time.monotonic() - self.prompt_at) * 1000.0)
+            self.prompt_at = 0.0
+        if cancelled:
+            self.respond(["OK"])
+            return
+        text = hexdata.decode("latin-1").strip()
+        # délka v AT+CMGS je bez úvodní adresy SMSC (první oktet = její délka)
+        ok = bool(re.fullmatch(r"[0-9A-Fa-f]+", text)) and len(text) % 2 == 0
+        if ok:
+            smsc = int(text[:2], 16)
+            ok = len(text) // 2 - 1 - smsc == expected
+        if not ok:
+            self.stats["bad_pdu"] += 1
+            self.respond(["+CMS ERROR: 304"], self.args.sms_latency / 1000.0)
+        elif self.rng.random() < self.args.cms_error_rate:
+            self.stats["errors"] += 1
+            code = self.rng.choice(self.args.cms_errors)
+            self.respond(["+CMS ERROR: %d" % code], self.args.sms_latency / 1000.0)
+        else:
+            self.stats["sent"] += 1
+            self.mr = (self.mr + 1) % 256
+            self.respond(["+CMGS: %d" % self.mr, "OK"], self.args.sms_latency / 1000.0)
+
+    def feed(self, data: bytes):
+        self.rx += data
+        while self.rx:
+            if self.pdu_len is not None:
+                end = next((i for i, b in enumerate(self.rx) if b in (CTRL_Z, ESC)), -1)
+                if end < 0:
+                    return
+                body, term = bytes(self.rx[:end]), self.rx[end]
+                self.rx = self.rx[end + 1:]
+                self.on_pdu(body, cancelled=term == ESC)
+                continue
+            m = re.search(rb"[\r\n]", self.rx)
+            if not m:
+                return
+            line, self.rx = bytes(self.rx[:m.start()]), self.rx[m.end():]
+            self.on_command(line.decode("latin-1").strip())
+
+    # ---- zátěž
+    def clip(self, number: str, rings: int = 1):
+        self.stats["clip"] += 1
+        for i in range(rings):
+            self.at(i * 0.05, lambda: (self.urc("RING"),
+                                       self.urc('+CLIP: "%s",145,"",0,"",0' % number)))
+
+    def cmt(self, sender: str, text: str):
+        self.stats["cmt"] += 1
+        pdu, length = deliver_pdu(sender, text)
+        self.at(0, lambda: self.write("\r\n+CMT: ,%d\r\n%s\r\n" % (length, pdu)))
+
+    def storm(self):
+        number = "+420%09d" % self.rng.randint(600000000, 799999999)
+        self.clip(number, self.rng.randint(1, 3))
+        self.at(self.args.ring_storm / 1000.0, self.storm)
+
+    def sms_flood(self):
+        self.cmt("+420%09d" % self.rng.randint(600000000, 799999999),
+                 "Zkouska %d" % self.stats["cmt"])
+        self.at(self.args.cmt_every / 1000.0, self.sms_flood)
+
+    def load_script(self, path: str):
+        for raw in open(path, encoding="utf-8"):
+            parts = raw.split("#", 1)[0].split()
+            if len(parts) < 2:
+                continue
+            t, action, rest = float(parts[0]), parts[1], parts[2:]
+            if action == "clip":
+                fn = (lambda r: lambda: self.clip(r[0], int(r[1]) if len(r) > 1 else 1))(rest)
+            elif action == "cmt":
+                fn = (lambda r: lambda: self.cmt(r[0], " ".join(r[1:])))(rest)
+            elif action == "urc":
+                fn = (lambda r: lambda: self.urc(" ".join(r)))(rest)
+            elif action == "set":
+                fn = (lambda r: lambda: setattr(self.args, r[0], type(getattr(self.args, r[0]))(r[1])))(rest)
+            else:
+                sys.exit("%s: neznámá akce '%s'" % (path, action))
+            self.at(t, fn)
+
+    # ---- výsledky
+    def report(self, final=False):
+        s = self.stats
+        elapsed = max(time.monotonic() - self.start, 1e-3)
+        label = "konec" if final else "%.1f s" % elapsed
+        print("[%s] SMS %d/%d (%.1f/min), CMS ERROR %d, vadné PDU %d, "
+              "CLIP %d, CMT %d | '>'→PDU p50 %.1f p99 %.1f ms | OK→příkaz p50 %.1f p99 %.1f ms"
+              % (label, s["sent"], s["cmgs"], s["sent"] * 60.0 / elapsed, s["errors"],
+                 s["bad_pdu"], s["clip"], s["cmt"],
+                 percentile(self.prompt_ms, 50), percentile(self.prompt_ms, 99),
+                 percentile(self.gap_ms, 50), percentile(self.gap_ms, 99)),
+              flush=True)
+        if self.args.metrics:
+            print("          " + scrape(self.args.metrics), flush=True)
+        if not final:
+            self.at(self.args.report, self.report)
+
+    def run(self):
+        if self.args.ring_storm:
+            self.at(self.args.ring_storm / 1000.0, self.storm)
+        if self.args.cmt_every:
+            self.at(self.args.cmt_every / 1000.0, self.sms_flood)
+        if self.args.script:
+            self.load_script(self.args.script)
+        self.at(self.args.report, self.report)
+        stop = time.monotonic() + self.args.duration if self.args.duration else None
+        try:
+            while stop is None or time.monotonic() < stop:
+                timeout = 0.5
+                if self.timers:
+                    timeout = max(0.0, min(timeout, self.timers[0][0] - time.monotonic()))
+                r, _, _ = select.select([self.fd], [], [], timeout)
+                if r:
+                    try:
+                        data = os.read(self.fd, 4096)
+                    except OSError:         # druhá strana pty zavřená
+                        data = b""
+                    if data:
+                        self.feed(data)
+                    else:
+                        time.sleep(0.05)
+                now = time.monotonic()
+                while self.timers and self.timers[0][0] <= now:
+                    heapq.heappop(self.timers)[2]()
+        except KeyboardInterrupt:
+            pass
+        self.report(final=True)
+
+
+def open_port(args):
+    if not args.port:
+        master, slave = os.openpty()
+        tty.setraw(slave)
+        print("Modem na %s (9600 8N1 se na pty neuplatní)" % os.ttyname(slave), flush=True)
+        return master
+    fd = os.open(args.port, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, "B%d" % args.baud)
+    attrs[4] = attrs[5] = speed
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def main() -> int:
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    p.add_argument("--port", help="sériový port (jinak pseudoterminál)")
+    p.add_argument("--baud", type=int, default=9600)
+    p.add_argument("--latency", type=float, default=30, help="odpověď na AT příkaz [ms]")
+    p.add_argument("--sms-latency", type=float, default=1500, help="PDU → +CMGS [ms]")
+    p.add_argument("--cms-error-rate", type=float, default=0.0, help="podíl SMS s +CMS ERROR")
+    p.add_argument("--cms-errors", type=int, nargs="+", default=[38, 42, 47, 500],
+                   help="vybírané kódy +CMS ERROR")
+    p.add_argument("--urc-rate", type=float, default=0.0,
+                   help="pravděpodobnost URC před každým řádkem odpovědi")
+    p.add_argument("--ring-storm", type=float, default=0, help="interval RING/+CLIP [ms], 0 = vyp.")
+    p.add_argument("--cmt-every", type=float, default=0, help="interval příchozích SMS [ms], 0 = vyp.")
+    p.add_argument("--script", help="scénář událostí (viz výše)")
+    p.add_argument("--report", type=float, default=10, help="interval výpisu [s]")
+    p.add_argument("--duration", type=float, default=0, help="délka běhu [s], 0 = do Ctrl+C")
+    p.add_argument("--metrics", help="URL /api/metrics brány pro časy smyček a haldu")
+    p.add_argument("--seed", type=int, default=None)
+    args = p.parse_args()
+    FakeModem(open_port(args), args).run()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,4 +1,4 @@
-// webserver.cpp (plně opravená verze s HTTP Basic Auth a funkcionalitou call-log API GET)
+// webserver.cpp (plně opravená verze s přihlášením přes session a funkcionalitou call-log API GET)
 #include "webserver.h"
 #include "gsm_modem.h"
 #include "settings.h"
@@ -8,6 +8,24 @@
 #include <ArduinoJson.h>
 #include <LittleFS.h>
 #include "ntp_sync.h"
+#include "sms_retry.h"
+#include "sms_inbox.h"
+#include "sms_scheduler.h"
+#include "sms_history.h"
+#include "http_server.h"
+#include "http_events.h"
+#include "http_auth.h"
+#include "sms_bulk.h"
+#include "contact_store.h"
+#include "call_log.h"
+#include "metrics.h"
+
+#define LOG_TAG "WEB"
+#ifndef WEB_LOG_LEVEL
+  #define WEB_LOG_LEVEL LOG_LEVEL
+#endif
+#define LOG_LEVEL_MODULE WEB_LOG_LEVEL
+#include "log.h"
 
 #define W5500_RESET_PIN 5
 
@@ -16,16 +34,11 @@ static byte mac[] = {0xDE,0xAD,0xBE,0xEF,0xFE,0xED};
 static EthernetServer httpServer(80);
 const char* SETTINGS_FILE = "/settings.json";
 
-// --- Admin účet ---
-static String adminPassword = "admin";
-static const String adminUser = "admin";
-static const char* PASSWD_PATH = "/admin_pass.txt";
-
 // Pomocná funkce pro převod stavu na řetězec
 const char* smsStateToString(SmsState st) {
   switch (st) {
     case SMS_IDLE:           return "idle";
-    case SMS_SET_TEXT_MODE:
+    case SMS_SET_PDU_MODE:
     case SMS_SEND_HEADER:
     case SMS_WAIT_PROMPT:
     case SMS_SEND_BODY:
@@ -36,17 +49,19 @@ const char* smsStateToString(SmsState st) {
   return "unknown";
 }
 
+static void streamFile(Print& out, const char* path, const char* fallback) {
+  File f = LittleFS.open(path, "r");
+  if (!f) { out.print(fallback); return; }
+  uint8_t buf[512];
+  while (size_t n = f.read(buf, sizeof(buf))) out.write(buf, n);
+  f.close();
+}
+
 // === Funkce načítání nastavení ===
 void handleGetSettings(EthernetClient &client) {
-  File f = LittleFS.open(SETTINGS_FILE, "r");
-  if (!f) {
-    sendJsonResponse(client, 200, "{}"); // prázdné nastavení
-    return;
-  }
-  
-  String settingsJson = f.readString();
-  f.close();
-  sendJsonResponse(client, 200, settingsJson);
+  httpBeginResponse(client, 200, "application/json", -1);
+  ChunkedPrint out(client);
+  streamFile(out, SETTINGS_FILE, "{}");   // prázdné nastavení
 }
 
 // === Funkce uložení nastavení ===
@@ -54,7 +69,7 @@ void handleGetSettings(EthernetClient &client) {
 
 // webserver.cpp (výřez z handleSaveSettings)
 
-void handleSaveSettings(EthernetClient &client, const String &body) {
+void handleSaveSettings(EthernetClient &client, const char* body) {
   StaticJsonDocument<1024> doc;
   auto err = deserializeJson(doc, body);
   if (err) {
@@ -87,315 +102,126 @@ void handleSaveSettings(EthernetClient &client, const String &body) {
 }
 
 
-void loadAdminPassword() {
-  if (LittleFS.exists(PASSWD_PATH)) {
-    File f = LittleFS.open(PASSWD_PATH, "r");
-    adminPassword = f.readStringUntil('\n');
-    f.close();
-    adminPassword.trim();
-    if (adminPassword.length() == 0) adminPassword = "admin";
-  }
+// Odpověď na úspěšné přihlášení: cookie pro prohlížeč, token pro skripty
+static void sendSession(EthernetClient &client, const char* token) {
+  char cookie[96];
+  snprintf(cookie, sizeof(cookie),
+           "Set-Cookie: sid=%s; Path=/; HttpOnly; SameSite=Strict\r\n", token);
+  char json[80];
+  int n = snprintf(json, sizeof(json), "{\"success\":true,\"token\":\"%s\"}", token);
+  httpBeginResponse(client, 200, "application/json", n, cookie);
+  client.write((const uint8_t*)json, n);
 }
 
-void saveAdminPassword(const String& newPass) {
-  File f = LittleFS.open(PASSWD_PATH, "w");
-  f.print(newPass);
-  f.close();
-  adminPassword = newPass;
-}
-
-bool isBase64(unsigned char c) {
-  return (isalnum(c) || (c == '+') || (c == '/'));
-}
-
-// Jednoduchý Base64 dekodér pro Basic Auth (ASCII only)
-String base64decode(const String &input) {
-  const char* base64_chars =
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-      "abcdefghijklmnopqrstuvwxyz"
-      "0123456789+/";
-  int in_len = input.length();
-  int i = 0;
-  int in_ = 0;
-  int char_array_4[4], char_array_3[3];
-  String ret;
-
-  while (in_len-- && (input[in_] != '=') && isBase64(input[in_])) {
-    char_array_4[i++] = input[in_]; in_++;
-    if (i == 4) {
-      for (i = 0; i < 4; i++)
-        char_array_4[i] = strchr(base64_chars, char_array_4[i]) - base64_chars;
-      char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-      for (i = 0; (i < 3); i++) ret += (char) char_array_3[i];
-      i = 0;
-    }
+// Endpoint pro přihlášení: {"user","password"} → session
+void handleLogin(EthernetClient &client, const char* body) {
+  StaticJsonDocument<192> doc;
+  if (deserializeJson(doc, body) != DeserializationError::Ok) {
+    sendJsonResponse(client, 400, "{\"success\":false,\"error\":\"invalid JSON\"}");
+    return;
   }
-  if (i) {
-    for (int j = i; j < 4; j++) char_array_4[j] = 0;
-    for (int j = 0; j < 4; j++)
-      char_array_4[j] = strchr(base64_chars, char_array_4[j]) - base64_chars;
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-    for (int j = 0; (j < i - 1); j++) ret += (char) char_array_3[j];
-  }
-  return ret;
-}
-
-// Kontrola HTTP Basic Auth
-bool checkAuth(EthernetClient &client) {
-  String line;
-  bool authorized = false;
-  while (client.available()) {
-    line = client.readStringUntil('\n');
-    if (line.startsWith("Authorization: Basic ")) {
-      String encoded = line.substring(21);
-      encoded.trim();
-      String decoded = base64decode(encoded);
-      int sep = decoded.indexOf(':');
-      if (sep > 0) {
-        String user = decoded.substring(0, sep);
-        String pass = decoded.substring(sep+1);
-        if (user == adminUser && pass == adminPassword) {
-          authorized = true;
-        }
-      }
+  char token[HTTP_SESSION_TOKEN_LEN + 1];
+  switch (httpAuthLogin(doc["user"] | HTTP_AUTH_USER, doc["password"] | "", token)) {
+    case HTTP_LOGIN_OK:
+      sendSession(client, token);
       break;
-    }
-    if (line == "\r") break; // konec hlaviček
-  }
-  if (!authorized) {
-    client.println("HTTP/1.1 401 Unauthorized");
-    client.println("WWW-Authenticate: Basic realm=\"admin\"");
-    client.println("Connection: close");
-    client.println();
+    case HTTP_LOGIN_LOCKED:
+      sendJsonResponse(client, 429, "{\"success\":false,\"error\":\"Too many attempts\"}");
+      break;
+    default:
+      sendJsonResponse(client, 401, "{\"success\":false,\"error\":\"Invalid credentials\"}");
   }
-  return authorized;
 }
 
 // Endpoint pro změnu hesla
-void handleSetPassword(EthernetClient &client, const String &body) {
+void handleSetPassword(EthernetClient &client, const char* body) {
   StaticJsonDocument<128> doc;
   if (deserializeJson(doc, body) != DeserializationError::Ok) {
-    client.print("HTTP/1.1 400 Bad Request\r\nContent-Type: application/json\r\n\r\n{\"success\":false,\"error\":\"invalid JSON\"}");
+    sendJsonResponse(client, 400, "{\"success\":false,\"error\":\"invalid JSON\"}");
     return;
   }
-  String newPass = doc["password"] | "";
-  if (newPass.length() < 4) {
-    client.print("HTTP/1.1 400 Bad Request\r\nContent-Type: application/json\r\n\r\n{\"success\":false,\"error\":\"Password too short\"}");
+  const char* newPass = doc["password"] | "";
+  if (strlen(newPass) < 4) {
+    sendJsonResponse(client, 400, "{\"success\":false,\"error\":\"Password too short\"}");
     return;
   }
-  saveAdminPassword(newPass);
-  client.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n{\"success\":true}");
-}
-
-void handleSaveContacts(EthernetClient &client, const String &body) {
-  StaticJsonDocument<2048> doc;
-  DeserializationError err = deserializeJson(doc, body);
-  if (err || !doc.is<JsonArray>()) {
-    client.print("HTTP/1.1 400 Bad Request\r\nContent-Type: application/json\r\n\r\n{\"success\":false,\"error\":\"Invalid JSON array\"}");
+  if (!httpAuthSetPassword(newPass)) {
+    sendJsonResponse(client, 500, "{\"success\":false,\"error\":\"Failed to write password\"}");
     return;
   }
+  // ostatní session jsou zrušené, volající dostane novou
+  char token[HTTP_SESSION_TOKEN_LEN + 1];
+  if (httpAuthLogin(HTTP_AUTH_USER, newPass, token) == HTTP_LOGIN_OK) sendSession(client, token);
+  else sendJsonResponse(client, 200, "{\"success\":true}");
+}
 
-  File f = LittleFS.open("/contacts.json", "w");
-  if (!f) {
-    client.print("HTTP/1.1 500 Internal Server Error\r\nContent-Type: application/json\r\n\r\n{\"success\":false,\"error\":\"Failed to open file\"}");
+// Adresář se nenačítá do JsonDocument: tělo zapíše HTTP server po
+// blocích do dočasného souboru (HTTP_ROUTE_UPLOAD, bez čekání pod
+// ethLock), z něj se po kontaktech sestaví index (contact_store) a
+// teprve platné pole nahradí /contacts.json.
+static const char* const CONTACTS_TMP_PATH = "/contacts.json.tmp";
+
+static void handleSaveContacts(HttpRequest& req) {
+  int count = contactStoreRebuild(CONTACTS_TMP_PATH);
+  if (count < 0) {
+    LittleFS.remove(CONTACTS_TMP_PATH);
+    sendJsonResponse(req.client, 400, "{\"success\":false,\"error\":\"Invalid JSON array\"}");
     return;
   }
+  LittleFS.remove(CONTACTS_JSON_PATH);
+  LittleFS.rename(CONTACTS_TMP_PATH, CONTACTS_JSON_PATH);
 
-  serializeJson(doc, f);
-  f.close();
-
-  client.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n{\"success\":true}");
-}
-
-void sendJsonResponse(EthernetClient &client, int statusCode, const String &json) {
-  client.print("HTTP/1.1 ");
-  client.print(statusCode);
-  client.print(" ");
-  client.println((statusCode == 200) ? "OK" : "Bad Request");
-  client.println(F("Content-Type: application/json"));
-  client.println(F("Connection: close"));
-  client.println();
-  client.print(json);
+  HttpJsonResponse res(req.client, 200);
+  res.beginObject().field("success", true).field("indexed", count).endObject();
 }
 
-void sendError(EthernetClient &client, int statusCode, const String &message) {
-  StaticJsonDocument<128> errorDoc;
-  errorDoc["success"] = false;
-  errorDoc["error"] = message;
-  String out;
-  serializeJson(errorDoc, out);
-  sendJsonResponse(client, statusCode, out);
-}
-
-bool validateSmsRequest(const JsonDocument &doc, String &message, JsonArrayConst &recipients, String &error) {
-  if (!doc.containsKey("message") || !doc["message"].is<const char*>()) {
-    error = "Missing or invalid 'message'";
-    return false;
-  }
-  message = doc["message"].as<const char*>();
-
-  JsonVariantConst recVar = doc["recipients"];
-  if (!recVar.is<JsonArrayConst>()) {
-    error = "Missing or invalid 'recipients' array";
-    return false;
-  }
-  recipients = recVar.as<JsonArrayConst>();
-
-  if (recipients.size() == 0) {
-    error = "Recipients array is empty";
-    return false;
-  }
-  return true;
+void sendJsonResponse(EthernetClient &client, int statusCode, const char* json) {
+  size_t n = strlen(json);
+  httpBeginResponse(client, statusCode, "application/json", n);
+  client.write((const uint8_t*)json, n);
 }
 
-void recordSmsToHistory(const String& recipient, const String& message) {
-  // 1) Načíst stávající pole
-  StaticJsonDocument<4096> histDoc;
-  JsonArray oldArr;
-  if (LittleFS.exists("/sms_history.json")) {
-    File fr = LittleFS.open("/sms_history.json", "r");
-    if (deserializeJson(histDoc, fr) == DeserializationError::Ok)
-      oldArr = histDoc.as<JsonArray>();
-    fr.close();
-  }
-  // 2) Vytvořit nový dokument s prvním záznamem
-  StaticJsonDocument<256> rec;
-  rec["timestamp"] = time(nullptr);
-  rec["recipient"] = recipient;
-  rec["message"]   = message;
-
-  StaticJsonDocument<4096> outDoc;
-  JsonArray outArr = outDoc.to<JsonArray>();
-  outArr.add(rec);
-
-  // 3) Doplnit staré záznamy až do limitu
-  uint16_t maxC = getSmsHistoryMaxCount();
-  uint16_t count = 1;
-  for (JsonVariant v : oldArr) {
-    if (count++ >= maxC) break;
-    outArr.add(v);
-  }
-  // 4) Zápis zpět na FS
-  File fw = LittleFS.open("/sms_history.json", "w");
-  serializeJson(outArr, fw);
-  fw.close();
+void sendError(EthernetClient &client, int statusCode, const char* message) {
+  HttpJsonResponse res(client, statusCode);
+  res.beginObject().field("success", false).field("error", message).endObject();
 }
 
-void handleSendSms(EthernetClient &client, const String &body) {
-  Serial.println(F("[Webserver] Přijat požadavek na odeslání SMS"));
-  Serial.print(F("[Webserver] Tělo požadavku: "));
-  Serial.println(body);
+// Naplánování SMS: {numbers|recipients, message, sendTime|due, repeat}
+// nad už naparsovaným tělem (i z /api/send-sms se sendTime)
+static void scheduleSms(EthernetClient &client, JsonVariantConst doc) {
+  JsonArrayConst numbers = doc.containsKey("numbers") ? doc["numbers"] : doc["recipients"];
+  const char* message = doc["message"] | "";
+  uint32_t due = doc["due"] | smsParseSendTime(doc["sendTime"] | "");
 
-  StaticJsonDocument<512> doc;
-  DeserializationError deserErr = deserializeJson(doc, body);
-  if (deserErr) {
-    Serial.print(F("[Webserver] Chyba: Neplatný JSON: "));
-    Serial.println(deserErr.c_str());
-    sendError(client, 400, "Invalid JSON");
+  if (numbers.isNull() || !*message || !due) {
+    sendJsonResponse(client, 400, "{\"success\":false,\"error\":\"Missing fields\"}");
     return;
   }
 
-  String messageText;
-  JsonArrayConst recipients;
-  String validationError;
-  if (!validateSmsRequest(doc, messageText, recipients, validationError)) {
-    Serial.print(F("[Webserver] Chyba validace: "));
-    Serial.println(validationError);
-    sendError(client, 400, validationError);
+  uint32_t id = smsSchedulerAdd(numbers, message, due, smsParseRepeat(doc["repeat"]));
+  if (!id) {
+    sendJsonResponse(client, 500, "{\"success\":false,\"error\":\"Failed to store SMS\"}");
     return;
   }
 
-  Serial.print(F("[Webserver] Počet příjemců: "));
-  Serial.println(recipients.size());
-  Serial.print(F("[Webserver] Zpráva: "));
-  Serial.println(messageText);
-
-  StaticJsonDocument<1024> result;
-  JsonArray sent   = result.createNestedArray("sent");
-  JsonArray failed = result.createNestedArray("failed");
-
-  for (JsonVariantConst v : recipients) {
-    if (!v.is<const char*>()) {
-      Serial.println(F("[Webserver] Neplatný typ příjemce"));
-      failed.add("invalid_type");
-      continue;
-    }
-    String num = v.as<const char*>();
-    num.trim();
-    if (num.length() < 6) {
-      Serial.print(F("[Webserver] Neplatné číslo: "));
-      Serial.println(num);
-      failed.add(num);
-      continue;
-    }
-
-    Serial.print(F("[Webserver] Odesílání SMS na: "));
-    Serial.println(num);
-    bool ok = sendSmsNow(num, messageText);
-    if (ok) {
-      Serial.println(F("[Webserver] SMS úspěšně odeslána"));
-      recordSmsToHistory(num, messageText);
-      sent.add(num);
-    } else {
-      Serial.println(F("[Webserver] Chyba při odeslání SMS"));
-      failed.add(num);
-    }
-  }
-
-  result["success"]      = (failed.size() == 0);
-  result["total"]        = recipients.size();
-  result["sent_count"]   = sent.size();
-  result["failed_count"] = failed.size();
-
-  String response;
-  serializeJson(result, response);
-  Serial.print(F("[Webserver] Výsledek: "));
-  Serial.println(response);
-
-  sendJsonResponse(client, 200, response);
+  HttpJsonResponse res(client, 200);
+  res.beginObject()
+     .field("success", true).field("status", "scheduled")
+     .field("id", id).field("due", due)
+     .endObject();
 }
 
-void handleScheduleSms(EthernetClient &client, const String &body) {
-  StaticJsonDocument<512> doc;
+void handleScheduleSms(EthernetClient &client, const char* body) {
+  StaticJsonDocument<2048> doc;
   DeserializationError err = deserializeJson(doc, body);
   if (err) {
-    client.print("HTTP/1.1 400 Bad Request\r\nContent-Type: application/json\r\n\r\n{\"success\":false,\"error\":\"Invalid JSON\"}");
+    sendJsonResponse(client, 400, "{\"success\":false,\"error\":\"Invalid JSON\"}");
     return;
   }
-
-  JsonArray numbers = doc["numbers"];
-  String message = doc["message"] | "";
-  String sendTime = doc["sendTime"] | "";
-
-  if (!numbers || message.length() == 0 || sendTime.length() == 0) {
-    client.print("HTTP/1.1 400 Bad Request\r\nContent-Type: application/json\r\n\r\n{\"success\":false,\"error\":\"Missing fields\"}");
-    return;
-  }
-
-  // Uložení naplánované SMS do JSON souboru nebo do plánovací fronty
-  File f = LittleFS.open("/scheduled_sms.json", "a");
-  if (!f) {
-    client.print("HTTP/1.1 500 Internal Server Error\r\nContent-Type: application/json\r\n\r\n{\"success\":false,\"error\":\"Failed to store SMS\"}");
-    return;
-  }
-
-  StaticJsonDocument<256> smsDoc;
-  smsDoc["numbers"] = numbers;
-  smsDoc["message"] = message;
-  smsDoc["sendTime"] = sendTime;
-
-  serializeJson(smsDoc, f);
-  f.print("\n");
-  f.close();
-
-  client.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n{\"success\":true}");
+  scheduleSms(client, doc);
 }
 
-void handleSendAtCommand(EthernetClient &client, const String &body) {
+void handleSendAtCommand(EthernetClient &client, const char* body) {
 /*
   StaticJsonDocument<256> doc;
   if (deserializeJson(doc, body) != DeserializationError::Ok) {
@@ -429,23 +255,63 @@ void handleSendAtCommand(EthernetClient &client, const String &body) {
 */
 }
 
-// Podávání statických souborů
-static void serveFile(EthernetClient& client, const char* path, const char* contentType) {
-  if (!LittleFS.exists(path)) {
-    client.println("HTTP/1.1 404 Not Found");
-    client.println("Connection: close");
-    client.println();
-    return;
-  }
-  File f = LittleFS.open(path, "r");
-  client.print("HTTP/1.1 200 OK\r\nContent-Type: ");
-  client.print(contentType);
-  client.print("\r\nConnection: close\r\n\r\n");
-  uint8_t buf[64];
-  while (size_t n = f.read(buf, sizeof(buf))) {
-    client.write(buf, n);
+// Hodnota parametru z query stringu ("a=1&b=2") do `out`, %XX dekódovaná.
+// '+' zůstává (telefonní čísla mezery neobsahují a "+420…" se tak dá
+// poslat i nezakódované). false = parametr chybí nebo je prázdný.
+static bool queryParam(const char* query, const char* name, char* out, size_t cap) {
+  size_t nlen = strlen(name);
+  size_t n = 0;
+  for (const char* p = query; *p; ) {
+    const char* amp = strchr(p, '&');
+    if (!amp) amp = p + strlen(p);
+    if ((size_t)(amp - p) > nlen && p[nlen] == '=' && strncmp(p, name, nlen) == 0) {
+      for (const char* v = p + nlen + 1; v < amp && n + 1 < cap; ++v) {
+        if (*v == '%' && v + 2 < amp && isxdigit(v[1]) && isxdigit(v[2])) {
+          char hex[3] = { v[1], v[2], 0 };
+          out[n++] = (char)strtol(hex, nullptr, 16);
+          v += 2;
+        } else {
+          out[n++] = *v;
+        }
+      }
+      break;
+    }
+    p = *amp ? amp + 1 : amp;
   }
-  f.close();
+  out[n] = '\0';
+  return n > 0;
+}
+
+// offset/limit/since/recipient (nebo number) pro výpisy logů;
+// q.number ukazuje do `number`
+static LogQuery parseLogQuery(const char* query, char* number, size_t cap) {
+  LogQuery q;
+  char v[32];
+  if (queryParam(query, "offset", v, sizeof(v))) q.offset = constrain(atol(v), 0, 0xFFFF);
+  if (queryParam(query, "limit",  v, sizeof(v))) q.limit  = constrain(atol(v), 0, 0xFFFF);
+  if (queryParam(query, "since",  v, sizeof(v))) q.since  = smsParseSendTime(v);
+  if (queryParam(query, "recipient", number, cap) || queryParam(query, "number", number, cap)) {
+    q.number = number;
+  }
+  return q;
+}
+
+static void writeSmsJobJson(JsonWriter& o, const SmsJobInfo& j, const char* preview) {
+  o.beginObject();
+  o.field("id",         j.id);
+  o.field("recipients", j.recipient);
+  if (preview) o.field("message", preview);
+  o.field("state",      smsJobStateToString(j.state));
+  o.field("source",     j.source == SMS_SRC_MQTT ? "mqtt" : (j.source == SMS_SRC_HTTP ? "http" : "local"));
+  o.field("attempts",   j.attempts);
+  if (j.state == SMS_JOB_RETRYING) {
+    int32_t left = (int32_t)(j.notBefore - millis());
+    o.field("retryInMs", left > 0 ? left : 0);
+  }
+  if (j.msgRef >= 0)    o.field("msgRef",    j.msgRef);
+  if (j.lastError >= 0) o.field("lastError", j.lastError);
+  o.field("ageMs",      (uint32_t)(millis() - j.createdAt));
+  o.endObject();
 }
 
 void resetW5500() {
@@ -456,410 +322,433 @@ void resetW5500() {
   delay(200);  // počkej na inicializaci W5500
 }
 
-void networkInit() {
-  resetW5500();
-  SPI.begin(18, 19, 23); // Lze upravit podle HW
-  Ethernet.init(CS_PIN);
-  Serial.print("DHCP… ");
-  if (Ethernet.begin(mac) == 0) {
-    Serial.println("selhalo");
-  } else {
-    Serial.println("OK, IP=" + Ethernet.localIP().toString());
-  }
-  if (!LittleFS.begin(true)) {
-    Serial.println("FS mount failed");
-  }
-  loadSettings();
-  applySettings();
-  /*
-  // aplikuj timezone hned po načtení
-  setenv("TZ", settings.tzString.c_str(), 1);
-  tzset();
-  // a první NTP synchronizaci
-  */
-  ntpBegin();
-  loadAdminPassword();
-  loadSmsHistoryMaxCount();
-  httpServer.begin();
-  otaInit();
-  Serial.println("HTTP server běží");
+// ====== Routy ======
+static void sendNotFound(EthernetClient& client) {
+  httpBeginResponse(client, 404, nullptr, 0);
 }
 
-void networkLoop() {
-  EthernetClient client = httpServer.available();
-  if (!client) return;
-
-  // přečtení request line
-  String request = client.readStringUntil('\r');
-  client.read();  // skip '\n'
-
-  bool isGet  = request.startsWith("GET ");
-  bool isPost = request.startsWith("POST ");
-  int sp1 = request.indexOf(' ') + 1;
-  int sp2 = request.indexOf(' ', sp1);
-  String path = request.substring(sp1, sp2);
-  String method = isGet ? "GET" : (isPost ? "POST" : "");
-
-  // OTA endpoint vyřešíme jako první
-  if (otaHandle(client, method, path)) return;
-
-  // --- Basic Auth for all /api/ endpoints ---
-  if (path.startsWith("/api/")) {
-    if (!checkAuth(client)) {
-      delay(1);
-      client.stop();
-      return;
-    }
-  }
+// Kontrola session pro routy s AUTH; bez WWW-Authenticate, ať prohlížeč
+// neukáže Basic dialog – přihlášení řeší dashboard přes /api/login
+static bool apiAuth(HttpRequest& req) {
+  if (httpAuthCheck(req)) return true;
+  sendJsonResponse(req.client, 401, "{\"success\":false,\"error\":\"unauthorized\"}");
+  return false;
+}
 
-  // --- POST: set password ---
-  if (isPost && path == "/api/set-password") {
-    // skip headers
-    while (client.available()) {
-      String h = client.readStringUntil('\n');
-      if (h == "\r") break;
-    }
-    String body = client.readStringUntil('\0');
-    handleSetPassword(client, body);
-    delay(1);
-    client.stop();
+static bool hasPrefix(const char* s, const char* prefix) {
+  return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+static bool hasSuffix(const char* s, const char* suffix) {
+  size_t n = strlen(s), k = strlen(suffix);
+  return n >= k && strcmp(s + n - k, suffix) == 0;
+}
+
+// Co není v tabulce: statické soubory a 404
+static void handleFallback(HttpRequest& req) {
+  EthernetClient& client = req.client;
+  const char*     path   = req.path;
+  // --- přihlášení i pro neznámé /api/ endpointy ---
+  if (hasPrefix(path, "/api/") && !apiAuth(req)) return;
+
+  if (req.method == HTTP_METHOD_GET) {
+    if      (hasPrefix(path, "/css/"))  httpSendFile(req, path, "text/css");
+    else if (hasPrefix(path, "/js/"))   httpSendFile(req, path, "application/javascript");
+    else if (hasSuffix(path, ".json"))  httpSendFile(req, path, "application/json");
+    else                                sendNotFound(client);
     return;
   }
-
-  // --- POST: AT příkaz z webu ---
-  if (isPost && path == "/api/at/send") {
-    int contentLength = 0;
-    while (client.available()) {
-      String headerLine = client.readStringUntil('\n');
-      headerLine.trim();
-      if (headerLine.length() == 0) break;
-      if (headerLine.startsWith("Content-Length:")) {
-        contentLength = headerLine.substring(15).toInt();
-      }
-    }
-    String body;
-    while ((int)body.length() < contentLength) {
-      if (client.available()) {
-        body += (char)client.read();
-      }
-    }
-    handleSendAtCommand(client, body);
-    delay(1);
-    client.stop();
+  if (req.method == HTTP_METHOD_POST) {
+    sendNotFound(client);
     return;
   }
+  httpBeginResponse(client, 400, nullptr, 0);
+}
 
+static void getIndex(HttpRequest& req) {
+  httpSendFile(req, "/index.html", "text/html");
+}
 
-  // --- POST: uložení nastavení ---
-if (isPost && path == "/api/settings") {
-  // skip headers
-  while (client.available()) {
-    String h = client.readStringUntil('\n');
-    if (h == "\r") break;
-  }
-  String body = client.readStringUntil('\0');
-  StaticJsonDocument<512> doc;
-  if (deserializeJson(doc, body) == DeserializationError::Ok) {
-    settings.ntpServer        = doc["ntpServer"]        | settings.ntpServer;
-    settings.ntpPort          = doc["ntpPort"]          | settings.ntpPort;
-    settings.localPort        = doc["localPort"]        | settings.localPort;
-    settings.retryInterval    = doc["retryInterval"]    | settings.retryInterval;
-    settings.tzString         = doc["tzString"]         | settings.tzString;
-    settings.baudRate         = doc["baudRate"]         | settings.baudRate;
-    settings.atctzu           = doc["atctzu"]           | settings.atctzu;
-    settings.atctr            = doc["atctr"]            | settings.atctr;
-    settings.atclip           = doc["atclip"]           | settings.atclip;
-    settings.smsPromptTimeout = doc["smsPromptTimeout"] | settings.smsPromptTimeout;
-    settings.smsTimeout       = doc["smsTimeout"]       | settings.smsTimeout;
-    settings.cmdInterval      = doc["cmdInterval"]      | settings.cmdInterval;
-    settings.maxRingCount     = doc["maxRingCount"]     | settings.maxRingCount;
-    // Uložení na FS a okamžitá aplikace všech nastavení
-    if (!saveSettings()) {
-      sendError(client, 500, "Failed to write settings");
-      return;
-    }
-    applySettings();   // ← provede TZ, NTP, Serial, modem, ring-count i MQTT
-    sendJsonResponse(client, 200, "{\"success\":true}");
-  } else {
-    sendError(client, 400, "invalid JSON");
-  }
-  delay(1); client.stop();
-  return;
+static void getSettings(HttpRequest& req) {
+  HttpJsonResponse res(req.client, 200);
+  res.beginObject();
+  res.field("ntpServer",        settings.ntpServer);
+  res.field("ntpPort",          settings.ntpPort);
+  res.field("localPort",        settings.localPort);
+  res.field("retryInterval",    settings.retryInterval);
+  res.field("tzString",         settings.tzString);
+  res.field("baudRate",         settings.baudRate);
+  res.field("atctzu",           settings.atctzu);
+  res.field("atctr",            settings.atctr);
+  res.field("atclip",           settings.atclip);
+  res.field("smsPromptTimeout", settings.smsPromptTimeout);
+  res.field("smsTimeout",       settings.smsTimeout);
+  res.field("cmdInterval",      settings.cmdInterval);
+  res.field("maxRingCount",     settings.maxRingCount);
+  res.field("modemPollInterval", settings.modemPollInterval);
+  res.field("smsMaxAttempts",    settings.smsMaxAttempts);
+  res.field("smsRetryBaseMs",    settings.smsRetryBaseMs);
+  res.endObject();
 }
 
-  // --- POST: save contacts ---
-  if (isPost && path == "/api/save-contacts") {
-    int contentLength = 0;
-    while (client.available()) {
-      String headerLine = client.readStringUntil('\n');
-      headerLine.trim();
-      if (headerLine.length() == 0) break;
-      if (headerLine.startsWith("Content-Length:")) {
-        contentLength = headerLine.substring(15).toInt();
-      }
-    }
-    if (contentLength <= 0) {
-      client.print("HTTP/1.1 411 Length Required\r\nContent-Type: application/json\r\n\r\n{\"error\":\"Content-Length required\"}");
-      delay(1);
-      client.stop();
-      return;
-    }
-    String body;
-    while (body.length() < contentLength) {
-      if (client.available()) {
-        body += (char)client.read();
-      }
-    }
-    handleSaveContacts(client, body);
-    delay(1);
-    client.stop();
+static void postSettings(HttpRequest& req) {
+  EthernetClient& client = req.client;
+  StaticJsonDocument<512> doc;
+  if (deserializeJson(doc, req.body) != DeserializationError::Ok) {
+    sendError(client, 400, "invalid JSON");
     return;
   }
-  // --- POST: enqueue SMS tasks ---
-if (isPost && path == "/api/send-sms") {
-  // 1) Načti Content-Length
-  int contentLength = 0;
-  while (client.available()) {
-    String line = client.readStringUntil('\n');
-    line.trim();
-    if (line.length() == 0) break;
-    if (line.startsWith("Content-Length:")) {
-      contentLength = line.substring(15).toInt();
-    }
+  settings.ntpServer        = doc["ntpServer"]        | settings.ntpServer;
+  settings.ntpPort          = doc["ntpPort"]          | settings.ntpPort;
+  settings.localPort        = doc["localPort"]        | settings.localPort;
+  settings.retryInterval    = doc["retryInterval"]    | settings.retryInterval;
+  settings.tzString         = doc["tzString"]         | settings.tzString;
+  settings.baudRate         = doc["baudRate"]         | settings.baudRate;
+  settings.atctzu           = doc["atctzu"]           | settings.atctzu;
+  settings.atctr            = doc["atctr"]            | settings.atctr;
+  settings.atclip           = doc["atclip"]           | settings.atclip;
+  settings.smsPromptTimeout = doc["smsPromptTimeout"] | settings.smsPromptTimeout;
+  settings.smsTimeout       = doc["smsTimeout"]       | settings.smsTimeout;
+  settings.cmdInterval      = doc["cmdInterval"]      | settings.cmdInterval;
+  settings.maxRingCount     = doc["maxRingCount"]     | settings.maxRingCount;
+  settings.modemPollInterval = doc["modemPollInterval"] | settings.modemPollInterval;
+  settings.smsMaxAttempts    = doc["smsMaxAttempts"]    | settings.smsMaxAttempts;
+  settings.smsRetryBaseMs    = doc["smsRetryBaseMs"]    | settings.smsRetryBaseMs;
+  // Uložení na FS a okamžitá aplikace všech nastavení
+  if (!saveSettings()) {
+    sendError(client, 500, "Failed to write settings");
+    return;
   }
+  applySettings();   // ← provede TZ, NTP, Serial, modem, ring-count i MQTT
+  sendJsonResponse(client, 200, "{\"success\":true}");
+}
 
-  // 2) Čti body do proměnné body
-  String body;
-  if (contentLength > 0) {
-    while ((int)body.length() < contentLength) {
-      if (client.available()) {
-        body += (char)client.read();
-      }
-    }
-  } else {
-    unsigned long start = millis();
-    while (millis() - start < 2000) {
-      while (client.available()) {
-        body += (char)client.read();
-        start = millis();
-      }
-    }
-  }
+// Dead-letter seznam vyřídí modemová úloha
+static void sendAccepted(EthernetClient& client, size_t count) {
+  HttpJsonResponse res(client, 202);
+  res.beginObject().field("status", "accepted").field("count", count).endObject();
+}
 
-  // 3) Parsuj JSON
-  StaticJsonDocument<512> doc;
-  auto err = deserializeJson(doc, body);
+static void postDeadLetterClear(HttpRequest& req) {
+  size_t n = smsDeadLetterCount();
+  smsDeadLetterRequestClear();
+  sendAccepted(req.client, n);
+}
+
+static void postDeadLetterRequeue(HttpRequest& req) {
+  size_t n = smsDeadLetterCount();
+  smsDeadLetterRequestRequeue();
+  sendAccepted(req.client, n);
+}
+
+static void postScheduledCancel(HttpRequest& req) {
+  StaticJsonDocument<64> doc;
+  bool ok = !deserializeJson(doc, req.body) && smsSchedulerCancel(doc["id"] | 0);
+  sendJsonResponse(req.client, ok ? 200 : 404, ok ? "{\"success\":true}" : "{\"error\":\"unknown id\"}");
+}
+
+// Zařazení SMS do fronty, jedna úloha na příjemce
+static void postSendSms(HttpRequest& req) {
+  EthernetClient& client = req.client;
+  StaticJsonDocument<2048> doc;
+  auto err = deserializeJson(doc, req.body);
   if (err) {
     sendJsonResponse(client, 400, "{\"error\":\"invalid JSON\"}");
-    delay(1); client.stop();
     return;
   }
 
-  // 4) Vyextrahuj pole recipients a zprávu
+  // se sendTime jde požadavek do plánovače místo fronty
+  if (doc.containsKey("sendTime") && strlen(doc["sendTime"] | "") > 0) {
+    scheduleSms(client, doc);         // bez druhého dokumentu na zásobníku
+    return;
+  }
+
   JsonArray recs = doc["recipients"].as<JsonArray>();
   String msg   = doc["message"].as<String>();
 
-  // 5) Vytvoř frontu úloh, jedna úloha na každý recipient
-  int lastId = -1;
+  // ID se zapisují do odpovědi hned po zařazení (stav viz /api/sms-status?id=N)
+  HttpJsonResponse res(client, 200);
+  res.beginObject().key("ids").beginArray();
+  uint32_t lastId = 0;
   for (auto v : recs) {
     String num = v.as<String>();
-    lastId = enqueueSms(num, msg);  // vrátí unikátní taskId
-    recordSmsToHistory(num, msg);
+    // do historie zapisuje modem až po +CMGS
+    uint32_t id = enqueueSms(num, msg, SMS_SRC_HTTP);  // 0 = fronta plná
+    res.value(id);
+    if (id) lastId = id;
+  }
+  res.endArray()
+     .field("status", lastId ? "queued" : "rejected")
+     .field("id", lastId)
+     .endObject();
+}
+
+// Hromadná SMS: skupiny + šablona, rozvinutí a zařazení dělá smsBulkLoop()
+static void postSendBulk(HttpRequest& req) {
+  StaticJsonDocument<1024> doc;
+  if (deserializeJson(doc, req.body)) {
+    sendError(req.client, 400, "invalid JSON");
+    return;
   }
+  char detail[SMS_BULK_GROUP_LEN] = "";
+  SmsBulkResult r = smsBulkStart(doc.as<JsonVariantConst>(), detail, sizeof(detail));
+  if (r != SMS_BULK_OK) {
+    HttpJsonResponse res(req.client, r == SMS_BULK_BUSY ? 409 : 400);
+    res.beginObject().field("success", false).field("error", smsBulkResultString(r));
+    if (*detail) res.field("variable", detail);
+    res.endObject();
+    return;
+  }
+  SmsBulkStatus st = smsBulkStatus();
+  HttpJsonResponse res(req.client, 202);
+  res.beginObject().field("success", true).field("id", st.id).field("total", st.total).endObject();
+}
 
-  // 6) Odpověď s ID poslední úlohy
-  StaticJsonDocument<128> res;
-  res["status"] = "queued";
-  res["id"]     = lastId;
-  String out; serializeJson(res, out);
-  sendJsonResponse(client, 200, out);
+static void getSendBulk(HttpRequest& req) {
+  SmsBulkStatus st = smsBulkStatus();
+  HttpJsonResponse res(req.client, 200);
+  res.beginObject();
+  res.field("id",         st.id);
+  res.field("active",     st.active);
+  res.field("total",      st.total);
+  res.field("queued",     st.queued);
+  res.field("failed",     st.failed);
+  res.field("duplicates", st.duplicates);
+  res.field("firstJobId", st.firstJobId);
+  res.field("lastJobId",  st.lastJobId);
+  res.field("error",      st.error);
+  res.endObject();
+}
 
-  delay(1);
-  client.stop();
-  return;
-  }
+static void postSendBulkCancel(HttpRequest& req) {
+  bool ok = smsBulkCancel();
+  sendJsonResponse(req.client, ok ? 200 : 404, ok ? "{\"success\":true}" : "{\"error\":\"no bulk send running\"}");
+}
 
-  // --- GET requests ---
-  if (isGet) {
-    // Static files
-    if (path == "/") {
-      serveFile(client, "/index.html", "text/html");
-      delay(1);
-      client.stop();
-      return;
-    }
-    else if (path.startsWith("/css/")) {
-      serveFile(client, path.c_str(), "text/css");
-      delay(1);
-      client.stop();
-      return;
-    }
-    else if (path.startsWith("/js/")) {
-      serveFile(client, path.c_str(), "application/javascript");
-      delay(1);
-      client.stop();
-      return;
-    }
-    else if (path.endsWith(".json")) {
-      serveFile(client, path.c_str(), "application/json");
-      delay(1);
-      client.stop();
-      return;
-    }
-    else if (path == "/api/settings") {
-  StaticJsonDocument<512> doc;
-  doc["ntpServer"]        = settings.ntpServer;
-  doc["ntpPort"]          = settings.ntpPort;
-  doc["localPort"]        = settings.localPort;
-  doc["retryInterval"]    = settings.retryInterval;
-  doc["tzString"]         = settings.tzString;
-  doc["baudRate"]         = settings.baudRate;
-  doc["atctzu"]           = settings.atctzu;
-  doc["atctr"]            = settings.atctr;
-  doc["atclip"]           = settings.atclip;
-  doc["smsPromptTimeout"] = settings.smsPromptTimeout;
-  doc["smsTimeout"]       = settings.smsTimeout;
-  doc["cmdInterval"]      = settings.cmdInterval;
-  doc["maxRingCount"]     = settings.maxRingCount;
-      String out; serializeJson(doc, out);
-      sendJsonResponse(client, 200, out);
-      delay(1); client.stop();
-      return;
-    }
-      // --- Modem status API ---
-    else if (path == "/api/modem-status") {
-      uint8_t sig = readSignalQuality();
-      String op    = readOperatorName();
-      bool mqttOk  = mqttClient.connected();  // nebo jak píšete v kódu
-      StaticJsonDocument<128> doc;
-      doc["signal"]        = sig;
-      doc["operator"]      = op;
-      doc["mqttConnected"] = mqttOk;
-      String out;
-      serializeJson(doc, out);
-      sendJsonResponse(client, 200, out);
-      delay(1); client.stop();
+// odpověď z cache – žádný AT dotaz v rámci HTTP požadavku
+static void getModemStatusJson(HttpRequest& req) {
+  ModemStatus ms = getModemStatus();
+  unsigned long now = millis();
+  HttpJsonResponse res(req.client, 200);
+  res.beginObject();
+  res.field("signal",        ms.signal);
+  res.field("operator",      ms.operatorName);
+  res.field("registration",  ms.regStatus);
+  res.field("attached",      ms.attached);
+  res.field("mqttConnected", mqttClient.connected());
+  res.field("ageMs",         ms.signalAt ? (int32_t)(now - ms.signalAt) : -1);
+  res.endObject();
+}
+
+// ?id=N → jedna úloha, jinak výpis tabulky úloh od nejnovějších
+// (?offset=&limit=, výchozí limit 16, max. SMS_JOB_CAPACITY) a statistiky
+static void getSmsStatusJson(HttpRequest& req) {
+  EthernetClient& client = req.client;
+  SmsStatusSnapshot snap = getSmsStatus();
+
+  // O(1) dotaz do tabulky úloh
+  char arg[12];
+  if (queryParam(req.query, "id", arg, sizeof(arg))) {
+    SmsJobInfo info;
+    if (!smsJobGet(strtoul(arg, nullptr, 10), info)) {
+      sendJsonResponse(client, 404, "{\"error\":\"unknown id\"}");
       return;
     }
-    // GET /api/sms-status
-  else if (isGet && path == "/api/sms-status") {
-    StaticJsonDocument<2048> doc;
-    JsonArray arr = doc.createNestedArray("queue");
-    size_t n = getSmsQueueSize();
-    for (size_t i = 0; i < n; ++i) {
-      SmsTask t = getSmsQueueTask(i);
-      SmsState s = getSmsTaskState(i);
-      JsonObject o = arr.createNestedObject();
-      o["id"]         = (int)i;
-      o["recipients"] = t.recipients;
-      o["message"]    = t.message;
-      o["state"]      = smsStateToString(s);
-    }
-    String out; serializeJson(doc, out);
-    sendJsonResponse(client, 200, out);
-    delay(1); client.stop();
-    return;
-    }
-    // --- GET: načtení nastavení ---
-  if (isGet && path == "/api/settings") {
-    handleGetSettings(client);
-    delay(1);
-    client.stop();
+    HttpJsonResponse res(client, 200);
+    writeSmsJobJson(res, info, nullptr);
     return;
-  } 
-    // MQTT config
-    else if (path == "/api/mqtt-config") {
-      handleGetMqttConfig(client);
-      delay(1);
-      client.stop();
-      return;
-    }
-    // Call log history
-    else if (path == "/api/call-log") {
-      client.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n");
-      if (LittleFS.exists("/call_log.json")) {
-        File f = LittleFS.open("/call_log.json", "r");
-        while (f.available()) client.write(f.read());
-        f.close();
-      } else {
-        client.print("[]");
-      }
-      delay(1);
-      client.stop();
-      return;
-    }
-    // SMS history
-    else if (path == "/api/sms-history") {
-      sendJsonResponse(client, 200,
-        String("{\"history\":") +
-        (LittleFS.exists("/sms_history.json")
-          ? []() {
-              File f = LittleFS.open("/sms_history.json", "r");
-              String s; while (f.available()) s += char(f.read());
-              f.close();
-              return s;
-            }()
-          : "[]")
-        + "}"
-      );
-      delay(1);
-      client.stop();
-      return;
-    }
-    // Config GET
-    else if (path == "/api/config") {
-      StaticJsonDocument<128> c;
-      c["smsHistoryMaxCount"] = getSmsHistoryMaxCount();
-      String out;
-      serializeJson(c, out);
-      sendJsonResponse(client, 200, out);
-      delay(1);
-      client.stop();
-      return;
-    }
-    // Undefined GET
-    else {
-      client.println("HTTP/1.1 404 Not Found");
-      client.println("Connection: close");
-      client.println();
-      delay(1);
-      client.stop();
-      return;
-    }
   }
 
-  // --- Any other POST (fallback) ---
-  if (isPost) {
-    // skip remaining headers
-    while (client.available()) {
-      String h = client.readStringUntil('\n');
-      if (h == "\r") break;
-    }
-    String body = client.readStringUntil('\0');
+  size_t offset = 0, limit = 16;
+  if (queryParam(req.query, "offset", arg, sizeof(arg))) offset = constrain(atol(arg), 0, SMS_JOB_CAPACITY);
+  if (queryParam(req.query, "limit",  arg, sizeof(arg))) limit  = constrain(atol(arg), 0, SMS_JOB_CAPACITY);
+
+  // po stránkách přes malý buffer; výpis není omezený velikostí dokumentu
+  static SmsJobInfo jobs[4];
+  static char       previews[4][161];
+  HttpJsonResponse res(client, 200);
+  res.beginObject().key("queue").beginArray();
+  for (size_t done = 0; done < limit; ) {
+    size_t n = smsJobList(jobs, previews, min(limit - done, (size_t)4), offset + done);
+    for (size_t i = 0; i < n; ++i) writeSmsJobJson(res, jobs[i], previews[i]);
+    done += n;
+    if (n < 4) break;
+  }
+  res.endArray();
+  res.field("active",    getSmsQueueSize());
+  res.field("currentId", snap.currentId);
+  res.field("modem",     smsStateToString(snap.state));
+  res.key("stats").beginObject();
+  res.field("sent",      snap.stats.sent);
+  res.field("failed",    snap.stats.failed);
+  res.field("retried",   snap.stats.retried);
+  res.field("segments",  snap.stats.segments);
+  res.field("deadLetters", smsDeadLetterCount());
+  res.field("lastJobMs", snap.stats.lastJobMs);
+  res.field("avgJobMs",  snap.stats.avgJobMs);
+  res.field("batchSent", snap.stats.batchSent);
+  res.field("batchMs",   snap.stats.batchMs);
+  res.field("perMinute", snap.stats.perMinute);
+  res.endObject().endObject();
+}
 
-    if (path == "/api/contacts") {
-      handleSaveContacts(client, body);
-    }
-    else if (path == "/api/mqtt-config") {
-      handlePostMqttConfig(client, body);
-    }
-    else if (path == "/api/mqtt-test") {
-      handleMqttTest(client, body);
-    }
-    else {
-      client.println("HTTP/1.1 404 Not Found");
-      client.println("Connection: close");
-    }
-    delay(1);
-    client.stop();
-    return;
-  }
+// Call log history (?offset=&limit=&since=&number=)
+static void getCallLog(HttpRequest& req) {
+  EthernetClient& client = req.client;
+  httpBeginResponse(client, 200, "application/json", -1);
+  ChunkedPrint out(client);
+  char number[32];
+  LogQuery q = parseLogQuery(req.query, number, sizeof(number));
+  callLogPrintJson(out, q);
+  out.end();
+}
+
+static void getSmsInbox(HttpRequest& req) {
+  EthernetClient& client = req.client;
+  SmsInboxStats st = smsInboxGetStats();
+  httpBeginResponse(client, 200, "application/json", -1);
+  ChunkedPrint out(client);
+  out.printf("{\"stats\":{\"received\":%u,\"stored\":%u,\"dropped\":%u,\"invalid\":%u,\"perMinute\":%u},\"messages\":",
+                (unsigned)st.received, (unsigned)st.stored, (unsigned)st.dropped,
+                (unsigned)st.invalid, (unsigned)st.perMinute);
+  smsInboxPrintJson(out);
+  out.print('}');
+  out.end();
+}
+
+static void getScheduledSms(HttpRequest& req) {
+  httpBeginResponse(req.client, 200, "application/json", -1);
+  ChunkedPrint out(req.client);
+  smsSchedulerPrintJson(out);
+  out.end();
+}
+
+static void getDeadLetter(HttpRequest& req) {
+  httpBeginResponse(req.client, 200, "application/json", -1);
+  ChunkedPrint out(req.client);
+  smsDeadLetterPrintJson(out);
+  out.end();
+}
+
+// SMS history (?offset=&limit=&since=&recipient=), od nejnovější
+static void getSmsHistory(HttpRequest& req) {
+  EthernetClient& client = req.client;
+  char number[32], limit[8];
+  LogQuery q = parseLogQuery(req.query, number, sizeof(number));
+  if (!queryParam(req.query, "limit", limit, sizeof(limit))) q.limit = getSmsHistoryMaxCount();
+  httpBeginResponse(client, 200, "application/json", -1);
+  ChunkedPrint out(client);
+  out.print("{\"history\":");
+  bool more = smsHistoryPrintJson(out, q);
+  out.printf(",\"offset\":%u,\"limit\":%u,\"more\":%s}",
+             (unsigned)q.offset, (unsigned)q.limit, more ? "true" : "false");
+  out.end();
+}
+
+static void postLogout(HttpRequest& req) {
+  static const char OK[] = "{\"success\":true}";
+  httpAuthLogout(req);
+  httpBeginResponse(req.client, 200, "application/json", sizeof(OK) - 1,
+                    "Set-Cookie: sid=; Path=/; Max-Age=0\r\n");
+  req.client.write((const uint8_t*)OK, sizeof(OK) - 1);
+}
 
-  // --- If we reach here, no known method matched ---
-  client.println("HTTP/1.1 400 Bad Request");
-  client.println("Connection: close");
-  client.println();
-  delay(1);
-  client.stop();
+static void getConfig(HttpRequest& req) {
+  HttpJsonResponse res(req.client, 200);
+  res.beginObject().field("smsHistoryMaxCount", getSmsHistoryMaxCount()).endObject();
 }
 
+// Prometheus text format 0.0.4 (scrape bez session, viz METRICS_AUTH)
+static void getMetrics(HttpRequest& req) {
+  httpBeginResponse(req.client, 200, "text/plain; version=0.0.4", -1);
+  ChunkedPrint out(req.client);
+  metricsPrint(out);
+  httpServerPrintMetrics(out);
+}
+
+// Konec logu (text/plain); ?since=<X-Log-Position z minula> vrátí jen nové řádky
+static void getLogs(HttpRequest& req) {
+  char arg[12];
+  uint32_t since = queryParam(req.query, "since", arg, sizeof(arg)) ? strtoul(arg, nullptr, 10) : 0;
+  uint32_t until = logPosition();
+  char hdr[48];
+  snprintf(hdr, sizeof(hdr), "X-Log-Position: %lu\r\n", (unsigned long)until);
+  httpBeginResponse(req.client, 200, "text/plain; charset=utf-8", -1, hdr);
+  ChunkedPrint out(req.client);
+  logTail(out, since, until);
+}
+
+// Seřazeno podle path (strcmp), pak GET < POST – viz HttpRoute
+static const uint8_t AUTH = HTTP_ROUTE_AUTH;
+static const HttpRoute ROUTES[] = {
+  { "/",                           HTTP_METHOD_GET,  0,    getIndex },
+  { "/api/at/send",                HTTP_METHOD_POST, AUTH, [](HttpRequest& r) { handleSendAtCommand(r.client, r.body); } },
+  { "/api/call-log",               HTTP_METHOD_GET,  AUTH, getCallLog },
+  { "/api/config",                 HTTP_METHOD_GET,  AUTH, getConfig },
+  { "/api/contacts",               HTTP_METHOD_POST, AUTH | HTTP_ROUTE_UPLOAD, handleSaveContacts, nullptr, CONTACTS_TMP_PATH, CONTACTS_JSON_MAX },
+  { "/api/events",                 HTTP_METHOD_GET,  AUTH, httpEventsSubscribe },
+  { "/api/login",                  HTTP_METHOD_POST, 0,    [](HttpRequest& r) { handleLogin(r.client, r.body); } },
+  { "/api/logout",                 HTTP_METHOD_POST, AUTH, postLogout },
+  { "/api/logs",                   HTTP_METHOD_GET,  AUTH, getLogs },
+  { "/api/metrics",                HTTP_METHOD_GET,  METRICS_AUTH ? AUTH : 0, getMetrics },
+  { "/api/modem-status",           HTTP_METHOD_GET,  AUTH, getModemStatusJson },
+  { "/api/mqtt-config",            HTTP_METHOD_GET,  AUTH, [](HttpRequest& r) { handleGetMqttConfig(r.client); } },
+  { "/api/mqtt-config",            HTTP_METHOD_POST, AUTH, [](HttpRequest& r) { handlePostMqttConfig(r.client, r.body); } },
+  { "/api/mqtt-test",              HTTP_METHOD_POST, AUTH, [](HttpRequest& r) { handleMqttTest(r.client, r.body); } },
+  { "/api/save-contacts",          HTTP_METHOD_POST, AUTH | HTTP_ROUTE_UPLOAD, handleSaveContacts, nullptr, CONTACTS_TMP_PATH, CONTACTS_JSON_MAX },
+  { "/api/schedule-sms",           HTTP_METHOD_POST, AUTH, [](HttpRequest& r) { handleScheduleSms(r.client, r.body); } },
+  { "/api/scheduled-sms",          HTTP_METHOD_GET,  AUTH, getScheduledSms },
+  { "/api/scheduled-sms/cancel",   HTTP_METHOD_POST, AUTH, postScheduledCancel },
+  { "/api/send-bulk",              HTTP_METHOD_GET,  AUTH, getSendBulk },
+  { "/api/send-bulk",              HTTP_METHOD_POST, AUTH, postSendBulk },
+  { "/api/send-bulk/cancel",       HTTP_METHOD_POST, AUTH, postSendBulkCancel },
+  { "/api/send-sms",               HTTP_METHOD_POST, AUTH, postSendSms },
+  { "/api/set-password",           HTTP_METHOD_POST, AUTH, [](HttpRequest& r) { handleSetPassword(r.client, r.body); } },
+  { "/api/settings",               HTTP_METHOD_GET,  AUTH, getSettings },
+  { "/api/settings",               HTTP_METHOD_POST, AUTH, postSettings },
+  { "/api/sms-deadletter",         HTTP_METHOD_GET,  AUTH, getDeadLetter },
+  { "/api/sms-deadletter/clear",   HTTP_METHOD_POST, AUTH, postDeadLetterClear },
+  { "/api/sms-deadletter/requeue", HTTP_METHOD_POST, AUTH, postDeadLetterRequeue },
+  { "/api/sms-history",            HTTP_METHOD_GET,  AUTH, getSmsHistory },
+  { "/api/sms-inbox",              HTTP_METHOD_GET,  AUTH, getSmsInbox },
+  { "/api/sms-status",             HTTP_METHOD_GET,  AUTH, getSmsStatusJson },
+  { "/ota",                        HTTP_METHOD_GET,  HTTP_ROUTE_STREAM, nullptr, otaHandle },
+  { "/ota",                        HTTP_METHOD_POST, HTTP_ROUTE_STREAM, nullptr, otaHandle },
+};
+
+void networkInit() {
+  resetW5500();
+  SPI.begin(18, 19, 23); // Lze upravit podle HW
+  Ethernet.init(CS_PIN);
+  if (Ethernet.begin(mac) == 0) {
+    LOG_E("DHCP selhalo");
+  } else {
+    LOG_I("DHCP OK, IP=%s", Ethernet.localIP().toString().c_str());
+  }
+  if (!LittleFS.begin(true)) {
+    LOG_E("FS mount failed");
+  }
+  loadSettings();
+  applySettings();
+  /*
+  // aplikuj timezone hned po načtení
+  setenv("TZ", settings.tzString.c_str(), 1);
+  tzset();
+  // a první NTP synchronizaci
+  */
+  ntpBegin();
+  httpAuthBegin();
+  contactStoreBegin();
+  loadSmsHistoryMaxCount();
+  smsHistoryInit();
+  callLogBegin();
+  smsSchedulerInit();
+  httpServerBegin(httpServer, ROUTES, sizeof(ROUTES) / sizeof(ROUTES[0]), handleFallback, apiAuth);
+  otaInit();
+  LOG_I("HTTP server běží");
+}
+
+void networkLoop() {
+  httpServerLoop();
+  httpEventsLoop();       // události z modemu → /api/events
+}